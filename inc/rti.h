@@ -26,6 +26,7 @@
 
 #include <rtthread.h>
 #include <rthw.h>
+#include <stdarg.h>
 #include "rti_config.h"
 
 #define   RTI_LOG                   (0u)
@@ -91,6 +92,57 @@
 #define   RTI_ID_QUEUE_TAKEN      ( 2u + RTI_ID_QUEUE_BASE)
 #define   RTI_ID_QUEUE_RELEASE    ( 3u + RTI_ID_QUEUE_BASE)
 
+/* statistics summary: period in us, context switches, then the id and
+ * load in 0.01% of every thread that ran */
+#define   RTI_ID_STATS            (90u)
+
+/* lock summary since the previous one: object id, acquisitions, contended
+ * acquisitions, priority inversions, then total and maximum wait and hold
+ * in time stamp cycles */
+#define   RTI_ID_LOCK             (91u)
+
+/* throttle report since the previous one: class number, events recorded
+ * and events dropped of every throttled class that had events */
+#define   RTI_ID_THROTTLE         (92u)
+
+/* telemetry since the reset: bytes recorded and drained, buffer high water
+ * mark, rti thread wakeups, record cycles, then packets recorded, packets
+ * dropped and bytes dropped of each event class and of the rest */
+#define   RTI_ID_TELEMETRY        (93u)
+
+/* the packets that follow belong to the channel, each channel counts its
+ * time from the start of recording on its own. The time stamp delta is 0. */
+#define   RTI_ID_CHANNEL          (94u)
+
+/* rti_printf: address of the format string, then the arguments. The host
+ * takes the format from the elf file and formats it */
+#define   RTI_ID_PRINTF           (95u)
+
+/* heap and memory pool events. rt_malloc: size, address and thread,
+ * rt_free: address and thread, the pools: pool id, block address and
+ * thread. Addresses are shrunk like the ids, the thread is 0 before the
+ * scheduler runs */
+#define   RTI_ID_MALLOC           (96u)
+#define   RTI_ID_FREE             (97u)
+#define   RTI_ID_MP_ALLOC         (98u)
+#define   RTI_ID_MP_FREE          (99u)
+
+/* allocation summary of the period: heap bytes used and the peak since
+ * the reset, then the id, allocations, bytes allocated and frees of every
+ * thread that allocated or freed */
+#define   RTI_ID_ALLOC            (100u)
+
+/* device io of the traced devices. Enter: device id, operation (0 read,
+ * 1 write, 2 control) and the size or the command, exit: device id,
+ * operation, result and duration in time stamp cycles */
+#define   RTI_ID_DEVICE_ENTER     (101u)
+#define   RTI_ID_DEVICE_EXIT      (102u)
+
+/* the events of the modules registered with rti_module_register, the
+ * first module event id of SystemView */
+#define   RTI_ID_MODULE_BASE      (512u)
+#define   RTI_ID_MODULE_MAX       (0x3FFFu)
+
 /*trace event flag*/
 #define RTI_SEM_NUM        (0)
 #define RTI_MUTEX_NUM      (1)
@@ -101,7 +153,10 @@
 #define RTI_SCHEDULER_NUM  (6)
 #define RTI_INTERRUPT_NUM  (7)
 #define RTI_TIMER_NUM      (8)
-#define RTI_TRACE_NUM      (9)
+#define RTI_HEAP_NUM       (9)
+#define RTI_MEMPOOL_NUM    (10)
+#define RTI_DEVICE_NUM     (11)
+#define RTI_TRACE_NUM      (12)
 
 #define RTI_SEM            (1 << RTI_SEM_NUM      )
 #define RTI_MUTEX          (1 << RTI_MUTEX_NUM    )
@@ -112,7 +167,17 @@
 #define RTI_SCHEDULER      (1 << RTI_SCHEDULER_NUM)
 #define RTI_INTERRUPT      (1 << RTI_INTERRUPT_NUM)
 #define RTI_TIMER          (1 << RTI_TIMER_NUM    )
-#define RTI_ALL            (0x01FF)
+#define RTI_HEAP           (1 << RTI_HEAP_NUM     )
+#define RTI_MEMPOOL        (1 << RTI_MEMPOOL_NUM  )
+#define RTI_DEVICE         (1 << RTI_DEVICE_NUM   )
+#define RTI_ALL            (0x0FFF)
+#define RTI_IPC            (RTI_SEM | RTI_MUTEX | RTI_EVENT | RTI_MAILBOX | RTI_QUEUE)
+
+/* id of a thread or object in the stream */
+#define RTI_SHRINK_ID(addr)  (((rt_uint32_t)(rt_ubase_t)(addr) - RTI_RAM_BASE_ADDRESS) >> RTI_ID_SHIFT)
+
+/* true when the event class is compiled in, usable in #if */
+#define RTI_CFG(flag)      ((RTI_CFG_CLASSES) & (flag))
 
 /* rti data size */
 #define RTI_INFO_SIZE      (9)
@@ -123,14 +188,88 @@
 #define RTI_ENABLE          1
 #define RTI_OVERFLOW        2
 
+/* rti buffer policy */
+#define RTI_POLICY_STREAM       0   /* drop new packets while the buffer is full */
+#define RTI_POLICY_OVERWRITE    1   /* flight recorder, overwrite the oldest packets */
+
+/* rti channels, the log channel is there when RTI_LOG_BUFFER_SIZE is set */
+#define RTI_CHANNEL_EVENT       0   /* scheduler, interrupt, ipc and the rest */
+#define RTI_CHANNEL_LOG         1   /* rti_print */
+
+/* a contiguous part of the data in the rti buffer */
+struct rti_span
+{
+    const rt_uint8_t *ptr;
+    rt_size_t length;
+};
+
+/*
+ * A module of the application with events of its own, as in SystemView.
+ * The description names the module and tells the host how to show its
+ * events, e.g. "M=codec, 0 decode frame=%u len=%u, 1 encode frame=%u".
+ * Event n of the module is recorded with the id event_offset + n.
+ */
+struct rti_module
+{
+    const char *desc;
+    rt_uint16_t event_num;
+
+    /* sends further descriptions with rti_module_desc each time the
+     * module is described, may be RT_NULL */
+    void (*send_desc)(void);
+
+    /* set by rti_module_register */
+    rt_uint16_t event_offset;
+    rt_uint8_t  id;
+    struct rti_module *next;
+};
+
+/*
+ * The head of an entry of a per thread table of the optional modules. A table
+ * has num entries of size bytes and one more after them for the threads that
+ * do not fit. A closed thread is not given an entry.
+ */
+struct rti_thread_entry
+{
+    rt_thread_t thread;
+    char        name[RT_NAME_MAX];
+};
+
 /* rti api */
 void rti_start(void);
 void rti_stop(void);
 void rti_trace_enable(rt_uint16_t flag);
 void rti_trace_disable(rt_uint16_t flag);
-rt_size_t rti_data_get(rt_uint8_t *ptr, rt_uint16_t length);
+rt_size_t rti_data_get(rt_uint8_t *ptr, rt_size_t length);
+rt_uint8_t rti_data_peek(struct rti_span span[2]);
+void rti_data_commit(rt_size_t length);
+rt_bool_t rti_data_boundary(void);
 rt_size_t rti_buffer_used(void);
+rt_size_t rti_channel_used(rt_uint8_t channel);
 void rti_data_new_data_notify_set_hook(void (*hook)(void));
+void (*rti_data_new_data_notify_get_hook(void))(void);
 void rti_print(const char *s);
+void rti_printf(const char *fmt, ...);
+void rti_vprintf(const char *fmt, va_list args);
+void rti_record_values(rt_uint16_t rti_id, const rt_uint32_t *values, rt_uint16_t count);
+void rti_record_void(rt_uint16_t rti_id);
+void rti_record_u32(rt_uint16_t rti_id, rt_uint32_t v0);
+void rti_record_u32x2(rt_uint16_t rti_id, rt_uint32_t v0, rt_uint32_t v1);
+void rti_record_u32x3(rt_uint16_t rti_id, rt_uint32_t v0, rt_uint32_t v1, rt_uint32_t v2);
+void rti_record_u32x4(rt_uint16_t rti_id, rt_uint32_t v0, rt_uint32_t v1, rt_uint32_t v2, rt_uint32_t v3);
+rt_err_t rti_module_register(struct rti_module *module);
+void rti_module_desc(const struct rti_module *module, const char *desc);
+void rti_user_start(rt_uint32_t user_id);
+void rti_user_stop(rt_uint32_t user_id);
+void rti_name_resource(rt_uint32_t id, const char *name);
+void rti_policy_set(rt_uint8_t policy);
+void rti_channel_policy_set(rt_uint8_t channel, rt_uint8_t policy);
+void rti_freeze(void);
+void rti_dump(void (*output)(const rt_uint8_t *ptr, rt_size_t length));
+void rti_preamble(void (*output)(const rt_uint8_t *ptr, rt_size_t length));
+
+/* per thread tables, call with interrupts disabled */
+void *rti_thread_entry_get(void *table, rt_size_t size, rt_uint8_t num, rt_thread_t thread);
+void *rti_thread_entry_find(void *table, rt_size_t size, rt_uint8_t num, rt_thread_t thread);
 
 #endif
@@ -0,0 +1,60 @@
+/*
+ * File      : rti_alloc.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_ALLOC_H__
+#define __RTI_ALLOC_H__
+
+#include "rti.h"
+
+#ifdef RTI_USING_ALLOC
+
+/*
+ * Allocation statistics.
+ *
+ * Counts the allocations, the bytes allocated and the frees of every
+ * thread through the heap and memory pool hooks, and the peak of the heap
+ * in use, so the allocation hot spots show without streaming every call.
+ * The hooks only count. The heap use is read every RTI_ALLOC_PERIOD in
+ * the timer, the peak is the highest of these samples. A block of a memory
+ * pool counts as an allocation without bytes, the pool took its memory
+ * when it was created.
+ * It runs whether rti records or not; while it records, a RTI_ID_ALLOC
+ * summary goes into the stream every RTI_ALLOC_PERIOD ticks.
+ *
+ * rt_free does not tell the size, so the bytes in use are only known for
+ * the heap as a whole. The hooks need RTI_HEAP and RTI_MEMPOOL compiled in.
+ */
+
+void rti_alloc_start(void);
+void rti_alloc_stop(void);
+void rti_alloc_reset(void);
+void rti_alloc_show(void);
+
+/* called by rti.c */
+void rti_alloc_malloc(rt_size_t size);
+void rti_alloc_free(void);
+void rti_alloc_remove(rt_thread_t thread);
+
+#endif
+
+#endif
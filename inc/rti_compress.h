@@ -0,0 +1,59 @@
+/*
+ * File      : rti_compress.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_COMPRESS_H__
+#define __RTI_COMPRESS_H__
+
+#include "rti.h"
+
+#ifdef RTI_USING_COMPRESS
+
+/*
+ * Stream compression.
+ *
+ * Packs the rti buffer block by block into frames for links slower than
+ * the cpu. Every block of up to RTI_COMPRESS_BLOCK_SIZE bytes is compressed
+ * on its own with LZ4 block coding, so a frame can be unpacked as soon as
+ * it arrives and memory stays bounded on both ends. A block that does not
+ * get smaller is stored.
+ *
+ * Frame: magic, method, raw length (2 bytes, little endian), data length
+ * (2 bytes, little endian), data. tools/rti_decode unpacks the frames.
+ */
+
+#define RTI_COMPRESS_MAGIC         0xFA
+#define RTI_COMPRESS_STORED        0
+#define RTI_COMPRESS_LZ4           1
+
+#define RTI_COMPRESS_HEAD_SIZE     6
+#define RTI_COMPRESS_FRAME_SIZE    (RTI_COMPRESS_HEAD_SIZE + RTI_COMPRESS_BLOCK_SIZE)
+
+/* bytes of the stream in a frame */
+#define RTI_COMPRESS_RAW_SIZE(frame)  ((frame)[2] | ((frame)[3] << 8))
+
+rt_size_t rti_compress_block(const rt_uint8_t *src, rt_size_t length, rt_uint8_t *frame);
+rt_size_t rti_compress_get(rt_uint8_t *frame);
+
+#endif
+
+#endif
@@ -28,7 +28,9 @@
 #include "rtdevice.h"
 
 /* RTI interrupt configuration */
-#if defined(ARCH_ARM_CORTEX_M3) || defined(ARCH_ARM_CORTEX_M4) || defined(ARCH_ARM_CORTEX_M7)
+#if defined(RTI_GET_ISR_ID)
+    // Provided by rtconfig.h, e.g. for the simulator BSP which has no interrupt controller to read.
+#elif defined(ARCH_ARM_CORTEX_M3) || defined(ARCH_ARM_CORTEX_M4) || defined(ARCH_ARM_CORTEX_M7)
     #define RTI_GET_ISR_ID()   ((*(rt_uint32_t *)(0xE000ED04)) & 0x1FF)    // Get the currently active interrupt Id. (i.e. read Cortex-M ICSR[8:0] = active vector)
 #elif defined(ARCH_ARM_CORTEX_M0)
     #if defined(__ICCARM__)
@@ -41,13 +43,281 @@
     #define RTI_GET_ISR_ID()                                               // Get the currently active interrupt Id from the user-provided function.
 #endif
 
+/* RTI atomic configuration */
+#ifndef RTI_ATOMIC_CAS
+    #if defined(ARCH_ARM_CORTEX_M0)
+        #define RTI_ATOMIC_CAS(ptr, old, val)   rti_atomic_cas(ptr, old, val)                  // ARMv6-M has no LDREX/STREX, compare-and-swap with interrupts masked for a few instructions.
+    #else
+        #define RTI_ATOMIC_CAS(ptr, old, val)   __sync_bool_compare_and_swap(ptr, old, val)    // Compare-and-swap a rt_uint32_t, must be safe against nested interrupts.
+    #endif
+#endif
+
+#ifndef RTI_BARRIER
+    #define RTI_BARRIER()                       __sync_synchronize()                           // Memory barrier between filling the buffer and publishing it.
+#endif
+
 /* RTI buffer configuration */
 #ifndef PKG_USING_RTI
-    #define RTI_BUFFER_SIZE        2048                  // Number of bytes that RTI uses for the buffer.
+    #define RTI_BUFFER_SIZE        2048                  // Number of bytes that RTI uses for the buffer. (must be a power of two)
 #else
     #define RTI_BUFFER_SIZE        PKG_RTI_BUFFER_SIZE
 #endif
 
+#ifndef   RTI_LOG_BUFFER_SIZE
+    #ifndef PKG_RTI_LOG_BUFFER_SIZE
+        #define RTI_LOG_BUFFER_SIZE    0                 // Number of bytes of the log channel for rti_print, 0 puts the prints in the event buffer. (zero or a power of two)
+    #else
+        #define RTI_LOG_BUFFER_SIZE    PKG_RTI_LOG_BUFFER_SIZE
+    #endif
+#endif
+
+#if !defined(RTI_BUFFER_SECTION) && defined(PKG_RTI_BUFFER_SECTION)
+    #define RTI_BUFFER_SECTION         PKG_RTI_BUFFER_SECTION // Linker section of the buffers, e.g. ".rti_buffer" in a ram the dma reaches. (default .bss)
+#endif
+
+/* RTI thread configuration */
+#ifndef   RTI_THREAD_STACK_SIZE
+    #ifndef PKG_RTI_THREAD_STACK_SIZE
+        #define RTI_THREAD_STACK_SIZE  1024              // Stack of the rti thread, which calls the consumer hook.
+    #else
+        #define RTI_THREAD_STACK_SIZE  PKG_RTI_THREAD_STACK_SIZE
+    #endif
+#endif
+
+#ifndef RTI_THREAD_PRIORITY
+    #define RTI_THREAD_PRIORITY        20                // Priority of the rti thread.
+#endif
+
+/* RTI event classes compiled in, the others leave no hook or recorder in the image.
+ * RTI_HEAP and RTI_MEMPOOL record every allocation and are left out unless the
+ * allocation statistics, which count in their hooks, are used. */
+#ifndef   RTI_CFG_CLASSES
+    #if !defined(PKG_RTI_CFG_CLASSES) && (defined(RTI_USING_ALLOC) || defined(PKG_RTI_USING_ALLOC))
+        #define RTI_CFG_CLASSES        0x0FFF            // RTI_ALL
+    #elif !defined(PKG_RTI_CFG_CLASSES)
+        #define RTI_CFG_CLASSES        0x09FF            // Mask of the trace event flags in rti.h, e.g. (RTI_SCHEDULER | RTI_INTERRUPT). (default RTI_ALL without RTI_HEAP and RTI_MEMPOOL)
+    #else
+        #define RTI_CFG_CLASSES        PKG_RTI_CFG_CLASSES
+    #endif
+#endif
+
+/* RTI object name cache configuration */
+#ifndef   RTI_NAME_CACHE_SIZE
+    #ifndef PKG_RTI_NAME_CACHE_SIZE
+        #define RTI_NAME_CACHE_SIZE    32                // Number of kernel objects whose name is remembered as sent. (must be a power of two)
+    #else
+        #define RTI_NAME_CACHE_SIZE    PKG_RTI_NAME_CACHE_SIZE
+    #endif
+#endif
+
+/* RTI serial transport configuration */
+#ifndef   RTI_SERIAL_XFER_SIZE
+    #ifndef PKG_RTI_SERIAL_XFER_SIZE
+        #define RTI_SERIAL_XFER_SIZE   (RTI_BUFFER_SIZE / 8) // Largest number of bytes the serial transport hands to the uart at once.
+    #else
+        #define RTI_SERIAL_XFER_SIZE   PKG_RTI_SERIAL_XFER_SIZE
+    #endif
+#endif
+
+/* RTI trigger capture, see rti_trigger.h */
+#if !defined(RTI_USING_TRIGGER) && defined(PKG_RTI_USING_TRIGGER)
+    #define RTI_USING_TRIGGER
+#endif
+
+/* RTI statistics, see rti_stats.h */
+#if !defined(RTI_USING_STATS) && defined(PKG_RTI_USING_STATS)
+    #define RTI_USING_STATS
+#endif
+
+#ifndef   RTI_STATS_THREAD_NUM
+    #ifndef PKG_RTI_STATS_THREAD_NUM
+        #define RTI_STATS_THREAD_NUM   16                // Number of threads counted apart, the others add up in one entry.
+    #else
+        #define RTI_STATS_THREAD_NUM   PKG_RTI_STATS_THREAD_NUM
+    #endif
+#endif
+
+#ifndef RTI_STATS_ISR_NUM
+    #define RTI_STATS_ISR_NUM          8                 // Number of interrupt vectors with a histogram.
+#endif
+
+#ifndef RTI_STATS_TIMER_NUM
+    #define RTI_STATS_TIMER_NUM        8                 // Number of timers with a histogram.
+#endif
+
+#ifndef RTI_STATS_BUCKET_NUM
+    #define RTI_STATS_BUCKET_NUM       16                // Histogram buckets, each one twice as wide as the one before.
+#endif
+
+#ifndef RTI_STATS_BUCKET_SHIFT
+    #define RTI_STATS_BUCKET_SHIFT     4                 // Durations below 2^RTI_STATS_BUCKET_SHIFT time stamp cycles go to the first bucket.
+#endif
+
+#ifndef RTI_STATS_PERIOD
+    #define RTI_STATS_PERIOD           RT_TICK_PER_SECOND // Ticks between two summary packets while rti records.
+#endif
+
+/* RTI lock contention profiler, see rti_lock.h */
+#if !defined(RTI_USING_LOCK) && defined(PKG_RTI_USING_LOCK)
+    #define RTI_USING_LOCK
+#endif
+
+#ifndef   RTI_LOCK_NUM
+    #ifndef PKG_RTI_LOCK_NUM
+        #define RTI_LOCK_NUM           16                // Number of semaphores and mutexes profiled, the least waited for is replaced.
+    #else
+        #define RTI_LOCK_NUM           PKG_RTI_LOCK_NUM
+    #endif
+#endif
+
+#ifndef RTI_LOCK_WAITER_NUM
+    #define RTI_LOCK_WAITER_NUM        8                 // Number of threads waiting for a lock at the same time.
+#endif
+
+#ifndef RTI_LOCK_PERIOD
+    #define RTI_LOCK_PERIOD            RT_TICK_PER_SECOND // Ticks between two summary rounds while rti records.
+#endif
+
+/* RTI stream compression, see rti_compress.h */
+#if !defined(RTI_USING_COMPRESS) && defined(PKG_RTI_USING_COMPRESS)
+    #define RTI_USING_COMPRESS
+#endif
+
+#ifndef RTI_COMPRESS_BLOCK_SIZE
+    #define RTI_COMPRESS_BLOCK_SIZE    RTI_DATE_PACKAGE_SIZE // Bytes of the stream compressed at once, at most 65535.
+#endif
+
+#ifndef   RTI_COMPRESS_HASH_BITS
+    #ifndef PKG_RTI_COMPRESS_HASH_BITS
+        #define RTI_COMPRESS_HASH_BITS 9                 // The match finder takes 2 << RTI_COMPRESS_HASH_BITS bytes of RAM.
+    #else
+        #define RTI_COMPRESS_HASH_BITS PKG_RTI_COMPRESS_HASH_BITS
+    #endif
+#endif
+
+/* RTI per class rate limits, see rti_throttle.h */
+#if !defined(RTI_USING_THROTTLE) && defined(PKG_RTI_USING_THROTTLE)
+    #define RTI_USING_THROTTLE
+#endif
+
+#ifndef RTI_THROTTLE_PERIOD
+    #define RTI_THROTTLE_PERIOD        RT_TICK_PER_SECOND // Ticks between two reports of the dropped events while rti records.
+#endif
+
+/* RTI loss and backpressure telemetry, see rti_telemetry.h */
+#if !defined(RTI_USING_TELEMETRY) && defined(PKG_RTI_USING_TELEMETRY)
+    #define RTI_USING_TELEMETRY
+#endif
+
+#ifndef   RTI_TELEMETRY_PERIOD
+    #ifndef PKG_RTI_TELEMETRY_PERIOD
+        #define RTI_TELEMETRY_PERIOD   0                 // Ticks between two telemetry packets while rti records, 0 keeps them out of the stream.
+    #else
+        #define RTI_TELEMETRY_PERIOD   PKG_RTI_TELEMETRY_PERIOD
+    #endif
+#endif
+
+/* RTI file sink, see rti_file.h */
+#if !defined(RTI_USING_FILE) && defined(PKG_RTI_USING_FILE)
+    #define RTI_USING_FILE
+#endif
+
+#ifndef   RTI_FILE_BUFFER_SIZE
+    #ifndef PKG_RTI_FILE_BUFFER_SIZE
+        #define RTI_FILE_BUFFER_SIZE   4096              // Bytes written to the file at once, a multiple of the sector size.
+    #else
+        #define RTI_FILE_BUFFER_SIZE   PKG_RTI_FILE_BUFFER_SIZE
+    #endif
+#endif
+
+#ifndef RTI_FILE_ROTATE_NUM
+    #define RTI_FILE_ROTATE_NUM        4                 // Files kept when rotating, the oldest one is overwritten.
+#endif
+
+#ifndef RTI_FILE_PATH_MAX
+    #define RTI_FILE_PATH_MAX          64                // Longest file name, with the number of a rotated file.
+#endif
+
+/* RTI tcp sink, see rti_tcp.h */
+#if !defined(RTI_USING_TCP) && defined(PKG_RTI_USING_TCP)
+    #define RTI_USING_TCP
+#endif
+
+#ifndef   RTI_TCP_PORT
+    #ifndef PKG_RTI_TCP_PORT
+        #define RTI_TCP_PORT           19111             // Port SystemView connects to.
+    #else
+        #define RTI_TCP_PORT           PKG_RTI_TCP_PORT
+    #endif
+#endif
+
+#ifndef RTI_TCP_FLUSH_MS
+    #define RTI_TCP_FLUSH_MS           10                // The rest of the buffer is sent after at most this time.
+#endif
+
+#ifndef RTI_TCP_STACK_SIZE
+    #define RTI_TCP_STACK_SIZE         2048              // Stack of the server thread.
+#endif
+
+#ifndef RTI_TCP_THREAD_PRIORITY
+    #define RTI_TCP_THREAD_PRIORITY    RTI_THREAD_PRIORITY  // Priority of the server thread.
+#endif
+
+/* RTI stack high water marks, see rti_stack.h */
+#if !defined(RTI_USING_STACK) && defined(PKG_RTI_USING_STACK)
+    #define RTI_USING_STACK
+#endif
+
+#ifndef   RTI_STACK_THREAD_NUM
+    #ifndef PKG_RTI_STACK_THREAD_NUM
+        #define RTI_STACK_THREAD_NUM   32                // Number of threads whose stack is measured.
+    #else
+        #define RTI_STACK_THREAD_NUM   PKG_RTI_STACK_THREAD_NUM
+    #endif
+#endif
+
+#ifndef RTI_STACK_SCAN_SIZE
+    #define RTI_STACK_SCAN_SIZE        256               // Bytes of stack checked with the scheduler locked at a time.
+#endif
+
+#ifndef RTI_STACK_PERIOD
+    #define RTI_STACK_PERIOD           RT_TICK_PER_SECOND // Ticks between two passes over all stacks.
+#endif
+
+#ifndef RTI_STACK_THREAD_PRIORITY
+    #define RTI_STACK_THREAD_PRIORITY  (RT_THREAD_PRIORITY_MAX - 2) // Priority of the scan thread, just above idle.
+#endif
+
+/* RTI allocation statistics, see rti_alloc.h */
+#if !defined(RTI_USING_ALLOC) && defined(PKG_RTI_USING_ALLOC)
+    #define RTI_USING_ALLOC
+#endif
+
+#ifndef   RTI_ALLOC_THREAD_NUM
+    #ifndef PKG_RTI_ALLOC_THREAD_NUM
+        #define RTI_ALLOC_THREAD_NUM   16                // Number of threads counted apart, the others add up in one entry.
+    #else
+        #define RTI_ALLOC_THREAD_NUM   PKG_RTI_ALLOC_THREAD_NUM
+    #endif
+#endif
+
+#ifndef RTI_ALLOC_PERIOD
+    #define RTI_ALLOC_PERIOD           RT_TICK_PER_SECOND // Ticks between two summary packets while rti records.
+#endif
+
+/* RTI device io tracing, see rti_device.h. RTI_USING_DEVICE_HIST keeps latency histograms on the target */
+#ifndef   RTI_DEVICE_TRACE_NUM
+    #ifndef PKG_RTI_DEVICE_TRACE_NUM
+        #define RTI_DEVICE_TRACE_NUM   8                 // Number of devices traced at the same time.
+    #else
+        #define RTI_DEVICE_TRACE_NUM   PKG_RTI_DEVICE_TRACE_NUM
+    #endif
+#endif
+
+#if !defined(RTI_USING_DEVICE_HIST) && defined(PKG_RTI_USING_DEVICE_HIST)
+    #define RTI_USING_DEVICE_HIST
+#endif
+
 /* RTI Id configuration */
 #ifndef PKG_USING_RTI
     #define RTI_RAM_BASE_ADDRESS         0x20000000      // Default value for the lowest Id reported by the application.
@@ -82,13 +352,50 @@
     #endif
 #endif
 
-extern unsigned int             SystemCoreClock;
 #define rt_uint64_t             unsigned long long
 
-#define RTI_GET_TIMESTAMP()     clock_cpu_gettime()
-#define RTI_SYS_FREQ            (SystemCoreClock)
-#define RTI_CPU_FREQ            (SystemCoreClock)
+/* RTI time stamp configuration, read once per packet. RTI_SYS_FREQ is the rate of RTI_GET_TIMESTAMP() */
+#if defined(RTI_GET_TIMESTAMP)
+    // Provided by rtconfig.h together with RTI_SYS_FREQ.
+#elif defined(ARCH_ARM_CORTEX_M3) || defined(ARCH_ARM_CORTEX_M4) || defined(ARCH_ARM_CORTEX_M7)
+    #define RTI_TIMESTAMP_DWT
+    #define RTI_GET_TIMESTAMP()     (*(volatile rt_uint32_t *)0xE0001004)          // DWT CYCCNT, read inline. rti_init enables the counter.
+#elif (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define RTI_TIMESTAMP_TSC
+    #define RTI_GET_TIMESTAMP()     ((rt_uint32_t)__builtin_ia32_rdtsc())          // Host builds such as the simulator BSP. rti_init measures the rate.
+    #define RTI_SYS_FREQ            (rti_timestamp_freq)
+    extern rt_uint32_t              rti_timestamp_freq;
+#elif defined(__unix__)
+    #define RTI_TIMESTAMP_CLOCK
+    #define RTI_GET_TIMESTAMP()     rti_timestamp_clock()                          // Other host builds, nanoseconds of CLOCK_MONOTONIC.
+    #define RTI_SYS_FREQ            1000000000
+    extern rt_uint32_t              rti_timestamp_clock(void);
+#else
+    #define RTI_GET_TIMESTAMP()     clock_cpu_gettime()
+#endif
+
+#ifndef RTI_SYS_FREQ
+    extern unsigned int         SystemCoreClock;
+    #define RTI_SYS_FREQ            (SystemCoreClock)
+#endif
+
+#ifndef   RTI_TIMESTAMP_SHIFT
+    #ifndef PKG_RTI_TIMESTAMP_SHIFT
+        #define RTI_TIMESTAMP_SHIFT    0                 // Prescaler, the time stamps in the stream are RTI_GET_TIMESTAMP() >> RTI_TIMESTAMP_SHIFT.
+    #else
+        #define RTI_TIMESTAMP_SHIFT    PKG_RTI_TIMESTAMP_SHIFT
+    #endif
+#endif
+
+#ifndef RTI_CPU_FREQ
+    #define RTI_CPU_FREQ            (RTI_SYS_FREQ)
+#endif
+
 #define RTI_MAX_STRING_LEN      128
+
+#ifndef RTI_PRINTF_ARG_NUM
+    #define RTI_PRINTF_ARG_NUM      8                    // Values recorded by one rti_printf, long long and double take two.
+#endif
 #define RTI_DATE_PACKAGE_SIZE   1024
 
 #endif
@@ -0,0 +1,72 @@
+/*
+ * File      : rti_device.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_DEVICE_H__
+#define __RTI_DEVICE_H__
+
+#include "rti.h"
+
+#if RTI_CFG(RTI_DEVICE) && defined(RT_USING_DEVICE)
+
+/*
+ * Device I/O tracing.
+ *
+ * The kernel has no hook in rt_device_read, rt_device_write and
+ * rt_device_control, so rti_device_trace puts a trampoline in front of
+ * the chosen operations of a device. It records a DEVICE_ENTER and a
+ * DEVICE_EXIT packet around the call of the driver, the exit with the
+ * result and the duration in time stamp cycles. The name of the device
+ * is sent once per recording. Devices that are not traced cost nothing.
+ *
+ * With RTI_USING_DEVICE_HIST every traced operation also keeps a log2
+ * histogram of its durations, with the buckets of rti_stats, whether rti
+ * records or not.
+ *
+ * Untracing or unregistering a device gives it its driver back and frees
+ * its entry and histograms, or the last call still in a trampoline does.
+ * A call that took the trampoline before the untrace and finds no entry
+ * goes on to the driver unrecorded. RTI_DEVICE_TRACE_NUM limits the
+ * devices traced at the same time. Do not trace the device rti itself
+ * writes the stream to.
+ */
+
+/* operations of a device */
+#define RTI_DEVICE_READ         0x01
+#define RTI_DEVICE_WRITE        0x02
+#define RTI_DEVICE_CONTROL      0x04
+#define RTI_DEVICE_ALL          0x07
+
+rt_err_t rti_device_trace(const char *name, rt_uint8_t ops);
+rt_err_t rti_device_untrace(const char *name);
+void rti_device_reset(void);
+void rti_device_show(void);
+
+/* called by rti.c */
+void rti_device_remove(rt_device_t device);
+
+/* provided by rti.c, records the device id and the values */
+void rti_record_device(rt_uint16_t rti_id, rt_device_t device, const rt_uint32_t *values, rt_uint8_t count);
+
+#endif
+
+#endif
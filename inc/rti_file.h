@@ -0,0 +1,59 @@
+/*
+ * File      : rti_file.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_FILE_H__
+#define __RTI_FILE_H__
+
+#include "rti.h"
+
+#ifdef RTI_USING_FILE
+
+/*
+ * File sink.
+ *
+ * Records to a file on the device, in the layout rdb saves: the .SVDat
+ * file SystemView and rti_decode read. The rti thread copies the buffer
+ * into a write buffer and writes it in RTI_FILE_BUFFER_SIZE pieces, so the
+ * file system sees few large writes at sector aligned offsets.
+ *
+ * With a rotate size the recording goes to numbered files, trace.SVDat
+ * becomes trace_0.SVDat, trace_1.SVDat and so on. The next file is started
+ * on a packet boundary once the current one holds rotate_size bytes, the
+ * oldest is overwritten after RTI_FILE_ROTATE_NUM files. Every file starts
+ * with the sync and the system information and decodes on its own.
+ *
+ * With RTI_USING_COMPRESS, rti_file_compress(RT_TRUE) before the start
+ * writes compressed frames (rti_compress.h) instead, the preamble of a
+ * rotated file included. rti_decode unpacks them.
+ */
+
+rt_err_t rti_file_start(const char *path, rt_uint32_t rotate_size);
+void rti_file_stop(void);
+void rti_file_show(void);
+#ifdef RTI_USING_COMPRESS
+void rti_file_compress(rt_bool_t enable);
+#endif
+
+#endif
+
+#endif
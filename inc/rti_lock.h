@@ -0,0 +1,58 @@
+/*
+ * File      : rti_lock.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_LOCK_H__
+#define __RTI_LOCK_H__
+
+#include "rti.h"
+
+#ifdef RTI_USING_LOCK
+
+/*
+ * Lock contention profiler.
+ *
+ * Follows every semaphore and mutex through the IPC hooks: the wait from
+ * trytake to taken, the hold of a mutex from taken to the last release,
+ * how often a thread had to wait and how often it waited for a mutex owned
+ * by a thread of lower priority. RTI_LOCK_NUM objects are kept, a new one
+ * replaces the one with the least total wait. While rti records, a
+ * RTI_ID_LOCK summary of every object used in the period goes into the
+ * stream every RTI_LOCK_PERIOD ticks.
+ *
+ * The hooks need RTI_SEM and RTI_MUTEX compiled in. Times are in time stamp
+ * cycles.
+ */
+
+void rti_lock_start(void);
+void rti_lock_stop(void);
+void rti_lock_reset(void);
+void rti_lock_show(void);
+
+/* called by rti.c */
+void rti_lock_trytake(rt_object_t object);
+void rti_lock_take(rt_object_t object);
+void rti_lock_release(rt_object_t object);
+
+#endif
+
+#endif
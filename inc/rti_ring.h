@@ -0,0 +1,112 @@
+/*
+ * File      : rti_ring.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_RING_H__
+#define __RTI_RING_H__
+
+#include "rti.h"
+
+/*
+ * Lock-free trace ring.
+ *
+ * Producers are the hooks, running in threads and in (nested) interrupts on a
+ * single core. A producer enters the ring, reserves space with a
+ * compare-and-swap on the reserve index, fills the reserved bytes and leaves.
+ * The commit index, which is all the consumer ever looks at, is only moved by
+ * the outermost producer when it leaves, so the consumer never sees a region
+ * that a preempted producer has not finished writing.
+ *
+ * That needs every producer that preempts another one to leave before the
+ * other resumes. Interrupts nest that way; a thread keeps interrupts off
+ * from enter to leave, so it is never switched out for another thread in
+ * between and no interrupt waits for a thread to publish. Interrupts stay
+ * lock-free against each other and against the threads.
+ *
+ * All indexes are free running, the buffer size must be a power of two.
+ *
+ * When skip is set the ring overwrites instead of filling up: a producer
+ * that finds no room moves the read index past the oldest whole packets,
+ * skip tells it how long the packet at an index is. Only committed packets
+ * are dropped, so the ring always starts on a packet boundary.
+ *
+ * The consumer peeks at the committed data in place and commits what it
+ * has consumed, the space is only reused after the commit.
+ */
+struct rti_ring
+{
+    rt_uint8_t *buffer;
+    rt_uint32_t mask;
+
+    /* producers reserve space from here */
+    volatile rt_uint32_t reserve;
+
+    /* data before commit is visible to the consumer */
+    volatile rt_uint32_t commit;
+
+    /* consumer position */
+    volatile rt_uint32_t read;
+
+    /* producers between enter and leave */
+    volatile rt_uint32_t committing;
+
+    /* size of the packet at index, RT_NULL to drop new data when full */
+    rt_uint32_t (*skip)(struct rti_ring *ring, rt_uint32_t index);
+};
+
+void rti_ring_init(struct rti_ring *ring, rt_uint8_t *pool, rt_uint32_t size);
+void rti_ring_reset(struct rti_ring *ring);
+
+rt_base_t rti_ring_enter(struct rti_ring *ring);
+rt_err_t rti_ring_reserve(struct rti_ring *ring, rt_uint32_t index, rt_uint32_t length);
+void rti_ring_write(struct rti_ring *ring, rt_uint32_t index, const rt_uint8_t *ptr, rt_uint32_t length);
+void rti_ring_leave(struct rti_ring *ring, rt_base_t level);
+
+rt_uint8_t rti_ring_peek(struct rti_ring *ring, struct rti_span span[2]);
+void rti_ring_commit(struct rti_ring *ring, rt_size_t length);
+
+rt_uint32_t rti_atomic_add(volatile rt_uint32_t *ptr, rt_uint32_t value);
+#if defined(ARCH_ARM_CORTEX_M0)
+rt_bool_t rti_atomic_cas(volatile rt_uint32_t *ptr, rt_uint32_t old, rt_uint32_t value);
+#endif
+
+rt_inline rt_uint32_t rti_ring_size(struct rti_ring *ring)
+{
+    return ring->mask + 1;
+}
+
+rt_inline rt_uint32_t rti_ring_data_len(struct rti_ring *ring)
+{
+    return ring->commit - ring->read;
+}
+
+rt_inline void rti_ring_putc(struct rti_ring *ring, rt_uint32_t index, rt_uint8_t ch)
+{
+    ring->buffer[index & ring->mask] = ch;
+}
+
+rt_inline rt_uint8_t rti_ring_getc(struct rti_ring *ring, rt_uint32_t index)
+{
+    return ring->buffer[index & ring->mask];
+}
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * File      : rti_serial.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_SERIAL_H__
+#define __RTI_SERIAL_H__
+
+#include "rti.h"
+
+/*
+ * Serial transport.
+ *
+ * Sends the rti buffer in place as two transfers that take turns on the
+ * line. On a uart with RT_DEVICE_FLAG_DMA_TX the next transfer is queued
+ * while the other one is sent, and the tx complete callback commits the
+ * finished one and queues the next, so the line stays busy without waking
+ * the rti thread. Other uarts are written from the rti thread.
+ *
+ * The device must carry nothing but rti data while it is started.
+ */
+
+rt_err_t rti_serial_start(rt_device_t dev);
+void rti_serial_stop(void);
+
+#endif
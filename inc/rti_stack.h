@@ -0,0 +1,58 @@
+/*
+ * File      : rti_stack.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_STACK_H__
+#define __RTI_STACK_H__
+
+#include "rti.h"
+
+#ifdef RTI_USING_STACK
+
+/*
+ * Stack high water marks.
+ *
+ * rt_thread_init fills every stack with '#', a thread of low priority
+ * measures how much of it was never touched. It checks RTI_STACK_SCAN_SIZE
+ * bytes at a time with the scheduler locked and goes over all stacks every
+ * RTI_STACK_PERIOD ticks. A pass stops at the first touched byte, so only
+ * the part that was free the last time is checked again.
+ *
+ * When the mark of a thread grows while rti records, a STACK_INFO packet
+ * with the used bytes goes into the stream. The thread list sent at the
+ * start of a recording carries the marks known so far.
+ *
+ * RTI_STACK_THREAD_NUM threads are measured, they are found through the
+ * thread hooks, which need RTI_THREAD compiled in.
+ */
+
+void rti_stack_show(void);
+
+/* called by rti.c */
+void rti_stack_init(void);
+void rti_stack_add(rt_thread_t thread);
+void rti_stack_remove(rt_thread_t thread);
+rt_uint32_t rti_stack_used(rt_thread_t thread);
+
+#endif
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * File      : rti_stats.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_STATS_H__
+#define __RTI_STATS_H__
+
+#include "rti.h"
+
+#ifdef RTI_USING_STATS
+
+/*
+ * Statistics.
+ *
+ * Aggregates the scheduler, interrupt and timer hooks on the target instead
+ * of streaming every event: run time and context switches per thread, and
+ * a log2 histogram of the durations per interrupt vector and per timer, all
+ * in fixed RAM. It runs whether rti records or not; while it records, a
+ * RTI_ID_STATS summary goes into the stream every RTI_STATS_PERIOD ticks.
+ *
+ * The thread load needs RTI_SCHEDULER, the histograms RTI_INTERRUPT and
+ * RTI_TIMER compiled in. Times are in time stamp cycles.
+ */
+
+void rti_stats_start(void);
+void rti_stats_stop(void);
+void rti_stats_reset(void);
+void rti_stats_show(void);
+
+/* called by rti.c */
+void rti_stats_schedule(rt_thread_t from, rt_thread_t to);
+void rti_stats_isr_enter(void);
+void rti_stats_isr_leave(void);
+void rti_stats_timer_enter(rt_timer_t timer);
+void rti_stats_timer_exit(rt_timer_t timer);
+void rti_stats_remove(rt_thread_t thread);
+
+#endif
+
+#endif
@@ -0,0 +1,52 @@
+/*
+ * File      : rti_tcp.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_TCP_H__
+#define __RTI_TCP_H__
+
+#include "rti.h"
+
+#ifdef RTI_USING_TCP
+
+/*
+ * TCP sink.
+ *
+ * Live recording over the network. A server thread listens on the port
+ * and serves one host at a time, SystemView or tools/rti_recv.c. The host
+ * starts the recording with the SystemView hello ('S', 'V' and two version
+ * bytes) or a 0x01 and stops it with a 0x02, as over the uart. Closing the
+ * connection stops it too.
+ *
+ * The stream is sent in place from the rti buffer with Nagle disabled.
+ * The rti thread sends when the buffer is filling up, in pieces of up to
+ * the whole buffer, and the server thread sends what is left every
+ * RTI_TCP_FLUSH_MS, which bounds the latency when the system is quiet.
+ */
+
+rt_err_t rti_tcp_start(rt_uint16_t port);
+void rti_tcp_stop(void);
+void rti_tcp_show(void);
+
+#endif
+
+#endif
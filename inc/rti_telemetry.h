@@ -0,0 +1,83 @@
+/*
+ * File      : rti_telemetry.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_TELEMETRY_H__
+#define __RTI_TELEMETRY_H__
+
+#include "rti.h"
+
+#ifdef RTI_USING_TELEMETRY
+
+/*
+ * Loss and backpressure telemetry.
+ *
+ * Counts what rti itself does, to size the buffer and the transport: the
+ * packets recorded and dropped for a full buffer by event class, how full
+ * the buffer got, how fast the consumer drains it, the time spent encoding
+ * packets and how often the rti thread is woken. Packets without an event
+ * class (system information, prints, summaries) count in the last entry.
+ *
+ * The counters run from rti_telemetry_reset and wrap, compare two readings
+ * for rates. Counting costs a few atomic adds per packet.
+ */
+
+#define RTI_TELEMETRY_OTHER        RTI_TRACE_NUM
+
+struct rti_telemetry
+{
+    rt_uint32_t recorded[RTI_TRACE_NUM + 1];
+    rt_uint32_t dropped[RTI_TRACE_NUM + 1];
+    rt_uint32_t dropped_bytes[RTI_TRACE_NUM + 1];
+
+    rt_uint32_t recorded_bytes;
+    rt_uint32_t drained_bytes;
+
+    /* most bytes in the buffer at once */
+    rt_uint32_t high_water;
+
+    /* the rti thread resumed by a producer */
+    rt_uint32_t wakeups;
+
+    /* time stamp cycles from the reservation of a packet to its end */
+    rt_uint32_t record_cycles;
+
+    /* time stamp of the reset and of the reading */
+    rt_uint32_t since;
+    rt_uint32_t now;
+};
+
+void rti_telemetry_get(struct rti_telemetry *telemetry);
+void rti_telemetry_reset(void);
+void rti_telemetry_show(void);
+
+/* called by rti.c */
+void rti_telemetry_init(void);
+void rti_telemetry_record(rt_uint16_t rti_id, rt_uint16_t length);
+void rti_telemetry_drop(rt_uint16_t rti_id, rt_uint16_t length);
+void rti_telemetry_end(rt_uint32_t start, rt_uint32_t used);
+void rti_telemetry_drain(rt_size_t length);
+void rti_telemetry_wakeup(void);
+
+#endif
+
+#endif
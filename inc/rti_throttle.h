@@ -0,0 +1,64 @@
+/*
+ * File      : rti_throttle.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_THROTTLE_H__
+#define __RTI_THROTTLE_H__
+
+#include "rti.h"
+
+#ifdef RTI_USING_THROTTLE
+
+/*
+ * Per class rate limits.
+ *
+ * Each event class can keep only one in sample events and pass the rest
+ * through a token bucket of rate events per second and burst events, so an
+ * interrupt storm spends its own budget instead of overflowing the buffer
+ * and losing every other class with it. An interrupt or timer is kept or
+ * dropped with both its enter and exit. While rti records, a RTI_ID_THROTTLE
+ * report of the recorded and dropped events per class goes into the stream
+ * every RTI_THROTTLE_PERIOD ticks, for the host to scale the counts back.
+ *
+ * The overflow of the buffer still applies on top of the limits.
+ */
+
+/* the classes that can be limited. Dropping a switch or a ready change would
+ * leave the host with a wrong thread state, so RTI_SCHEDULER and RTI_THREAD
+ * always pass */
+#define RTI_THROTTLE_ALL   (RTI_ALL & ~(RTI_SCHEDULER | RTI_THREAD))
+
+/* flag takes classes of RTI_THROTTLE_ALL, -RT_EINVAL for RTI_SCHEDULER and
+ * RTI_THREAD. A rate of 0 and a sample of 0 or 1 remove the limit */
+rt_err_t rti_throttle_set(rt_uint16_t flag, rt_uint32_t rate, rt_uint16_t burst, rt_uint16_t sample);
+void rti_throttle_show(void);
+
+/* called by rti.c, false when the event is dropped */
+rt_bool_t rti_throttle_pass(rt_uint16_t flag);
+rt_bool_t rti_throttle_isr_enter(void);
+rt_bool_t rti_throttle_isr_leave(void);
+rt_bool_t rti_throttle_timer_enter(void);
+rt_bool_t rti_throttle_timer_exit(void);
+
+#endif
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * File      : rti_trigger.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_TRIGGER_H__
+#define __RTI_TRIGGER_H__
+
+#include "rti.h"
+
+#ifdef RTI_USING_TRIGGER
+
+/*
+ * Trigger capture.
+ *
+ * While armed rti records as a flight recorder, so the buffer always holds
+ * the pre-trigger window. When a condition fires, post_size more bytes are
+ * recorded, then recording freezes and the rti thread hands the window to
+ * the output function with rti_dump. The window is the whole buffer:
+ * post_size bytes after the trigger and RTI_BUFFER_SIZE - post_size bytes
+ * before it, so post_size may be at most half of the buffer. The
+ * conditions are checked in the hooks, their event classes must be
+ * recorded.
+ *
+ * Times are in time stamp cycles (RTI_SYS_FREQ per second).
+ */
+
+/* trigger conditions, rti_trigger() fires whenever the trigger is armed */
+#define RTI_TRIGGER_ISR_LONG        0x01    /* an isr runs longer than isr_cycles */
+#define RTI_TRIGGER_THREAD_STARVED  0x02    /* thread is ready but does not run for thread_cycles */
+#define RTI_TRIGGER_MUTEX_HELD      0x04    /* the mutex is held longer than mutex_cycles */
+
+struct rti_trigger_config
+{
+    rt_uint8_t  conditions;
+
+    rt_uint32_t isr_cycles;
+
+    rt_thread_t thread;
+    rt_uint32_t thread_cycles;
+
+    /* name of the mutex */
+    const char *mutex;
+    rt_uint32_t mutex_cycles;
+
+    /* bytes recorded after the trigger, at most RTI_BUFFER_SIZE / 2 */
+    rt_uint32_t post_size;
+
+    /* called from the rti thread with the captured stream */
+    void (*output)(const rt_uint8_t *ptr, rt_size_t length);
+};
+
+rt_err_t rti_trigger_arm(const struct rti_trigger_config *config);
+void rti_trigger_disarm(void);
+void rti_trigger(void);
+
+/* called by rti.c */
+void rti_trigger_isr_enter(void);
+void rti_trigger_isr_leave(void);
+void rti_trigger_schedule(rt_thread_t from, rt_thread_t to);
+void rti_trigger_resume(rt_thread_t thread);
+void rti_trigger_take(rt_object_t object);
+void rti_trigger_release(rt_object_t object);
+rt_bool_t rti_trigger_post(rt_uint32_t index);
+rt_bool_t rti_trigger_pending(void);
+void rti_trigger_flush(void);
+
+#endif
+
+#endif
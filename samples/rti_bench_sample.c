@@ -0,0 +1,482 @@
+/*
+ * File      : rti_bench_sample.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+/*
+ * Drive the rti hooks through the kernel API and report the cost of tracing.
+ *
+ * Every case runs twice, once with all events disabled and once recording.
+ * The difference is the hook overhead, divided by the number of events one
+ * operation records. Runs on a board, on the simulator BSP and on the host
+ * kernel in tools/host, which makes the hot path measurable on Linux.
+ *
+ * Run it once per RTI_CFG_CLASSES configuration to compare: a class that is
+ * compiled out shows what the bare kernel operation costs. With
+ * RTI_USING_COMPRESS it also reports the compression of a mixed stream,
+ * with RTI_USING_FILE and a path the rate the file sink writes it at.
+ */
+
+#include <stdlib.h>
+#include <rtthread.h>
+
+#include "rti.h"
+#include "rti_compress.h"
+#include "rti_file.h"
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#endif
+
+#define RTI_BENCH_COUNT          10000
+#define RTI_BENCH_BATCH          (RTI_BUFFER_SIZE / 128)
+#define RTI_BENCH_DROP           100
+
+struct rti_bench_case
+{
+    const char *name;
+
+    /* events recorded by one operation */
+    rt_uint8_t  events;
+
+    void (*op)(void);
+};
+
+static rt_uint8_t bench_buf[256];
+#ifdef RTI_USING_COMPRESS
+static rt_uint8_t bench_frame[RTI_COMPRESS_FRAME_SIZE];
+#endif
+
+static struct rt_semaphore bench_sem;
+static struct rt_timer bench_timer;
+static volatile rt_bool_t bench_yield_run;
+#ifdef RT_USING_MUTEX
+static struct rt_mutex bench_mutex;
+#endif
+#ifdef RT_USING_EVENT
+static struct rt_event bench_event;
+#endif
+#ifdef RT_USING_MAILBOX
+static struct rt_mailbox bench_mb;
+static rt_ubase_t bench_mb_pool[4];
+#endif
+#ifdef RT_USING_MESSAGEQUEUE
+static struct rt_messagequeue bench_mq;
+static rt_uint32_t bench_mq_pool[16];
+#endif
+#ifdef RT_USING_MEMPOOL
+static struct rt_mempool bench_mp;
+static rt_uint8_t bench_mp_pool[4 * (32 + sizeof(rt_uint8_t *))];
+#endif
+
+static void rti_bench_isr(void)
+{
+    rt_interrupt_enter();
+    rt_interrupt_leave();
+}
+
+static void rti_bench_sem(void)
+{
+    rt_sem_release(&bench_sem);
+    rt_sem_take(&bench_sem, 0);
+}
+
+#ifdef RT_USING_MUTEX
+static void rti_bench_mutex(void)
+{
+    rt_mutex_take(&bench_mutex, RT_WAITING_FOREVER);
+    rt_mutex_release(&bench_mutex);
+}
+#endif
+
+#ifdef RT_USING_EVENT
+static void rti_bench_event(void)
+{
+    rt_event_send(&bench_event, 0x01);
+    rt_event_recv(&bench_event, 0x01, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, 0, RT_NULL);
+}
+#endif
+
+#ifdef RT_USING_MAILBOX
+static void rti_bench_mailbox(void)
+{
+    rt_ubase_t value;
+
+    rt_mb_send(&bench_mb, 0);
+    rt_mb_recv(&bench_mb, &value, 0);
+}
+#endif
+
+#ifdef RT_USING_MESSAGEQUEUE
+static void rti_bench_queue(void)
+{
+    rt_uint32_t value = 0;
+
+    rt_mq_send(&bench_mq, &value, sizeof(value));
+    rt_mq_recv(&bench_mq, &value, sizeof(value), 0);
+}
+#endif
+
+static void rti_bench_timeout(void *parameter)
+{
+}
+
+static void rti_bench_timer(void)
+{
+    /* an expired one shot hard timer runs on the next check */
+    rt_timer_start(&bench_timer);
+    rt_timer_check();
+}
+
+static void rti_bench_yield_entry(void *parameter)
+{
+    while (bench_yield_run)
+    {
+        rt_thread_yield();
+    }
+}
+
+static void rti_bench_yield(void)
+{
+    /* switches to the helper thread and back */
+    rt_thread_yield();
+}
+
+#ifdef RT_USING_HEAP
+static void rti_bench_malloc(void)
+{
+    rt_free(rt_malloc(32));
+}
+#endif
+
+#ifdef RT_USING_MEMPOOL
+static void rti_bench_mempool(void)
+{
+    rt_mp_free(rt_mp_alloc(&bench_mp, 0));
+}
+#endif
+
+static void rti_bench_print(void)
+{
+    rti_print("rti bench\n");
+}
+
+static void rti_bench_printf(void)
+{
+    static rt_uint32_t count;
+
+    rti_printf("rti bench %d\n", count++);
+}
+
+static struct rti_module bench_module =
+{
+    "M=bench, 0 frame=%u len=%u", 1, RT_NULL, 0, 0, RT_NULL
+};
+
+static void rti_bench_user(void)
+{
+    static rt_uint32_t count;
+
+    rti_record_u32x2(bench_module.event_offset, count++, 64);
+}
+
+static void rti_bench_marker(void)
+{
+    rti_user_start(1);
+    rti_user_stop(1);
+}
+
+static const struct rti_bench_case bench_cases[] =
+{
+    {"isr",     3, rti_bench_isr},
+    {"sem",     3, rti_bench_sem},
+#ifdef RT_USING_MUTEX
+    {"mutex",   3, rti_bench_mutex},
+#endif
+#ifdef RT_USING_EVENT
+    {"event",   3, rti_bench_event},
+#endif
+#ifdef RT_USING_MAILBOX
+    {"mailbox", 3, rti_bench_mailbox},
+#endif
+#ifdef RT_USING_MESSAGEQUEUE
+    {"queue",   3, rti_bench_queue},
+#endif
+    {"timer",   2, rti_bench_timer},
+    {"yield",   4, rti_bench_yield},
+#ifdef RT_USING_HEAP
+    {"malloc",  2, rti_bench_malloc},
+#endif
+#ifdef RT_USING_MEMPOOL
+    {"mempool", 2, rti_bench_mempool},
+#endif
+    {"print",   1, rti_bench_print},
+    {"printf",  1, rti_bench_printf},
+    {"user",    1, rti_bench_user},
+    {"marker",  2, rti_bench_marker},
+};
+
+static rt_uint32_t rti_bench_drain(void)
+{
+    rt_uint32_t bytes = 0;
+    rt_size_t size;
+
+    while ((size = rti_data_get(bench_buf, sizeof(bench_buf))) > 0)
+        bytes += size;
+    return bytes;
+}
+
+/* run count operations in batches that fit the buffer, return the time stamp cycles */
+static rt_uint64_t rti_bench_run(void (*op)(void), rt_uint32_t count, rt_uint64_t *bytes)
+{
+    rt_uint32_t n, i, batch, start;
+    rt_uint64_t cycles = 0;
+
+    rti_bench_drain();
+    for (n = 0; n < count; n += batch)
+    {
+        batch = count - n;
+        if (batch > RTI_BENCH_BATCH)
+            batch = RTI_BENCH_BATCH;
+
+        start = RTI_GET_TIMESTAMP();
+        for (i = 0; i < batch; i++)
+            op();
+        cycles += (rt_uint32_t)(RTI_GET_TIMESTAMP() - start);
+
+        *bytes += rti_bench_drain();
+    }
+    return cycles;
+}
+
+static void rti_bench_one(const struct rti_bench_case *bench, rt_uint32_t count)
+{
+    rt_uint64_t cycles_off, cycles_on, bytes = 0, events;
+    rt_uint32_t ns, bytes_per_event;
+
+    rti_trace_disable(RTI_ALL);
+    cycles_off = rti_bench_run(bench->op, count, &bytes);
+    rti_trace_enable(RTI_ALL);
+
+    bytes = 0;
+    cycles_on = rti_bench_run(bench->op, count, &bytes);
+
+    events = (rt_uint64_t)count * bench->events;
+    if (cycles_on < cycles_off)
+        cycles_on = cycles_off;
+    /* one decimal place, rt_kprintf has no floating point */
+    ns = (rt_uint32_t)((cycles_on - cycles_off) * 10000000000ULL / RTI_SYS_FREQ / events);
+    bytes_per_event = (rt_uint32_t)(bytes * 10 / events);
+
+    rt_kprintf("%-8s %8d %6d.%d %6d.%d\n", bench->name, (rt_uint32_t)events,
+               ns / 10, ns % 10, bytes_per_event / 10, bytes_per_event % 10);
+}
+
+#if RTI_CFG(RTI_SEM)
+/* fill the buffer without draining it and check the overflow packet */
+static void rti_bench_overflow(void)
+{
+    rt_uint32_t n, used, fill, lost = 0;
+    rt_uint8_t shift = 0;
+    rt_size_t size, i;
+
+    rti_bench_drain();
+    for (n = 0; n < RTI_BUFFER_SIZE; n++)
+    {
+        used = rti_buffer_used();
+        rti_bench_sem();
+        if (rti_buffer_used() == used)
+            break;
+    }
+    fill = rti_buffer_used();
+    for (i = 0; i < RTI_BENCH_DROP; i++)
+        rti_bench_sem();
+
+    /* the first packet after the buffer drains reports the lost packets */
+    rti_bench_drain();
+    rti_bench_sem();
+    size = rti_data_get(bench_buf, sizeof(bench_buf));
+    if (size > 1 && bench_buf[0] == RTI_ID_OVERFLOW)
+    {
+        for (i = 1; i < size; i++)
+        {
+            lost |= (bench_buf[i] & 0x7F) << shift;
+            shift += 7;
+            if (!(bench_buf[i] & 0x80))
+                break;
+        }
+    }
+    rti_bench_drain();
+
+    rt_kprintf("overflow: full after %d ops (%d bytes), %d ops dropped, %d packets reported lost\n",
+               n, fill, RTI_BENCH_DROP + 1, lost);
+}
+#endif
+
+#ifdef RTI_USING_COMPRESS
+/* record all cases mixed and compress the stream block by block */
+static void rti_bench_compress(rt_uint32_t count)
+{
+    rt_uint64_t raw = 0, packed = 0, cycles = 0;
+    rt_uint32_t n, i, ratio, per_byte, start;
+    rt_size_t size;
+
+    rti_bench_drain();
+    for (n = 0; n < count; n++)
+    {
+        for (i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++)
+            bench_cases[i].op();
+
+        /* compress full blocks, like a transport that keeps up */
+        while (rti_buffer_used() >= RTI_COMPRESS_BLOCK_SIZE)
+        {
+            start = RTI_GET_TIMESTAMP();
+            size = rti_compress_get(bench_frame);
+            cycles += (rt_uint32_t)(RTI_GET_TIMESTAMP() - start);
+            raw += RTI_COMPRESS_RAW_SIZE(bench_frame);
+            packed += size;
+        }
+    }
+    rti_bench_drain();
+    if (packed == 0)
+        return ;
+
+    ratio = (rt_uint32_t)(raw * 100 / packed);
+    per_byte = (rt_uint32_t)(cycles * 10 / raw);
+    rt_kprintf("compress: %d bytes to %d, ratio %d.%02d, %d.%d cycles/byte\n", (rt_uint32_t)raw,
+               (rt_uint32_t)packed, ratio / 100, ratio % 100, per_byte / 10, per_byte % 10);
+}
+#endif
+
+#ifdef RTI_USING_FILE
+/* record all cases mixed to a file, the rti thread writes it */
+static void rti_bench_file(rt_uint32_t count, const char *path)
+{
+    rt_uint32_t n, i;
+
+    if (rti_file_start(path, 0) != RT_EOK)
+    {
+        rt_kprintf("file: can not open %s\n", path);
+        return ;
+    }
+    for (n = 0; n < count; n++)
+    {
+        for (i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++)
+            bench_cases[i].op();
+
+        /* the rti thread is awake, let it write */
+        if (rti_buffer_used() > RTI_BUFFER_SIZE / 2)
+            rt_thread_mdelay(1);
+    }
+    rti_file_stop();
+    rti_file_show();
+}
+#endif
+
+static void rti_bench(int argc, char **argv)
+{
+    void (*notify)(void);
+    rt_thread_t helper;
+    rt_uint32_t count = RTI_BENCH_COUNT;
+    rt_size_t i;
+
+    if (argc > 1)
+        count = atoi(argv[1]);
+
+    rt_sem_init(&bench_sem, "bench", 0, RT_IPC_FLAG_FIFO);
+    rt_timer_init(&bench_timer, "bench", rti_bench_timeout, RT_NULL, 0,
+                  RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+#ifdef RT_USING_MUTEX
+    rt_mutex_init(&bench_mutex, "bench", RT_IPC_FLAG_FIFO);
+#endif
+#ifdef RT_USING_EVENT
+    rt_event_init(&bench_event, "bench", RT_IPC_FLAG_FIFO);
+#endif
+#ifdef RT_USING_MAILBOX
+    rt_mb_init(&bench_mb, "bench", bench_mb_pool, sizeof(bench_mb_pool) / sizeof(bench_mb_pool[0]), RT_IPC_FLAG_FIFO);
+#endif
+#ifdef RT_USING_MESSAGEQUEUE
+    rt_mq_init(&bench_mq, "bench", bench_mq_pool, sizeof(rt_uint32_t), sizeof(bench_mq_pool), RT_IPC_FLAG_FIFO);
+#endif
+#ifdef RT_USING_MEMPOOL
+    rt_mp_init(&bench_mp, "bench", bench_mp_pool, sizeof(bench_mp_pool), 32);
+#endif
+    bench_yield_run = RT_TRUE;
+    helper = rt_thread_create("bench", rti_bench_yield_entry, RT_NULL, 512,
+                              rt_thread_self()->current_priority, 1);
+    if (helper == RT_NULL)
+    {
+        rt_kprintf("rti bench: no memory for the helper thread\n");
+        return ;
+    }
+    rt_thread_startup(helper);
+    /* registered by the first run */
+    rti_module_register(&bench_module);
+
+    /* the bench is the only consumer while it runs */
+    notify = rti_data_new_data_notify_get_hook();
+    rti_data_new_data_notify_set_hook(RT_NULL);
+    rti_start();
+
+    rt_kprintf("classes 0x%03x\n", RTI_CFG_CLASSES);
+    rt_kprintf("case       events ns/event bytes/event\n");
+    for (i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++)
+        rti_bench_one(&bench_cases[i], count);
+#if RTI_CFG(RTI_SEM)
+    rti_bench_overflow();
+#endif
+#ifdef RTI_USING_COMPRESS
+    rti_bench_compress(count / 10);
+#endif
+
+    bench_yield_run = RT_FALSE;
+    rt_thread_mdelay(10);
+
+    rti_stop();
+    rti_bench_drain();
+#ifdef RTI_USING_FILE
+    if (argc > 2)
+        rti_bench_file(count / 10, argv[2]);
+#endif
+    rti_data_new_data_notify_set_hook(notify);
+
+    rt_sem_detach(&bench_sem);
+    rt_timer_detach(&bench_timer);
+#ifdef RT_USING_MUTEX
+    rt_mutex_detach(&bench_mutex);
+#endif
+#ifdef RT_USING_EVENT
+    rt_event_detach(&bench_event);
+#endif
+#ifdef RT_USING_MAILBOX
+    rt_mb_detach(&bench_mb);
+#endif
+#ifdef RT_USING_MESSAGEQUEUE
+    rt_mq_detach(&bench_mq);
+#endif
+#ifdef RT_USING_MEMPOOL
+    rt_mp_detach(&bench_mp);
+#endif
+}
+#ifdef RT_USING_FINSH
+MSH_CMD_EXPORT(rti_bench, measure rti hook overhead: rti_bench [count] [file]);
+#endif
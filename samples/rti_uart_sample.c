@@ -26,6 +26,7 @@
 #include <rtdevice.h>
 
 #include "rti.h"
+#include "rti_serial.h"
 
 #ifdef RT_USING_FINSH
 #include <finsh.h>
@@ -35,11 +36,9 @@
 #define PKG_RTI_UART_BAUD_RATE   BAUD_RATE_460800
 #endif
 
-#define TRANSIT_BUF_SIZE         (PKG_RTI_BUFFER_SIZE / 8)
 #define RTI_UART_BAUD_RATE       (PKG_RTI_UART_BAUD_RATE)
 #define RTI_UART_NAME            "rti_uart"
 
-static rt_uint8_t transit_buf[TRANSIT_BUF_SIZE];
 static rt_device_t rti_dev;
 
 #define REV_START_FIRSE_FARAM_BYTE0 0x53
@@ -53,12 +52,6 @@ static struct rt_semaphore rx_sem;
 static char rti_rx_stack[1024];
 static struct rt_thread rti_rx_th;
 
-void rti_data_new_data_notify(void)
-{
-    int ret = rti_data_get(transit_buf, TRANSIT_BUF_SIZE);
-    rt_device_write(rti_dev, 0, transit_buf, ret);
-}
-
 rt_err_t rt_ind(rt_device_t dev, rt_size_t size)
 {
     //rti_data_new_data_notify_set_hook(rti_data_new_data_notify);
@@ -90,8 +83,7 @@ static void rti_rx_entry(void *param)
         {
             if(rx_buff[0] == REV_START_FIRSE_FARAM_BYTE0 && rx_buff[1] == REV_START_FIRSE_FARAM_BYTE1)
             {
-                rti_data_new_data_notify_set_hook(rti_data_new_data_notify);
-                rti_start();
+                rti_serial_start(rti_dev);
             }
 
             rx_cnt = 0;
@@ -99,14 +91,12 @@ static void rti_rx_entry(void *param)
 
         if(ch == REV_START_SECOND_FARAM_BYTE)
         {
-            rti_data_new_data_notify_set_hook(rti_data_new_data_notify);
-            rti_start();
+            rti_serial_start(rti_dev);
         }
 
         if(ch == REV_STOP_FARAM_BYTE)
         {
-            rti_stop();
-            rti_data_new_data_notify_set_hook(NULL);
+            rti_serial_stop();
         }
     }
 }
@@ -28,21 +28,89 @@
                           This packet means: 500 packets lost, Timestamp is 0x40000
    02 0F 50          // ISR(15) Enter. Timestamp 80 (0x50)
    03 20             // ISR Exit. Timestamp 32 (0x20) (Shortest possible packet.)
-   event tryrecv packets:
-   ID|DataSize|len|String|Value|TimeStampDelta
-   3D|   05   |03 |726462| 01  | B90E
-   61|   5    | 3 | rdb  |  1  | 1849
+   object name packet, sent the first time an object is recorded:
+   ID|DataSize|Id    |len|String|TimeStampDelta
+   19|   07   |E0A402|03 |726462| 20
+   25|   7    | 0x9260| 3 | rdb  | 32
+   event tryrecv packets, the object is the shrunk Id of the name packet:
+   ID|DataSize|Id    |Value|TimeStampDelta
+   3D|   04   |E0A402| 01  | B90E
+   61|   4    | 0x9260|  1  | 1849
    B90E = 10111001 00001110 -> 0111 00111001 =1849
 */
 
 #include "rti.h"
+#include "rti_ring.h"
+#include "rti_trigger.h"
+#include "rti_stats.h"
+#include "rti_lock.h"
+#include "rti_throttle.h"
+#include "rti_telemetry.h"
+#include "rti_stack.h"
+#include "rti_alloc.h"
+#include "rti_device.h"
+
+#if defined(RTI_TIMESTAMP_TSC) || defined(RTI_TIMESTAMP_CLOCK)
+#include <time.h>
+#endif
 
-static struct
+#if (RTI_BUFFER_SIZE & (RTI_BUFFER_SIZE - 1)) != 0
+    #error "RTI_BUFFER_SIZE must be a power of two"
+#endif
+
+#if (RTI_NAME_CACHE_SIZE & (RTI_NAME_CACHE_SIZE - 1)) != 0
+    #error "RTI_NAME_CACHE_SIZE must be a power of two"
+#endif
+
+#if (RTI_LOG_BUFFER_SIZE & (RTI_LOG_BUFFER_SIZE - 1)) != 0
+    #error "RTI_LOG_BUFFER_SIZE must be zero or a power of two"
+#endif
+
+#if RTI_LOG_BUFFER_SIZE > 0
+    #define RTI_CHANNEL_NUM     2
+#else
+    #define RTI_CHANNEL_NUM     1
+#endif
+
+/*
+ * A channel is a buffer of its own with its own time base, overflow count
+ * and policy, so a flood of prints can not push the scheduler and
+ * interrupt events out. The one consumer interleaves the channels on
+ * packet boundaries, each switch is a RTI_ID_CHANNEL packet.
+ */
+struct rti_channel
 {
-    rt_uint32_t time_stamp_last;
+    struct rti_ring ring;
+
+    volatile rt_uint32_t time_stamp_last;
 
     /* rti overflow packet count*/
-    rt_uint32_t packet_count;
+    volatile rt_uint32_t packet_count;
+
+    /* RTI_OVERFLOW until the lost packets are reported */
+    volatile rt_uint8_t  state;
+
+    /* RTI_POLICY_STREAM or RTI_POLICY_OVERWRITE */
+    rt_uint8_t  policy;
+};
+
+static struct
+{
+    /* rti thread is suspended and waiting for data */
+    volatile rt_uint32_t thread_waiting;
+
+    /* events to record, zero while rti is stopped. The hooks only test
+     * this, it is rebuilt from enable and disable_nest when they change */
+    volatile rt_uint32_t mask;
+
+    /* preamble output of rti_dump and rti_preamble, set while it is encoded */
+    void (*dump)(const rt_uint8_t *ptr, rt_size_t length);
+
+    /* the context encoding the preamble, set before dump. The packets of
+     * the other contexts stay in the stream, or are dropped while rti_dump
+     * runs with rti stopped. */
+    rt_thread_t dump_thread;
+    rt_uint8_t  dump_nest;
 
     /* rti enable status*/
     rt_uint8_t  enable;
@@ -52,113 +120,358 @@ static struct
 
 } rti_status;
 
-struct rt_ringbuffer *tx_ringbuffer = RT_NULL;
+/* the classes of the objects whose name is sent once with NAME_RESOURCE */
+#define RTI_NAMED               (RTI_IPC | RTI_MEMPOOL | RTI_DEVICE)
+
+#if RTI_CFG(RTI_IPC)
+/* ipc object events, added to the id base of the object class */
+#define RTI_OBJECT_TRYTAKE      1
+#define RTI_OBJECT_TAKEN        2
+#define RTI_OBJECT_RELEASE      3
+
+struct rti_object_class
+{
+    rt_uint16_t flag;
+    rt_uint8_t  id_base;
+};
+
+/* indexed by the object class, which fits in the low four bits of the type */
+static const struct rti_object_class rti_object_class[16] =
+{
+#if RTI_CFG(RTI_SEM)
+    [RT_Object_Class_Semaphore]    = {RTI_SEM,     RTI_ID_SEM_BASE},
+#endif
+#if defined(RT_USING_MUTEX) && RTI_CFG(RTI_MUTEX)
+    [RT_Object_Class_Mutex]        = {RTI_MUTEX,   RTI_ID_MUTEX_BASE},
+#endif
+#if defined(RT_USING_EVENT) && RTI_CFG(RTI_EVENT)
+    [RT_Object_Class_Event]        = {RTI_EVENT,   RTI_ID_EVENT_BASE},
+#endif
+#if defined(RT_USING_MAILBOX) && RTI_CFG(RTI_MAILBOX)
+    [RT_Object_Class_MailBox]      = {RTI_MAILBOX, RTI_ID_MAILBOX_BASE},
+#endif
+#if defined(RT_USING_MESSAGEQUEUE) && RTI_CFG(RTI_QUEUE)
+    [RT_Object_Class_MessageQueue] = {RTI_QUEUE,   RTI_ID_QUEUE_BASE},
+#endif
+};
+#endif
+
+/* a packet being encoded in place in the buffer */
+struct rti_packet
+{
+    struct rti_channel *channel;
+    struct rti_ring *ring;
+
+    /* next byte to encode */
+    rt_uint32_t index;
+
+    /* interrupt level of a thread, see rti_ring_enter */
+    rt_base_t   level;
+
+    /* time stamp delta, encoded last */
+    rt_uint32_t delta;
+    rt_uint8_t  delta_size;
+
+#ifdef RTI_USING_TELEMETRY
+    rt_uint32_t start;
+#endif
+};
+
+/* the buffers are static, rti takes nothing from the heap */
+#ifdef RTI_BUFFER_SECTION
+    #define RTI_BUFFER_ATTR     ALIGN(RT_ALIGN_SIZE) SECTION(RTI_BUFFER_SECTION)
+#else
+    #define RTI_BUFFER_ATTR     ALIGN(RT_ALIGN_SIZE)
+#endif
+
+static struct rti_channel rti_channel[RTI_CHANNEL_NUM];
+RTI_BUFFER_ATTR static rt_uint8_t rti_event_pool[RTI_BUFFER_SIZE];
+#if RTI_CHANNEL_NUM > 1
+RTI_BUFFER_ATTR static rt_uint8_t rti_log_pool[RTI_LOG_BUFFER_SIZE];
+#endif
+
+/* the consumer side of the channels */
+static struct
+{
+#if RTI_CHANNEL_NUM > 1
+    /* channel being read */
+    rt_uint8_t  current;
+
+    /* bytes of the channel packet still to be read */
+    rt_uint8_t  mark_len;
+    rt_uint8_t  mark[4];
+#endif
+
+    /* end of the data of the last peek, a packet boundary */
+    rt_uint32_t boundary;
+} rti_reader;
+
+/* holds one preamble packet at a time while dumping */
+#define RTI_DUMP_BUFFER_SIZE    256
+static struct rti_channel dump_channel;
+static rt_uint8_t dump_pool[RTI_DUMP_BUFFER_SIZE];
+
+static struct rt_thread rti_thread_obj;
+ALIGN(RT_ALIGN_SIZE) static rt_uint8_t rti_thread_stack[RTI_THREAD_STACK_SIZE];
+
+#if RTI_CHANNEL_NUM > 1
+/* the deltas of a channel are 32 bits of time stamp, a channel quiet for
+ * half of that gets a packet to keep its time base recent */
+#define RTI_KEEPALIVE_AGE       0x80000000u
+static struct rt_timer rti_keepalive_timer;
+#endif
+
+/* fields of the packets below id 24, which have no length: the number of
+ * values, plus RTI_FIELD_STR when a string follows them */
+#define RTI_FIELD_STR           0x10
+static const rt_uint8_t rti_packet_fields[24] =
+{
+    [RTI_ID_OVERFLOW]          = 1,
+    [RTI_ID_ISR_ENTER]         = 1,
+    [RTI_ID_THREAD_START_EXEC] = 1,
+    [RTI_ID_THREAD_START_READY]= 1,
+    [RTI_ID_THREAD_STOP_READY] = 2,
+    [RTI_ID_THREAD_CREATE]     = 1,
+    [RTI_ID_THREAD_INFO]       = 2 | RTI_FIELD_STR,
+    [RTI_ID_SYSTIME_CYCLES]    = 1,
+    [RTI_ID_SYSTIME_US]        = 2,
+    [RTI_ID_SYSDESC]           = 0 | RTI_FIELD_STR,
+    [RTI_ID_USER_START]        = 1,
+    [RTI_ID_USER_STOP]         = 1,
+    [RTI_ID_TIMER_ENTER]       = 1,
+    [RTI_ID_STACK_INFO]        = 4,
+    [RTI_ID_MODULEDESC]        = 2 | RTI_FIELD_STR,
+};
 static rt_thread_t tidle, rti_thread;
 static const rt_uint8_t rti_sync[10] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 static void (*rti_data_new_data_notify)(void);
 
+#if RTI_CFG(RTI_NAMED)
+/* objects whose name has been sent, direct mapped by the object address */
+static rt_object_t rti_name_cache[RTI_NAME_CACHE_SIZE];
+#endif
+
+/* registered modules, the last one first */
+static struct rti_module *rti_module_list;
+static rt_uint8_t rti_module_num;
+
 /* rti recording functions */
-static void rti_overflow(void);
+static void rti_overflow(struct rti_channel *channel);
 static void rti_record_systime(void);
+static void rti_send_sys_info(void);
+static void rti_send_sys_desc(const char *ptr);
+static void rti_send_thread_list(void);
+static void rti_send_thread_info(const rt_thread_t thread);
+static void rti_send_packet_void(rt_uint16_t rti_id);
+static void rti_send_packet_value(rt_uint16_t rti_id, rt_uint32_t value);
+#if RTI_CFG(RTI_SCHEDULER | RTI_INTERRUPT)
 static void rti_on_idle(void);
+static void rti_thread_start_exec(rt_uint32_t thread);
+#endif
+#if RTI_CFG(RTI_INTERRUPT)
 static void rti_isr_enter(void);
 static void rti_isr_exit(void);
 static void rti_isr_to_scheduler(void);
+#endif
+#if RTI_CFG(RTI_TIMER)
 static void rti_enter_timer(rt_uint32_t timer);
 static void rti_exit_timer(void);
-static void rti_thread_start_exec(rt_uint32_t thread);
+#endif
+#if RTI_CFG(RTI_THREAD)
 static void rti_thread_stop_exec(void);
 static void rti_thread_start_ready(rt_uint32_t thread);
-static void rti_thread_stop_ready(rt_uint32_t thread);
 static void rti_thread_create(rt_uint32_t thread);
+#endif
+#if RTI_CFG(RTI_THREAD | RTI_SCHEDULER)
+static void rti_thread_stop_ready(rt_uint32_t thread);
+#endif
+#if RTI_CFG(RTI_IPC)
 static void rti_record_object(rt_uint32_t rti_id, struct rt_object *object);
-static void rti_send_sys_info(void);
-static void rti_send_sys_desc(const char *ptr);
-static void rti_send_thread_list(void);
-static void rti_send_thread_info(const rt_thread_t thread);
-static void rti_send_packet_void(rt_uint8_t rti_id);
-static void rti_send_packet_value(rt_uint8_t rti_id, rt_uint32_t value);
-static void rti_send_packet(rt_uint8_t rti_id, rt_uint8_t *packet_sta, rt_uint8_t *packet_end);
+#endif
+#if RTI_CFG(RTI_NAMED)
+static void rti_send_name(rt_object_t object);
+static void rti_send_name_list(void);
+#endif
+static void rti_send_module(const struct rti_module *module);
+static void rti_send_module_list(void);
 
 /* rti encodeing functions */
-static rt_uint8_t *rti_record_ready(rt_uint8_t *start);
-static rt_uint8_t *rti_encode_val(rt_uint8_t *present, rt_uint32_t value);
-static rt_uint8_t *rti_encode_str(rt_uint8_t *present, const char *ptr, rt_uint8_t max_len);
+static rt_bool_t rti_packet_begin(struct rti_packet *packet, rt_uint16_t rti_id, rt_uint16_t size);
+static rt_bool_t rti_packet_reserve(struct rti_packet *packet, struct rti_channel *channel, rt_uint16_t length);
+static void rti_packet_end(struct rti_packet *packet);
+static void rti_encode_val(struct rti_packet *packet, rt_uint32_t value);
+static void rti_encode_str(struct rti_packet *packet, const char *ptr, rt_uint8_t len);
+static rt_uint8_t rti_encode_val_size(rt_uint32_t value);
+static rt_uint8_t rti_encode_str_size(rt_uint8_t len);
+static rt_uint8_t rti_str_len(const char *ptr, rt_uint8_t max_len);
 static rt_uint32_t rti_shrink_id(rt_uint32_t Id);
+static rt_uint32_t rti_decode_val(struct rti_ring *ring, rt_uint32_t *index);
+static rt_uint32_t rti_packet_size(struct rti_ring *ring, rt_uint32_t index);
+#if RTI_CFG(RTI_NAMED)
+static rt_uint32_t rti_name_hash(rt_object_t object);
+#endif
 
-/* rti hook functions */
+/* rti hook functions, only for the event classes compiled in */
+#if RTI_CFG(RTI_TIMER)
 static void rti_timer_enter(rt_timer_t t);
 static void rti_timer_exit(rt_timer_t t);
+#endif
+#if RTI_CFG(RTI_THREAD)
 static void rti_thread_inited(rt_thread_t thread);
 static void rti_thread_suspend(rt_thread_t thread);
 static void rti_thread_resume(rt_thread_t thread);
+#endif
+#if RTI_CFG(RTI_SCHEDULER)
 static void rti_scheduler(rt_thread_t from, rt_thread_t to);
+#endif
 //static void rti_object_attach(rt_object_t object);
+#if RTI_CFG(RTI_THREAD | RTI_NAMED)
 static void rti_object_detach(rt_object_t object);
+#endif
+#if RTI_CFG(RTI_INTERRUPT)
 static void rti_interrupt_enter(void);
 static void rti_interrupt_leave(void);
+#endif
+#if RTI_CFG(RTI_IPC)
 static void rti_object_trytake(rt_object_t object);
 static void rti_object_take(rt_object_t object);
 static void rti_object_put(rt_object_t object);
+static void rti_object_event(rt_object_t object, rt_uint8_t event);
+#endif
+#if RTI_CFG(RTI_HEAP) && defined(RT_USING_HEAP)
+static void rti_malloc(void *ptr, rt_size_t size);
+static void rti_free(void *ptr);
+#endif
+#if RTI_CFG(RTI_MEMPOOL) && defined(RT_USING_MEMPOOL)
+static void rti_mp_alloc(struct rt_mempool *mp, void *block);
+static void rti_mp_free(struct rt_mempool *mp, void *block);
+#endif
 
 static int rti_init(void);
+static void rti_timestamp_init(void);
 static rt_size_t rti_data_put(const rt_uint8_t *ptr, rt_uint16_t length);
+static void rti_data_wakeup(struct rti_channel *channel);
+static rt_uint32_t rti_dump_ring(struct rti_ring *ring, void (*output)(const rt_uint8_t *ptr, rt_size_t length));
+static void rti_mask_update(void);
 
 #ifndef __on_rti_data_new_data_notify
     #define __on_rti_data_new_data_notify()          __ON_HOOK_ARGS(rti_data_new_data_notify, ())
 #endif
 
+#if RTI_CFG(RTI_IPC)
 /* rti hook functions */
+static void rti_object_event(rt_object_t object, rt_uint8_t event)
+{
+    const struct rti_object_class *object_class;
+
+#ifdef RTI_USING_LOCK
+    if (event == RTI_OBJECT_TRYTAKE)
+        rti_lock_trytake(object);
+    else if (event == RTI_OBJECT_TAKEN)
+        rti_lock_take(object);
+    else
+        rti_lock_release(object);
+#endif
+    /* classes without an entry have no flag and are never recorded */
+    object_class = &rti_object_class[object->type & 0x0F];
+    if (!(rti_status.mask & object_class->flag))
+        return ;
+#ifdef RTI_USING_TRIGGER
+    if (event == RTI_OBJECT_TAKEN)
+        rti_trigger_take(object);
+    else if (event == RTI_OBJECT_RELEASE)
+        rti_trigger_release(object);
+#endif
+#ifdef RTI_USING_THROTTLE
+    if (!rti_throttle_pass(object_class->flag))
+        return ;
+#endif
+    rti_record_object(object_class->id_base + event, object);
+}
+#endif
+
+#if RTI_CFG(RTI_TIMER)
 static void rti_timer_enter(rt_timer_t t)
 {
-    if (!rti_status.enable || rti_status.disable_nest[RTI_TIMER_NUM])
+#ifdef RTI_USING_STATS
+    rti_stats_timer_enter(t);
+#endif
+    if (!(rti_status.mask & RTI_TIMER))
         return ;
-    rti_enter_timer((rt_uint32_t)t);
+#ifdef RTI_USING_THROTTLE
+    if (!rti_throttle_timer_enter())
+        return ;
+#endif
+    rti_enter_timer((rt_uint32_t)(rt_ubase_t)t);
 }
 
 static void rti_timer_exit(rt_timer_t t)
 {
-    if (!rti_status.enable || rti_status.disable_nest[RTI_TIMER_NUM])
+#ifdef RTI_USING_STATS
+    rti_stats_timer_exit(t);
+#endif
+    if (!(rti_status.mask & RTI_TIMER))
+        return ;
+#ifdef RTI_USING_THROTTLE
+    if (!rti_throttle_timer_exit())
         return ;
+#endif
     rti_exit_timer();
 }
+#endif
 
+#if RTI_CFG(RTI_THREAD)
 static void rti_thread_inited(rt_thread_t thread)
 {
-    if (!rti_status.enable || rti_status.disable_nest[RTI_THREAD_NUM])
+#ifdef RTI_USING_STACK
+    rti_stack_add(thread);
+#endif
+    if (!(rti_status.mask & RTI_THREAD))
         return ;
-    rti_thread_create((rt_uint32_t)thread);
+    rti_thread_create((rt_uint32_t)(rt_ubase_t)thread);
     rti_send_thread_info(thread);
 }
 
 static void rti_thread_suspend(rt_thread_t thread)
 {
-    if (!rti_status.enable || rti_status.disable_nest[RTI_THREAD_NUM])
+    if (!(rti_status.mask & RTI_THREAD))
         return ;
-    rti_thread_stop_ready((rt_uint32_t)thread);
+    rti_thread_stop_ready((rt_uint32_t)(rt_ubase_t)thread);
 }
 
 static void rti_thread_resume(rt_thread_t thread)
 {
-    if (!rti_status.enable || rti_status.disable_nest[RTI_THREAD_NUM])
+    if (!(rti_status.mask & RTI_THREAD))
         return ;
-    rti_thread_start_ready((rt_uint32_t)thread);
+#ifdef RTI_USING_TRIGGER
+    rti_trigger_resume(thread);
+#endif
+    rti_thread_start_ready((rt_uint32_t)(rt_ubase_t)thread);
 }
+#endif
 
+#if RTI_CFG(RTI_SCHEDULER)
 static void rti_scheduler(rt_thread_t from, rt_thread_t to)
 {
-    if (!rti_status.enable || rti_status.disable_nest[RTI_SCHEDULER_NUM])
+#ifdef RTI_USING_STATS
+    rti_stats_schedule(from, to);
+#endif
+    if (!(rti_status.mask & RTI_SCHEDULER))
         return ;
-    rti_thread_stop_ready((rt_uint32_t)from);
+#ifdef RTI_USING_TRIGGER
+    rti_trigger_schedule(from, to);
+#endif
+    rti_thread_stop_ready((rt_uint32_t)(rt_ubase_t)from);
     if (to == tidle)
         rti_on_idle();
     else
-        rti_thread_start_exec((rt_uint32_t)to);
+        rti_thread_start_exec((rt_uint32_t)(rt_ubase_t)to);
 }
+#endif
 
 //static void rti_object_attach(rt_object_t object)
 //{
-//    if (!rti_status.enable || rti_status.disable_nest[RTI_THREAD_NUM])
+//    if (!(rti_status.mask & RTI_THREAD))
 //        return ;
 //    switch (object->type & (~RT_Object_Class_Static))
 //    {
@@ -171,24 +484,99 @@ static void rti_scheduler(rt_thread_t from, rt_thread_t to)
 //    }
 //}
 
-static void rti_object_detach(rt_object_t object)
+#if defined(RTI_USING_STATS) || defined(RTI_USING_ALLOC)
+#define RTI_THREAD_ENTRY(table, size, i)    ((struct rti_thread_entry *)((rt_uint8_t *)(table) + (i) * (size)))
+
+void *rti_thread_entry_find(void *table, rt_size_t size, rt_uint8_t num, rt_thread_t thread)
 {
-    if (!rti_status.enable || rti_status.disable_nest[RTI_THREAD_NUM])
-        return ;
-    switch (object->type & (~RT_Object_Class_Static))
+    rt_uint8_t i;
+
+    for (i = 0; i < num && thread != RT_NULL; i++)
+    {
+        if (RTI_THREAD_ENTRY(table, size, i)->thread == thread)
+            return RTI_THREAD_ENTRY(table, size, i);
+    }
+    return RT_NULL;
+}
+
+void *rti_thread_entry_get(void *table, rt_size_t size, rt_uint8_t num, rt_thread_t thread)
+{
+    struct rti_thread_entry *entry, *free = RT_NULL;
+    rt_uint8_t i;
+
+    if (thread == RT_NULL)
+        return RTI_THREAD_ENTRY(table, size, num);
+
+    /* removed entries leave holes, look at all of them */
+    for (i = 0; i < num; i++)
     {
-    case RT_Object_Class_Thread:
-        rti_thread_stop_exec();
-        break;
-    default:
-        break;
+        entry = RTI_THREAD_ENTRY(table, size, i);
+        if (entry->thread == thread)
+            return entry;
+        if (entry->thread == RT_NULL && free == RT_NULL)
+            free = entry;
     }
+
+    /* the scheduler still accounts a closing thread after its detach */
+    if (free == RT_NULL || (thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_CLOSE)
+        return RTI_THREAD_ENTRY(table, size, num);
+    free->thread = thread;
+    rt_strncpy(free->name, thread->name, RT_NAME_MAX);
+    return free;
+}
+#endif
+
+#if RTI_CFG(RTI_THREAD | RTI_NAMED)
+static void rti_object_detach(rt_object_t object)
+{
+#if RTI_CFG(RTI_NAMED)
+    rt_object_t *slot;
+
+    /* the address may be reused by an object with another name */
+    slot = &rti_name_cache[rti_name_hash(object)];
+    if (*slot == object)
+        *slot = RT_NULL;
+#endif
+
+#if RTI_CFG(RTI_DEVICE) && defined(RT_USING_DEVICE)
+    if ((object->type & (~RT_Object_Class_Static)) == RT_Object_Class_Device)
+        rti_device_remove((rt_device_t)object);
+#endif
+
+#if RTI_CFG(RTI_THREAD)
+    if ((object->type & (~RT_Object_Class_Static)) != RT_Object_Class_Thread)
+        return ;
+#ifdef RTI_USING_STACK
+    rti_stack_remove((rt_thread_t)object);
+#endif
+#ifdef RTI_USING_STATS
+    rti_stats_remove((rt_thread_t)object);
+#endif
+#ifdef RTI_USING_ALLOC
+    rti_alloc_remove((rt_thread_t)object);
+#endif
+    if (!(rti_status.mask & RTI_THREAD))
+        return ;
+    rti_thread_stop_exec();
+#endif
 }
+#endif
 
+#if RTI_CFG(RTI_INTERRUPT)
 static void rti_interrupt_enter(void)
 {
-    if (!rti_status.enable || rti_status.disable_nest[RTI_INTERRUPT_NUM])
+#ifdef RTI_USING_STATS
+    rti_stats_isr_enter();
+#endif
+    if (!(rti_status.mask & RTI_INTERRUPT))
+        return ;
+#ifdef RTI_USING_TRIGGER
+    rti_trigger_isr_enter();
+#endif
+#ifdef RTI_USING_THROTTLE
+    if (!rti_throttle_isr_enter())
         return ;
+#endif
     rti_isr_enter();
 }
 
@@ -196,8 +584,18 @@ static void rti_interrupt_leave(void)
 {
     rt_thread_t current;
 
-    if (!rti_status.enable || rti_status.disable_nest[RTI_INTERRUPT_NUM])
+#ifdef RTI_USING_STATS
+    rti_stats_isr_leave();
+#endif
+    if (!(rti_status.mask & RTI_INTERRUPT))
+        return ;
+#ifdef RTI_USING_TRIGGER
+    rti_trigger_isr_leave();
+#endif
+#ifdef RTI_USING_THROTTLE
+    if (!rti_throttle_isr_leave())
         return ;
+#endif
 
     if (rt_interrupt_get_nest())
     {
@@ -209,221 +607,527 @@ static void rti_interrupt_leave(void)
     if (current == tidle)
         rti_on_idle();
     else
-        rti_thread_start_exec((rt_uint32_t)current);
+        rti_thread_start_exec((rt_uint32_t)(rt_ubase_t)current);
 }
+#endif
 
+#if RTI_CFG(RTI_IPC)
 static void rti_object_trytake(rt_object_t object)
 {
-    if (!rti_status.enable)
-        return ;
-    switch (object->type & (~RT_Object_Class_Static))
-    {
-    case RT_Object_Class_Semaphore:
-        if (!rti_status.disable_nest[RTI_SEM_NUM])
-            rti_record_object(RTI_ID_SEM_TRYTAKE, object);
-        break;
-    case RT_Object_Class_Mutex:
-        if (!rti_status.disable_nest[RTI_MUTEX_NUM])
-            rti_record_object(RTI_ID_MUTEX_TRYTAKE, object);
-        break;
-    case RT_Object_Class_Event:
-        if (!rti_status.disable_nest[RTI_EVENT_NUM])
-            rti_record_object(RTI_ID_EVENT_TRYTAKE, object);
-        break;
-    case RT_Object_Class_MailBox:
-        if (!rti_status.disable_nest[RTI_MAILBOX_NUM])
-            rti_record_object(RTI_ID_MAILBOX_TRYTAKE, object);
-        break;
-    case RT_Object_Class_MessageQueue:
-        if (!rti_status.disable_nest[RTI_QUEUE_NUM])
-            rti_record_object(RTI_ID_QUEUE_TRYTAKE, object);
-        break;
-    }
+    rti_object_event(object, RTI_OBJECT_TRYTAKE);
 }
 
 static void rti_object_take(rt_object_t object)
 {
-    if (!rti_status.enable)
-        return ;
-    switch (object->type & (~RT_Object_Class_Static))
-    {
-    case RT_Object_Class_Semaphore:
-        if (!rti_status.disable_nest[RTI_SEM_NUM])
-            rti_record_object(RTI_ID_SEM_TAKEN, object);
-        break;
-    case RT_Object_Class_Mutex:
-        if (!rti_status.disable_nest[RTI_MUTEX_NUM])
-            rti_record_object(RTI_ID_MUTEX_TAKEN, object);
-        break;
-    case RT_Object_Class_Event:
-        if (!rti_status.disable_nest[RTI_EVENT_NUM])
-            rti_record_object(RTI_ID_EVENT_TAKEN, object);
-        break;
-    case RT_Object_Class_MailBox:
-        if (!rti_status.disable_nest[RTI_MAILBOX_NUM])
-            rti_record_object(RTI_ID_MAILBOX_TAKEN, object);
-        break;
-    case RT_Object_Class_MessageQueue:
-        if (!rti_status.disable_nest[RTI_QUEUE_NUM])
-            rti_record_object(RTI_ID_QUEUE_TAKEN, object);
-        break;
-    }
+    rti_object_event(object, RTI_OBJECT_TAKEN);
 }
 
 static void rti_object_put(rt_object_t object)
 {
-    if (!rti_status.enable)
-        return ;
-    switch (object->type & (~RT_Object_Class_Static))
-    {
-    case RT_Object_Class_Semaphore:
-        if (!rti_status.disable_nest[RTI_SEM_NUM])
-            rti_record_object(RTI_ID_SEM_RELEASE, object);
-        break;
-    case RT_Object_Class_Mutex:
-        if (!rti_status.disable_nest[RTI_MUTEX_NUM])
-            rti_record_object(RTI_ID_MUTEX_RELEASE, object);
-        break;
-    case RT_Object_Class_Event:
-        if (!rti_status.disable_nest[RTI_EVENT_NUM])
-            rti_record_object(RTI_ID_EVENT_RELEASE, object);
-        break;
-    case RT_Object_Class_MailBox:
-        if (!rti_status.disable_nest[RTI_MAILBOX_NUM])
-            rti_record_object(RTI_ID_MAILBOX_RELEASE, object);
-        break;
-    case RT_Object_Class_MessageQueue:
-        if (!rti_status.disable_nest[RTI_QUEUE_NUM])
-            rti_record_object(RTI_ID_QUEUE_RELEASE, object);
-        break;
-    }
+    rti_object_event(object, RTI_OBJECT_RELEASE);
 }
+#endif
 
-/* rti encodeing functions */
-static rt_uint8_t *rti_record_ready(rt_uint8_t *start)
+#if (RTI_CFG(RTI_HEAP) && defined(RT_USING_HEAP)) || (RTI_CFG(RTI_MEMPOOL) && defined(RT_USING_MEMPOOL))
+/* the thread that allocates, 0 before the scheduler runs */
+static rt_uint32_t rti_thread_id(void)
+{
+    rt_thread_t thread = rt_thread_self();
+
+    return thread != RT_NULL ? rti_shrink_id((rt_uint32_t)(rt_ubase_t)thread) : 0;
+}
+#endif
+
+#if RTI_CFG(RTI_HEAP) && defined(RT_USING_HEAP)
+static void rti_malloc(void *ptr, rt_size_t size)
+{
+    rt_uint32_t values[3];
+
+#ifdef RTI_USING_ALLOC
+    rti_alloc_malloc(size);
+#endif
+    if (!(rti_status.mask & RTI_HEAP))
+        return ;
+#ifdef RTI_USING_THROTTLE
+    if (!rti_throttle_pass(RTI_HEAP))
+        return ;
+#endif
+    values[0] = size;
+    values[1] = rti_shrink_id((rt_uint32_t)(rt_ubase_t)ptr);
+    values[2] = rti_thread_id();
+    rti_record_values(RTI_ID_MALLOC, values, 3);
+}
+
+static void rti_free(void *ptr)
+{
+    rt_uint32_t values[2];
+
+#ifdef RTI_USING_ALLOC
+    rti_alloc_free();
+#endif
+    if (!(rti_status.mask & RTI_HEAP))
+        return ;
+#ifdef RTI_USING_THROTTLE
+    if (!rti_throttle_pass(RTI_HEAP))
+        return ;
+#endif
+    values[0] = rti_shrink_id((rt_uint32_t)(rt_ubase_t)ptr);
+    values[1] = rti_thread_id();
+    rti_record_values(RTI_ID_FREE, values, 2);
+}
+#endif
+
+#if RTI_CFG(RTI_MEMPOOL) && defined(RT_USING_MEMPOOL)
+static void rti_mp_event(rt_uint16_t rti_id, struct rt_mempool *mp, void *block)
+{
+    rt_uint32_t values[3];
+
+    if (!(rti_status.mask & RTI_MEMPOOL))
+        return ;
+#ifdef RTI_USING_THROTTLE
+    if (!rti_throttle_pass(RTI_MEMPOOL))
+        return ;
+#endif
+    /* the name is sent once, the events only carry the pool id */
+    if (rti_name_cache[rti_name_hash(&mp->parent)] != &mp->parent)
+        rti_send_name(&mp->parent);
+
+    values[0] = rti_shrink_id((rt_uint32_t)(rt_ubase_t)mp);
+    values[1] = rti_shrink_id((rt_uint32_t)(rt_ubase_t)block);
+    values[2] = rti_thread_id();
+    rti_record_values(rti_id, values, 3);
+}
+
+static void rti_mp_alloc(struct rt_mempool *mp, void *block)
+{
+#ifdef RTI_USING_ALLOC
+    /* the block is memory of the pool, not of the heap */
+    rti_alloc_malloc(0);
+#endif
+    rti_mp_event(RTI_ID_MP_ALLOC, mp, block);
+}
+
+static void rti_mp_free(struct rt_mempool *mp, void *block)
+{
+#ifdef RTI_USING_ALLOC
+    rti_alloc_free();
+#endif
+    rti_mp_event(RTI_ID_MP_FREE, mp, block);
+}
+#endif
+
+#if RTI_CFG(RTI_DEVICE) && defined(RT_USING_DEVICE)
+/* the events of the device trampolines in rti_device.c */
+void rti_record_device(rt_uint16_t rti_id, rt_device_t device, const rt_uint32_t *values, rt_uint8_t count)
 {
-    /* reserve packet header size */
-    return start + 4;
+    rt_uint32_t packet[4];
+    rt_uint8_t i;
+
+    if (!(rti_status.mask & RTI_DEVICE))
+        return ;
+#ifdef RTI_USING_THROTTLE
+    if (!rti_throttle_pass(RTI_DEVICE))
+        return ;
+#endif
+    /* the name is sent once, the events only carry the device id */
+    if (rti_name_cache[rti_name_hash(&device->parent)] != &device->parent)
+        rti_send_name(&device->parent);
+
+    if (count > 3)
+        count = 3;
+    packet[0] = rti_shrink_id((rt_uint32_t)(rt_ubase_t)device);
+    for (i = 0; i < count; i++)
+        packet[i + 1] = values[i];
+    rti_record_values(rti_id, packet, count + 1);
 }
+#endif
 
-static rt_uint8_t *rti_encode_val(rt_uint8_t *present, rt_uint32_t value)
+/* rti encodeing functions */
+static rt_uint8_t rti_encode_val_size(rt_uint32_t value)
 {
+    rt_uint8_t size = 1;
+
     while (value > 0x7F)
     {
-        *present++ = (rt_uint8_t)(value | 0x80);
+        size++;
         value >>= 7;
-    };
-    *present++ = (rt_uint8_t)value;
-    return present;
+    }
+    return size;
+}
+
+static rt_uint8_t rti_encode_str_size(rt_uint8_t len)
+{
+    return (len < 0xFF ? 1 : 3) + len;
 }
 
-static rt_uint8_t *rti_encode_str(rt_uint8_t *present, const char *ptr, rt_uint8_t max_len)
+static rt_uint8_t rti_str_len(const char *ptr, rt_uint8_t max_len)
 {
-    rt_uint8_t len = 0, n;
+    rt_uint8_t len = 0;
 
     while (*(ptr + len) && len < max_len)
     {
         len++;
     }
+    return len;
+}
+
+static void rti_encode_val(struct rti_packet *packet, rt_uint32_t value)
+{
+    while (value > 0x7F)
+    {
+        rti_ring_putc(packet->ring, packet->index++, (rt_uint8_t)(value | 0x80));
+        value >>= 7;
+    };
+    rti_ring_putc(packet->ring, packet->index++, (rt_uint8_t)value);
+}
+
+static void rti_encode_str(struct rti_packet *packet, const char *ptr, rt_uint8_t len)
+{
     if (len < 0xFF)
     {
-        *present++ = len;
+        rti_ring_putc(packet->ring, packet->index++, len);
     }
     else
     {
-        *present++ = 0xFF;
-        *present++ = (len & 0xFF);
-        *present++ = ((len >> 8) & 0xFF);
+        rti_ring_putc(packet->ring, packet->index++, 0xFF);
+        rti_ring_putc(packet->ring, packet->index++, (len & 0xFF));
+        rti_ring_putc(packet->ring, packet->index++, 0);
     }
-    for (n = 0; n < len; n++)
-    {
-        *present++ = *ptr++;
-    }
-    return present;
+    rti_ring_write(packet->ring, packet->index, (const rt_uint8_t *)ptr, len);
+    packet->index += len;
 }
 
 static rt_uint32_t rti_shrink_id(rt_uint32_t Id)
 {
-    return ((Id) - RTI_RAM_BASE_ADDRESS) >> RTI_ID_SHIFT;
+    return RTI_SHRINK_ID(Id);
 }
 
-/* rti recording functions */
-static void rti_overflow(void)
+static rt_uint32_t rti_decode_val(struct rti_ring *ring, rt_uint32_t *index)
 {
-    rt_uint8_t packet[11];
-    rt_uint8_t *present;
-    rt_uint32_t time_stamp, delta;
+    rt_uint32_t value = 0;
+    rt_uint8_t  ch, shift = 0;
 
-    packet[0] = RTI_ID_OVERFLOW;
-    present   = &packet[1];
-    present = rti_encode_val(present, rti_status.packet_count);
+    do
+    {
+        ch = rti_ring_getc(ring, (*index)++);
+        value |= (rt_uint32_t)(ch & 0x7F) << shift;
+        shift += 7;
+    }
+    while ((ch & 0x80) && shift < 35);
+    return value;
+}
 
-    time_stamp  = RTI_GET_TIMESTAMP();
-    delta = time_stamp - rti_status.time_stamp_last;
-    present = rti_encode_val(present, delta);
+/* length of the packet at index, lets the flight recorder drop whole packets */
+static rt_uint32_t rti_packet_size(struct rti_ring *ring, rt_uint32_t index)
+{
+    rt_uint32_t start = index, id, len;
+    rt_uint8_t  fields;
 
-    /* send overflow package success */
-    if (rti_data_put(packet, present - packet) > 0)
+    id = rti_decode_val(ring, &index);
+    if (id == RTI_ID_NOP)
+        return 1;
+    if (id < 24)
     {
-        rti_status.enable = RTI_ENABLE;
-        rti_status.time_stamp_last = time_stamp;
-        rti_status.packet_count = 0;
+        fields = rti_packet_fields[id];
+        for (len = fields & 0x0F; len > 0; len--)
+            rti_decode_val(ring, &index);
+        if (fields & RTI_FIELD_STR)
+        {
+            len = rti_ring_getc(ring, index++);
+            if (len == 0xFF)
+            {
+                len  = rti_ring_getc(ring, index++);
+                len |= rti_ring_getc(ring, index++) << 8;
+            }
+            index += len;
+        }
     }
     else
     {
-        rti_status.packet_count ++;
+        len = rti_decode_val(ring, &index);
+        if (len > 0x3FFF)
+            return 0;
+        index += len;
     }
+    /* time stamp delta */
+    rti_decode_val(ring, &index);
+    return index - start;
 }
 
-static void rti_record_systime(void)
+#if RTI_CFG(RTI_NAMED)
+static rt_uint32_t rti_name_hash(rt_object_t object)
 {
-    rt_uint8_t packet[RTI_INFO_SIZE + 2 * RTI_VALUE_SIZE];
-    rt_uint8_t *start, *present;
-    rt_uint64_t systime;
-
-    systime = (rt_uint64_t)(rt_tick_get() * 1000 / RT_TICK_PER_SECOND);
-
-    start = rti_record_ready(packet);
-    present = rti_encode_val(start, (rt_uint32_t)systime);
-    present = rti_encode_val(present, (rt_uint32_t)(systime >> 32));
+    rt_uint32_t id = (rt_uint32_t)(rt_ubase_t)object >> RTI_ID_SHIFT;
 
-    rti_send_packet(RTI_ID_SYSTIME_US, start, present);
+    return (id ^ (id >> 5) ^ (id >> 10)) & (RTI_NAME_CACHE_SIZE - 1);
 }
+#endif
 
-static void rti_record_object(rt_uint32_t rti_id, struct rt_object *object)
+/* whether we are the context encoding a preamble, rti_dump may run in
+ * an interrupt or a fault handler */
+static rt_bool_t rti_dump_context(void)
 {
-    rt_uint8_t packet[RTI_INFO_SIZE + 4 * RTI_VALUE_SIZE];
-    rt_uint8_t *start, *present;
-
-    start = rti_record_ready(packet);
-    present = rti_encode_str(start, object->name, RT_NAME_MAX);
-    if ((object->type & (~RT_Object_Class_Static)) == RT_Object_Class_Event)
-        present = rti_encode_val(present, ((rt_event_t)object)->set);
-
-    rti_send_packet(rti_id, start, present);
+    return rti_status.dump != RT_NULL &&
+           rti_status.dump_thread == rt_thread_self() &&
+           rti_status.dump_nest == rt_interrupt_get_nest();
 }
 
-static void rti_on_idle(void)
+/* the channel of a packet, the dump channel for the preamble */
+static struct rti_channel *rti_channel_of(rt_uint16_t rti_id)
 {
-    rti_send_packet_void(RTI_ID_IDLE);
+    if (rti_dump_context())
+        return &dump_channel;
+#if RTI_CHANNEL_NUM > 1
+    if (rti_id == RTI_ID_PRINT_FORMATTED || rti_id == RTI_ID_PRINTF)
+        return &rti_channel[RTI_CHANNEL_LOG];
+#endif
+    return &rti_channel[RTI_CHANNEL_EVENT];
 }
 
-static void rti_isr_enter(void)
+/*
+ * Reserve length bytes plus the time stamp delta in the buffer.
+ * On success the caller encodes exactly length bytes and ends the packet.
+ */
+static rt_bool_t rti_packet_reserve(struct rti_packet *packet, struct rti_channel *channel, rt_uint16_t length)
 {
-    rti_send_packet_value(RTI_ID_ISR_ENTER, RTI_GET_ISR_ID());
-}
+    struct rti_ring *ring;
+    rt_uint32_t index, time_stamp, time_stamp_last, delta;
+    rt_uint8_t  delta_size;
+    rt_err_t    result;
+
+    ring = &channel->ring;
+    packet->level = rti_ring_enter(ring);
+    do
+    {
+        /* the time stamp is taken inside the reservation, a packet that
+         * interrupts us makes the reservation fail and we sample again */
+        index           = ring->reserve;
+        time_stamp_last = channel->time_stamp_last;
+        time_stamp      = RTI_GET_TIMESTAMP();
+        delta           = (time_stamp - time_stamp_last) >> RTI_TIMESTAMP_SHIFT;
+        delta_size      = rti_encode_val_size(delta);
+        result = rti_ring_reserve(ring, index, length + delta_size);
+    }
+    while (result == -RT_EBUSY);
 
-static void rti_isr_exit(void)
-{
-    rti_send_packet_void(RTI_ID_ISR_EXIT);
-}
+    if (result != RT_EOK)
+    {
+        rti_ring_leave(ring, packet->level);
+        return RT_FALSE;
+    }
 
-static void rti_isr_to_scheduler(void)
-{
-    rti_send_packet_void(RTI_ID_ISR_TO_SCHEDULER);
+    /* a packet got in between the reservation and here. It follows us in
+     * the stream but its delta is relative to time_stamp_last, so we
+     * report no time advance and it carries the whole delta. The cycles
+     * below the prescaler stay in time_stamp_last for the next delta. */
+    if (!RTI_ATOMIC_CAS(&channel->time_stamp_last, time_stamp_last,
+                        time_stamp_last + (delta << RTI_TIMESTAMP_SHIFT)))
+        delta = 0;
+
+    packet->channel    = channel;
+    packet->ring       = ring;
+    packet->index      = index;
+    packet->delta      = delta;
+    packet->delta_size = delta_size;
+#ifdef RTI_USING_TELEMETRY
+    packet->start      = time_stamp;
+#endif
+    return RT_TRUE;
 }
 
-static void rti_enter_timer(rt_uint32_t timer)
+/* reserve a packet and encode its header, size is the payload size */
+static rt_bool_t rti_packet_begin(struct rti_packet *packet, rt_uint16_t rti_id, rt_uint16_t size)
+{
+    struct rti_channel *channel;
+    rt_uint16_t length;
+
+    if (rti_status.enable == RTI_DISABLE && !rti_dump_context())
+        return RT_FALSE;
+
+    if (rti_id < 24)
+        length = 1 + size;
+    else
+        length = rti_encode_val_size(rti_id) + rti_encode_val_size(size) + size;
+
+    channel = rti_channel_of(rti_id);
+    if (channel->state == RTI_OVERFLOW)
+    {
+        rti_overflow(channel);
+        if (channel->state != RTI_ENABLE)
+        {
+            rti_atomic_add(&channel->packet_count, 1);
+#ifdef RTI_USING_TELEMETRY
+            rti_telemetry_drop(rti_id, length);
+#endif
+            return RT_FALSE;
+        }
+    }
+
+    /* overflow */
+    if (!rti_packet_reserve(packet, channel, length))
+    {
+        channel->state = RTI_OVERFLOW;
+        rti_atomic_add(&channel->packet_count, 1);
+#ifdef RTI_USING_TELEMETRY
+        rti_telemetry_drop(rti_id, length);
+#endif
+        rti_overflow(channel);
+        return RT_FALSE;
+    }
+#ifdef RTI_USING_TELEMETRY
+    rti_telemetry_record(rti_id, length + packet->delta_size);
+#endif
+
+    rti_encode_val(packet, rti_id);
+    if (rti_id >= 24)
+        rti_encode_val(packet, size);
+    return RT_TRUE;
+}
+
+/* encode the time stamp delta and publish the packet */
+static void rti_packet_end(struct rti_packet *packet)
+{
+    rt_uint32_t delta = packet->delta;
+    rt_uint8_t  n;
+
+    /* keep the reserved size, a varint may be padded with 0x80 bytes */
+    for (n = 1; n < packet->delta_size; n++)
+    {
+        rti_ring_putc(packet->ring, packet->index++, (rt_uint8_t)(delta | 0x80));
+        delta >>= 7;
+    }
+    rti_ring_putc(packet->ring, packet->index, (rt_uint8_t)delta);
+#ifdef RTI_USING_TELEMETRY
+    if (packet->channel == &rti_channel[RTI_CHANNEL_EVENT])
+        rti_telemetry_end(packet->start, packet->ring->reserve - packet->ring->read);
+#endif
+    rti_ring_leave(packet->ring, packet->level);
+
+    rti_data_wakeup(packet->channel);
+}
+
+/* rti recording functions */
+static void rti_overflow(struct rti_channel *channel)
+{
+    struct rti_packet packet;
+    rt_uint32_t packet_count;
+
+    packet_count = channel->packet_count;
+
+    /* send overflow package success, keep the packets lost meanwhile */
+    if (rti_packet_reserve(&packet, channel, 1 + rti_encode_val_size(packet_count)))
+    {
+#ifdef RTI_USING_TELEMETRY
+        rti_telemetry_record(RTI_ID_OVERFLOW, 1 + rti_encode_val_size(packet_count) + packet.delta_size);
+#endif
+        rti_encode_val(&packet, RTI_ID_OVERFLOW);
+        rti_encode_val(&packet, packet_count);
+        rti_packet_end(&packet);
+
+        channel->state = RTI_ENABLE;
+        rti_atomic_add(&channel->packet_count, -packet_count);
+    }
+}
+
+#if RTI_CHANNEL_NUM > 1
+/* a CHANNEL packet naming the channel it is in only moves the time on */
+static void rti_keepalive(void *parameter)
+{
+    struct rti_channel *channel;
+    struct rti_packet packet;
+    rt_uint8_t i;
+
+    if (rti_status.enable == RTI_DISABLE)
+        return ;
+    for (i = 0; i < RTI_CHANNEL_NUM; i++)
+    {
+        channel = &rti_channel[i];
+        if (channel->state != RTI_ENABLE ||
+                RTI_GET_TIMESTAMP() - channel->time_stamp_last < RTI_KEEPALIVE_AGE)
+            continue;
+        if (!rti_packet_reserve(&packet, channel, 3))
+            continue;
+#ifdef RTI_USING_TELEMETRY
+        rti_telemetry_record(RTI_ID_CHANNEL, 3 + packet.delta_size);
+#endif
+        rti_encode_val(&packet, RTI_ID_CHANNEL);
+        rti_encode_val(&packet, 1);
+        rti_encode_val(&packet, i);
+        rti_packet_end(&packet);
+    }
+}
+#endif
+
+static void rti_record_systime(void)
+{
+    struct rti_packet packet;
+    rt_uint64_t systime;
+
+    systime = (rt_uint64_t)(rt_tick_get() * 1000 / RT_TICK_PER_SECOND);
+
+    if (!rti_packet_begin(&packet, RTI_ID_SYSTIME_US,
+                          rti_encode_val_size((rt_uint32_t)systime) +
+                          rti_encode_val_size((rt_uint32_t)(systime >> 32))))
+        return ;
+    rti_encode_val(&packet, (rt_uint32_t)systime);
+    rti_encode_val(&packet, (rt_uint32_t)(systime >> 32));
+    rti_packet_end(&packet);
+}
+
+#if RTI_CFG(RTI_IPC)
+static void rti_record_object(rt_uint32_t rti_id, struct rt_object *object)
+{
+    struct rti_packet packet;
+    rt_uint32_t id, set = 0;
+    rt_uint8_t size;
+
+    /* the name is sent once, the events only carry the object id */
+    if (rti_name_cache[rti_name_hash(object)] != object)
+        rti_send_name(object);
+
+    id   = rti_shrink_id((rt_uint32_t)(rt_ubase_t)object);
+    size = rti_encode_val_size(id);
+    if ((object->type & (~RT_Object_Class_Static)) == RT_Object_Class_Event)
+    {
+        set   = ((rt_event_t)object)->set;
+        size += rti_encode_val_size(set);
+    }
+
+    if (!rti_packet_begin(&packet, rti_id, size))
+        return ;
+    rti_encode_val(&packet, id);
+    if ((object->type & (~RT_Object_Class_Static)) == RT_Object_Class_Event)
+        rti_encode_val(&packet, set);
+    rti_packet_end(&packet);
+}
+#endif
+
+#if RTI_CFG(RTI_SCHEDULER | RTI_INTERRUPT)
+static void rti_on_idle(void)
+{
+    rti_send_packet_void(RTI_ID_IDLE);
+}
+#endif
+
+#if RTI_CFG(RTI_INTERRUPT)
+static void rti_isr_enter(void)
+{
+    rti_send_packet_value(RTI_ID_ISR_ENTER, RTI_GET_ISR_ID());
+}
+
+static void rti_isr_exit(void)
+{
+    rti_send_packet_void(RTI_ID_ISR_EXIT);
+}
+
+static void rti_isr_to_scheduler(void)
+{
+    rti_send_packet_void(RTI_ID_ISR_TO_SCHEDULER);
+}
+#endif
+
+#if RTI_CFG(RTI_TIMER)
+static void rti_enter_timer(rt_uint32_t timer)
 {
     rti_send_packet_value(RTI_ID_TIMER_ENTER, rti_shrink_id(timer));
 }
@@ -432,12 +1136,16 @@ static void rti_exit_timer(void)
 {
     rti_send_packet_void(RTI_ID_TIMER_EXIT);
 }
+#endif
 
+#if RTI_CFG(RTI_SCHEDULER | RTI_INTERRUPT)
 static void rti_thread_start_exec(rt_uint32_t thread)
 {
     rti_send_packet_value(RTI_ID_THREAD_START_EXEC, rti_shrink_id(thread));
 }
+#endif
 
+#if RTI_CFG(RTI_THREAD)
 static void rti_thread_stop_exec(void)
 {
     rti_send_packet_void(RTI_ID_THREAD_STOP_EXEC);
@@ -447,81 +1155,171 @@ static void rti_thread_start_ready(rt_uint32_t thread)
 {
     rti_send_packet_value(RTI_ID_THREAD_START_READY, rti_shrink_id(thread));
 }
+#endif
 
+#if RTI_CFG(RTI_THREAD | RTI_SCHEDULER)
 static void rti_thread_stop_ready(rt_uint32_t thread)
 {
-    rt_uint8_t packet[RTI_INFO_SIZE + 2 * RTI_VALUE_SIZE];
-    rt_uint8_t *start, *present;
-
-    start = rti_record_ready(packet);
-    present = rti_encode_val(start, rti_shrink_id(thread));
-    present = rti_encode_val(present, 0);
+    struct rti_packet packet;
+    rt_uint32_t id;
 
-    rti_send_packet(RTI_ID_THREAD_STOP_READY, start, present);
+    id = rti_shrink_id(thread);
+    if (!rti_packet_begin(&packet, RTI_ID_THREAD_STOP_READY, rti_encode_val_size(id) + 1))
+        return ;
+    rti_encode_val(&packet, id);
+    rti_encode_val(&packet, 0);
+    rti_packet_end(&packet);
 }
+#endif
 
+#if RTI_CFG(RTI_THREAD)
 static void rti_thread_create(rt_uint32_t thread)
 {
     rti_send_packet_value(RTI_ID_THREAD_CREATE, rti_shrink_id(thread));
 }
+#endif
 
 static void rti_send_sys_desc(const char *ptr)
 {
-    rt_uint8_t packet[RTI_INFO_SIZE + 1 + RTI_MAX_STRING_LEN];
-    rt_uint8_t *start, *present;
+    struct rti_packet packet;
+    rt_uint8_t len;
 
-    start = rti_record_ready(packet);
-    present = rti_encode_str(start, ptr, RTI_MAX_STRING_LEN);
-
-    rti_send_packet(RTI_ID_SYSDESC, start, present);
+    len = rti_str_len(ptr, RTI_MAX_STRING_LEN);
+    if (!rti_packet_begin(&packet, RTI_ID_SYSDESC, rti_encode_str_size(len)))
+        return ;
+    rti_encode_str(&packet, ptr, len);
+    rti_packet_end(&packet);
 }
 
 static void rti_send_sys_info(void)
 {
+    struct rti_packet packet;
+
     // Add sync packet ( 10 * 0x00)
     // Send system description
     // Send system time
     // Send thread list
     rti_data_put(rti_sync, 10);
     rti_send_packet_void(RTI_ID_START);
+    if (rti_packet_begin(&packet, RTI_ID_INIT,
+                         rti_encode_val_size(RTI_SYS_FREQ >> RTI_TIMESTAMP_SHIFT) +
+                         rti_encode_val_size(RTI_CPU_FREQ) +
+                         rti_encode_val_size(RTI_RAM_BASE_ADDRESS) +
+                         rti_encode_val_size(RTI_ID_SHIFT)))
     {
-        rt_uint8_t packet[RTI_INFO_SIZE + 4 * RTI_VALUE_SIZE];
-        rt_uint8_t *start, *present;
-
-        start = rti_record_ready(packet);
-        present = rti_encode_val(start, RTI_SYS_FREQ);
-        present = rti_encode_val(present, RTI_CPU_FREQ);
-        present = rti_encode_val(present, RTI_RAM_BASE_ADDRESS);
-        present = rti_encode_val(present, RTI_ID_SHIFT);
-
-        rti_send_packet(RTI_ID_INIT, start, present);
+        rti_encode_val(&packet, RTI_SYS_FREQ >> RTI_TIMESTAMP_SHIFT);
+        rti_encode_val(&packet, RTI_CPU_FREQ);
+        rti_encode_val(&packet, RTI_RAM_BASE_ADDRESS);
+        rti_encode_val(&packet, RTI_ID_SHIFT);
+        rti_packet_end(&packet);
     }
     rti_send_sys_desc("N="RTI_APP_NAME",O=RT-Thread");
     rti_send_sys_desc(RTI_SYS_DESC0);
     rti_send_sys_desc(RTI_SYS_DESC1);
     rti_record_systime();
     rti_send_thread_list();
+#if RTI_CFG(RTI_NAMED)
+    rti_send_name_list();
+#endif
+    rti_send_module_list();
 }
 
 static void rti_send_thread_info(const rt_thread_t thread)
 {
-    rt_uint8_t packet[RTI_INFO_SIZE + RTI_VALUE_SIZE + 1 + 32];
-    rt_uint8_t *start, *present;
+    struct rti_packet packet;
+    rt_uint32_t id, used = 0;
+    rt_uint8_t len;
 
     rt_enter_critical();
-    start = rti_record_ready(packet);
-    present = rti_encode_val(start, rti_shrink_id((rt_uint32_t)thread));
-    present = rti_encode_val(present, thread->current_priority);
-    present = rti_encode_str(present, thread->name, 32);
-    rti_send_packet(RTI_ID_THREAD_INFO, start, present);
-
-    present = rti_encode_val(start, rti_shrink_id((rt_uint32_t)thread));
-    present = rti_encode_val(present, (rt_uint32_t)thread->stack_addr);
-    present = rti_encode_val(present, thread->stack_size);
-    present = rti_encode_val(present, 0);
-    rti_send_packet(RTI_ID_STACK_INFO, start, present);
+    id  = rti_shrink_id((rt_uint32_t)(rt_ubase_t)thread);
+    len = rti_str_len(thread->name, 32);
+    if (rti_packet_begin(&packet, RTI_ID_THREAD_INFO,
+                         rti_encode_val_size(id) +
+                         rti_encode_val_size(thread->current_priority) +
+                         rti_encode_str_size(len)))
+    {
+        rti_encode_val(&packet, id);
+        rti_encode_val(&packet, thread->current_priority);
+        rti_encode_str(&packet, thread->name, len);
+        rti_packet_end(&packet);
+    }
+
+#ifdef RTI_USING_STACK
+    used = rti_stack_used(thread);
+#endif
+    if (rti_packet_begin(&packet, RTI_ID_STACK_INFO,
+                         rti_encode_val_size(id) +
+                         rti_encode_val_size((rt_uint32_t)(rt_ubase_t)thread->stack_addr) +
+                         rti_encode_val_size(thread->stack_size) +
+                         rti_encode_val_size(used)))
+    {
+        rti_encode_val(&packet, id);
+        rti_encode_val(&packet, (rt_uint32_t)(rt_ubase_t)thread->stack_addr);
+        rti_encode_val(&packet, thread->stack_size);
+        rti_encode_val(&packet, used);
+        rti_packet_end(&packet);
+    }
+    rt_exit_critical();
+}
+
+#if RTI_CFG(RTI_NAMED)
+static void rti_send_name(rt_object_t object)
+{
+    struct rti_packet packet;
+    rt_uint32_t id;
+    rt_uint8_t len;
+
+    id  = rti_shrink_id((rt_uint32_t)(rt_ubase_t)object);
+    len = rti_str_len(object->name, RT_NAME_MAX);
+    if (!rti_packet_begin(&packet, RTI_ID_NAME_RESOURCE,
+                          rti_encode_val_size(id) + rti_encode_str_size(len)))
+        return ;
+    rti_encode_val(&packet, id);
+    rti_encode_str(&packet, object->name, len);
+    rti_packet_end(&packet);
+
+    /* a name lost in an overflow is sent again with the next event */
+    rti_name_cache[rti_name_hash(object)] = object;
+}
+
+/* name the ipc objects and pools that exist when recording starts */
+static void rti_send_name_list(void)
+{
+    static const rt_uint8_t types[] =
+    {
+        RT_Object_Class_Semaphore,
+#ifdef RT_USING_MUTEX
+        RT_Object_Class_Mutex,
+#endif
+#ifdef RT_USING_EVENT
+        RT_Object_Class_Event,
+#endif
+#ifdef RT_USING_MAILBOX
+        RT_Object_Class_MailBox,
+#endif
+#ifdef RT_USING_MESSAGEQUEUE
+        RT_Object_Class_MessageQueue,
+#endif
+#if defined(RT_USING_MEMPOOL) && RTI_CFG(RTI_MEMPOOL)
+        RT_Object_Class_MemPool,
+#endif
+    };
+    struct rt_object_information *info;
+    struct rt_list_node *node;
+    rt_uint8_t i;
+
+    rt_enter_critical();
+    for (i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        info = rt_object_get_information((enum rt_object_class_type)types[i]);
+        if (info == RT_NULL)
+            continue;
+        for (node = info->object_list.next; node != &info->object_list; node = node->next)
+            rti_send_name(rt_list_entry(node, struct rt_object, list));
+    }
     rt_exit_critical();
 }
+#endif
 
 static void rti_send_thread_list(void)
 {
@@ -547,91 +1345,376 @@ static void rti_send_thread_list(void)
 }
 
 /* send a void package */
-static void rti_send_packet_void(rt_uint8_t rti_id)
+static void rti_send_packet_void(rt_uint16_t rti_id)
 {
-    rt_uint8_t packet[RTI_INFO_SIZE];
-    rt_uint8_t *start;
+    struct rti_packet packet;
 
-    start = rti_record_ready(packet);
-    rti_send_packet(rti_id, start, start);
+    if (!rti_packet_begin(&packet, rti_id, 0))
+        return ;
+    rti_packet_end(&packet);
 }
 
 /* send a value package */
-static void rti_send_packet_value(rt_uint8_t rti_id, rt_uint32_t value)
+static void rti_send_packet_value(rt_uint16_t rti_id, rt_uint32_t value)
 {
-    rt_uint8_t packet[RTI_INFO_SIZE + RTI_VALUE_SIZE];
-    rt_uint8_t *start, *present;
-
-    present = start = rti_record_ready(packet);
-    present = rti_encode_val(present, value);
+    struct rti_packet packet;
 
-    rti_send_packet(rti_id, start, present);
+    if (!rti_packet_begin(&packet, rti_id, rti_encode_val_size(value)))
+        return ;
+    rti_encode_val(&packet, value);
+    rti_packet_end(&packet);
 }
 
 void rti_print(const char *s)
 {
-    rt_uint8_t packet[RTI_INFO_SIZE + 2 * RTI_VALUE_SIZE + RTI_MAX_STRING_LEN];
-    rt_uint8_t *start, *present;
-
-    start = rti_record_ready(packet);
-    present = rti_encode_str(start, s, RTI_MAX_STRING_LEN);
-    present = rti_encode_val(present, RTI_LOG);
-    present = rti_encode_val(present, 0);
+    struct rti_packet packet;
+    rt_uint8_t len;
 
-    rti_send_packet(RTI_ID_PRINT_FORMATTED, start, present);
+    len = rti_str_len(s, RTI_MAX_STRING_LEN);
+    if (!rti_packet_begin(&packet, RTI_ID_PRINT_FORMATTED, rti_encode_str_size(len) + 2))
+        return ;
+    rti_encode_str(&packet, s, len);
+    rti_encode_val(&packet, RTI_LOG);
+    rti_encode_val(&packet, 0);
+    rti_packet_end(&packet);
 }
 
-static void rti_send_packet(rt_uint8_t rti_id, rt_uint8_t *packet_sta, rt_uint8_t *packet_end)
-{
-    rt_uint16_t  len;
-    rt_uint32_t  time_stamp, delta;
+/* zigzag, small negative numbers stay short */
+#define RTI_ZIGZAG(v)       (((rt_uint32_t)(v) << 1) ^ (rt_uint32_t)((rt_int32_t)(v) >> 31))
+#define RTI_ZIGZAG64(v)     (((rt_uint64_t)(v) << 1) ^ (rt_uint64_t)((long long)(v) >> 63))
 
-    if (rti_status.enable == RTI_DISABLE)
-        return ;
-    if (rti_id < 24)
+#define RTI_PRINTF_PUT(v, s)                \
+    do {                                    \
+        if (count == RTI_PRINTF_ARG_NUM)    \
+            return done;                    \
+        value[count] = (v);                 \
+        str[count++] = (s);                 \
+    } while (0)
+
+/*
+ * The fields of every conversion, as tools/rti_format.c reads them:
+ * integers of up to 32 bits are one varint, signed ones zigzag coded,
+ * long long is two (low, high), a double its two halves, a string is
+ * sent as it is and '*' takes a varint. long, size_t and pointers go as
+ * long long where they have 64 bits, the host knows from the elf class.
+ * The conversions that do not fit into RTI_PRINTF_ARG_NUM values are
+ * left out.
+ */
+
+/* the argument of the length modifier is sent in two halves */
+#define RTI_PRINTF_WIDE(longs)  ((longs) == 2 || ((longs) == 1 && sizeof(long) == 8) || \
+                                 ((longs) == 3 && sizeof(rt_base_t) == 8))
+static rt_uint8_t rti_printf_args(const char *fmt, va_list args, rt_uint32_t *value, const char **str)
+{
+    rt_uint8_t count = 0, done = 0, longs;
+    rt_int32_t number;
+    rt_uint64_t wide;
+    const char *s;
+    union
     {
-        *--packet_sta = rti_id;
-    }
-    else
+        double real;
+        rt_uint64_t bits;
+    } real;
+
+    while (*fmt != '\0')
     {
-        len = packet_end - packet_sta;
-        if (len > 127)
+        if (*fmt++ != '%')
+            continue;
+
+        /* flags, width and precision */
+        while (*fmt == '-' || *fmt == '+' || *fmt == ' ' || *fmt == '#' || *fmt == '.' ||
+                (*fmt >= '0' && *fmt <= '9') || *fmt == '*')
         {
-            *--packet_sta = (len >> 7);
-            *--packet_sta = len | 0x80;
+            if (*fmt++ == '*')
+            {
+                number = va_arg(args, int);
+                RTI_PRINTF_PUT(RTI_ZIGZAG(number), RT_NULL);
+            }
         }
-        else
+
+        /* 1 long, 2 long long, 3 size_t or ptrdiff_t */
+        longs = 0;
+        while (*fmt == 'h' || *fmt == 'l' || *fmt == 'L' || *fmt == 'q' || *fmt == 'j' ||
+                *fmt == 'z' || *fmt == 't')
         {
-            *--packet_sta = len;
+            if (*fmt == 'l')
+                longs++;
+            else if (*fmt == 'L' || *fmt == 'q' || *fmt == 'j')
+                longs = 2;
+            else if (*fmt == 'z' || *fmt == 't')
+                longs = 3;
+            fmt++;
         }
-        if (rti_id > 127)
+
+        switch (*fmt++)
         {
-            *--packet_sta = (rti_id >> 7);
-            *--packet_sta = rti_id | 0x80;
+        case 'd':
+        case 'i':
+            if (longs == 2)
+                wide = va_arg(args, long long);
+            else if (longs == 1)
+                wide = va_arg(args, long);
+            else if (longs == 3)
+                wide = va_arg(args, rt_base_t);
+            else
+                wide = va_arg(args, int);
+            if (RTI_PRINTF_WIDE(longs))
+            {
+                wide = RTI_ZIGZAG64(wide);
+                RTI_PRINTF_PUT((rt_uint32_t)wide, RT_NULL);
+                RTI_PRINTF_PUT((rt_uint32_t)(wide >> 32), RT_NULL);
+                break;
+            }
+            number = (rt_int32_t)wide;
+            RTI_PRINTF_PUT(RTI_ZIGZAG(number), RT_NULL);
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            if (longs == 2)
+                wide = va_arg(args, unsigned long long);
+            else if (longs == 1)
+                wide = va_arg(args, unsigned long);
+            else if (longs == 3)
+                wide = va_arg(args, rt_ubase_t);
+            else
+                wide = va_arg(args, unsigned int);
+            RTI_PRINTF_PUT((rt_uint32_t)wide, RT_NULL);
+            if (RTI_PRINTF_WIDE(longs))
+                RTI_PRINTF_PUT((rt_uint32_t)(wide >> 32), RT_NULL);
+            break;
+        case 'c':
+            RTI_PRINTF_PUT(va_arg(args, int), RT_NULL);
+            break;
+        case 'p':
+            wide = (rt_ubase_t)va_arg(args, void *);
+            RTI_PRINTF_PUT((rt_uint32_t)wide, RT_NULL);
+            if (sizeof(void *) == 8)
+                RTI_PRINTF_PUT((rt_uint32_t)(wide >> 32), RT_NULL);
+            break;
+        case 's':
+            s = va_arg(args, const char *);
+            if (s == RT_NULL)
+                s = "(null)";
+            RTI_PRINTF_PUT(rti_str_len(s, RTI_MAX_STRING_LEN), s);
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if (longs == 2)
+                real.real = (double)va_arg(args, long double);
+            else
+                real.real = va_arg(args, double);
+            RTI_PRINTF_PUT((rt_uint32_t)real.bits, RT_NULL);
+            RTI_PRINTF_PUT((rt_uint32_t)(real.bits >> 32), RT_NULL);
+            break;
+        case 'n':
+            (void)va_arg(args, void *);
+            break;
+        case '%':
+            break;
+        default:
+            /* not a conversion we know, or the end of the string */
+            return done;
         }
+        done = count;
+    }
+    return done;
+}
+
+void rti_vprintf(const char *fmt, va_list args)
+{
+    struct rti_packet packet;
+    rt_uint32_t value[RTI_PRINTF_ARG_NUM];
+    const char *str[RTI_PRINTF_ARG_NUM];
+    rt_uint16_t size;
+    rt_uint8_t count, i;
+
+    /* nothing is parsed while rti does not record */
+    if (rti_status.enable == RTI_DISABLE)
+        return ;
+
+    count = rti_printf_args(fmt, args, value, str);
+    size = rti_encode_val_size((rt_ubase_t)fmt);
+    for (i = 0; i < count; i++)
+        size += str[i] ? rti_encode_str_size(value[i]) : rti_encode_val_size(value[i]);
+
+    if (!rti_packet_begin(&packet, RTI_ID_PRINTF, size))
+        return ;
+    rti_encode_val(&packet, (rt_ubase_t)fmt);
+    for (i = 0; i < count; i++)
+    {
+        if (str[i])
+            rti_encode_str(&packet, str[i], value[i]);
         else
+            rti_encode_val(&packet, value[i]);
+    }
+    rti_packet_end(&packet);
+}
+
+void rti_printf(const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    rti_vprintf(fmt, args);
+    va_end(args);
+}
+
+/* record a packet of values, for the extensions with an id of 24 and up */
+void rti_record_values(rt_uint16_t rti_id, const rt_uint32_t *values, rt_uint16_t count)
+{
+    struct rti_packet packet;
+    rt_uint16_t i, size = 0;
+
+    for (i = 0; i < count; i++)
+        size += rti_encode_val_size(values[i]);
+    if (!rti_packet_begin(&packet, rti_id, size))
+        return ;
+    for (i = 0; i < count; i++)
+        rti_encode_val(&packet, values[i]);
+    rti_packet_end(&packet);
+}
+
+/* the events of the application, rti_id is a module event id */
+void rti_record_void(rt_uint16_t rti_id)
+{
+    rti_send_packet_void(rti_id);
+}
+
+void rti_record_u32(rt_uint16_t rti_id, rt_uint32_t v0)
+{
+    rti_send_packet_value(rti_id, v0);
+}
+
+void rti_record_u32x2(rt_uint16_t rti_id, rt_uint32_t v0, rt_uint32_t v1)
+{
+    rt_uint32_t values[2] = {v0, v1};
+
+    rti_record_values(rti_id, values, 2);
+}
+
+void rti_record_u32x3(rt_uint16_t rti_id, rt_uint32_t v0, rt_uint32_t v1, rt_uint32_t v2)
+{
+    rt_uint32_t values[3] = {v0, v1, v2};
+
+    rti_record_values(rti_id, values, 3);
+}
+
+void rti_record_u32x4(rt_uint16_t rti_id, rt_uint32_t v0, rt_uint32_t v1, rt_uint32_t v2, rt_uint32_t v3)
+{
+    rt_uint32_t values[4] = {v0, v1, v2, v3};
+
+    rti_record_values(rti_id, values, 4);
+}
+
+/* a code region, shown between the start and the stop of the same id */
+void rti_user_start(rt_uint32_t user_id)
+{
+    rti_send_packet_value(RTI_ID_USER_START, user_id);
+}
+
+void rti_user_stop(rt_uint32_t user_id)
+{
+    rti_send_packet_value(RTI_ID_USER_STOP, user_id);
+}
+
+/* the name the host shows for an id in the values of the events */
+void rti_name_resource(rt_uint32_t id, const char *name)
+{
+    struct rti_packet packet;
+    rt_uint8_t len;
+
+    len = rti_str_len(name, RTI_MAX_STRING_LEN);
+    if (!rti_packet_begin(&packet, RTI_ID_NAME_RESOURCE,
+                          rti_encode_val_size(id) + rti_encode_str_size(len)))
+        return ;
+    rti_encode_val(&packet, id);
+    rti_encode_str(&packet, name, len);
+    rti_packet_end(&packet);
+}
+
+/* a description of the module, called from send_desc for more of them */
+void rti_module_desc(const struct rti_module *module, const char *desc)
+{
+    struct rti_packet packet;
+    rt_uint8_t len;
+
+    len = rti_str_len(desc, RTI_MAX_STRING_LEN);
+    if (!rti_packet_begin(&packet, RTI_ID_MODULEDESC,
+                          rti_encode_val_size(module->id) +
+                          rti_encode_val_size(module->event_offset) +
+                          rti_encode_str_size(len)))
+        return ;
+    rti_encode_val(&packet, module->id);
+    rti_encode_val(&packet, module->event_offset);
+    rti_encode_str(&packet, desc, len);
+    rti_packet_end(&packet);
+}
+
+static void rti_send_module(const struct rti_module *module)
+{
+    rti_module_desc(module, module->desc);
+    if (module->send_desc != RT_NULL)
+        module->send_desc();
+}
+
+static void rti_send_module_list(void)
+{
+    struct rti_module *module;
+
+    if (rti_module_list == RT_NULL)
+        return ;
+    for (module = rti_module_list; module != RT_NULL; module = module->next)
+        rti_send_module(module);
+    rti_send_packet_value(RTI_ID_NUMMODULES, rti_module_num);
+}
+
+/* give the module event_num ids after the ones of the modules before it */
+rt_err_t rti_module_register(struct rti_module *module)
+{
+    register rt_ubase_t temp;
+    struct rti_module *node;
+    rt_uint32_t offset = RTI_ID_MODULE_BASE;
+
+    RT_ASSERT(module != RT_NULL);
+    RT_ASSERT(module->desc != RT_NULL);
+
+    temp = rt_hw_interrupt_disable();
+    for (node = rti_module_list; node != RT_NULL; node = node->next)
+    {
+        if (node == module)
         {
-            *--packet_sta = rti_id;
+            rt_hw_interrupt_enable(temp);
+            return -RT_EBUSY;
         }
     }
-    time_stamp  = RTI_GET_TIMESTAMP();
-    delta = time_stamp - rti_status.time_stamp_last;
-    packet_end = rti_encode_val(packet_end, delta);
-    if (rti_status.enable == RTI_OVERFLOW)
+    if (rti_module_list != RT_NULL)
+        offset = rti_module_list->event_offset + rti_module_list->event_num;
+    if (offset + module->event_num > RTI_ID_MODULE_MAX + 1 || rti_module_num == 0xFF)
     {
-        rti_overflow();
-        if (rti_status.enable != RTI_ENABLE)
-            return ;
+        rt_hw_interrupt_enable(temp);
+        return -RT_EFULL;
     }
-    /* overflow */
-    if (rti_data_put(packet_sta, packet_end - packet_sta) == 0)
+    module->event_offset = (rt_uint16_t)offset;
+    module->id = rti_module_num++;
+    module->next = rti_module_list;
+    rti_module_list = module;
+    rt_hw_interrupt_enable(temp);
+
+    /* a recording in progress learns about the module right away */
+    if (rti_status.enable != RTI_DISABLE)
     {
-        rti_status.enable = RTI_OVERFLOW;
-        rti_status.packet_count ++;
-        rti_overflow();
+        rti_send_module(module);
+        rti_send_packet_value(RTI_ID_NUMMODULES, rti_module_num);
     }
-
-    rti_status.time_stamp_last = time_stamp;
+    return RT_EOK;
 }
 
 /*
@@ -641,6 +1724,30 @@ void rti_data_new_data_notify_set_hook(void (*hook)(void))
 {
     rti_data_new_data_notify = hook;
 }
+
+/* the transport woken for new data, to put it back after borrowing the stream */
+void (*rti_data_new_data_notify_get_hook(void))(void)
+{
+    return rti_data_new_data_notify;
+}
+
+/* call with interrupts disabled */
+static void rti_mask_update(void)
+{
+    rt_uint32_t mask = 0;
+    rt_uint8_t i;
+
+    if (rti_status.enable != RTI_DISABLE)
+    {
+        for (i = 0; i < RTI_TRACE_NUM; i++)
+        {
+            if (!rti_status.disable_nest[i])
+                mask |= 1 << i;
+        }
+    }
+    rti_status.mask = mask & RTI_CFG_CLASSES;
+}
+
 void rti_trace_disable(rt_uint16_t flag)
 {
     register rt_ubase_t temp;
@@ -653,6 +1760,7 @@ void rti_trace_disable(rt_uint16_t flag)
             rti_status.disable_nest[i] ++;
         }
     }
+    rti_mask_update();
     rt_hw_interrupt_enable(temp);
 }
 
@@ -668,86 +1776,435 @@ void rti_trace_enable(rt_uint16_t flag)
             rti_status.disable_nest[i] --;
         }
     }
+    rti_mask_update();
     rt_hw_interrupt_enable(temp);
 }
 
-static rt_size_t rti_data_put(const rt_uint8_t *ptr, rt_uint16_t length)
+void rti_channel_policy_set(rt_uint8_t channel, rt_uint8_t policy)
 {
     register rt_ubase_t temp;
-    rt_size_t size = 0;
-    if (!rti_status.enable)
-        return 0;
 
+    if (channel >= RTI_CHANNEL_NUM)
+        return ;
     temp = rt_hw_interrupt_disable();
-    if (rt_ringbuffer_space_len(tx_ringbuffer) > length)
-        size = rt_ringbuffer_put(tx_ringbuffer, ptr, length);
-    if (rt_ringbuffer_data_len(tx_ringbuffer) > RTI_BUFFER_SIZE / 2)
+    rti_channel[channel].policy = policy;
+    rti_channel[channel].ring.skip = (policy == RTI_POLICY_OVERWRITE) ? rti_packet_size : RT_NULL;
+    rt_hw_interrupt_enable(temp);
+}
+
+void rti_policy_set(rt_uint8_t policy)
+{
+    rt_uint8_t i;
+
+    for (i = 0; i < RTI_CHANNEL_NUM; i++)
+        rti_channel_policy_set(i, policy);
+}
+
+/* stop recording at once, safe in fault handlers */
+void rti_freeze(void)
+{
+    register rt_ubase_t temp;
+
+    temp = rt_hw_interrupt_disable();
+    rti_status.enable = RTI_DISABLE;
+    rti_mask_update();
+    rt_hw_interrupt_enable(temp);
+}
+
+#if RTI_CHANNEL_NUM > 1
+/* the packet that switches the stream to another channel */
+static void rti_channel_mark(rt_uint8_t mark[4], rt_uint8_t channel)
+{
+    mark[0] = RTI_ID_CHANNEL;
+    mark[1] = 1;
+    mark[2] = channel;
+    mark[3] = 0;
+}
+#endif
+
+/* a consumer would race the producers dropping old packets */
+static rt_bool_t rti_channel_readable(struct rti_channel *channel)
+{
+    return channel->policy == RTI_POLICY_STREAM || rti_status.enable == RTI_DISABLE;
+}
+
+/* output the committed data of a ring without consuming it */
+static rt_uint32_t rti_dump_ring(struct rti_ring *ring, void (*output)(const rt_uint8_t *ptr, rt_size_t length))
+{
+    struct rti_span span[2];
+    rt_uint8_t i, count;
+
+    count = rti_ring_peek(ring, span);
+    for (i = 0; i < count; i++)
+        output(span[i].ptr, span[i].length);
+    return span[0].length + span[1].length;
+}
+
+/* encode the sync and the system information straight to the output */
+static void rti_send_preamble(void (*output)(const rt_uint8_t *ptr, rt_size_t length))
+{
+    rti_ring_reset(&dump_channel.ring);
+    dump_channel.time_stamp_last = rti_channel[RTI_CHANNEL_EVENT].time_stamp_last;
+    rti_status.dump_thread = rt_thread_self();
+    rti_status.dump_nest = rt_interrupt_get_nest();
+    RTI_BARRIER();
+    rti_status.dump = output;
+    rti_send_sys_info();
+    rti_status.dump = RT_NULL;
+}
+
+void rti_dump(void (*output)(const rt_uint8_t *ptr, rt_size_t length))
+{
+#if RTI_CHANNEL_NUM > 1
+    struct rti_channel *channel;
+    rt_uint8_t mark[4];
+    rt_uint8_t i;
+#endif
+
+    if (rti_channel[RTI_CHANNEL_EVENT].ring.buffer == RT_NULL)
+        return ;
+    rti_freeze();
+
+    /* the packets before the window are gone, tell the host again what it
+     * needs to know. Hooks stay off, the mask is still clear, and rti stays
+     * stopped for everyone else, the window is left as it is. */
+    rti_send_preamble(output);
+
+    /* the frozen window, it starts on a packet boundary */
+    rti_dump_ring(&rti_channel[RTI_CHANNEL_EVENT].ring, output);
+
+#if RTI_CHANNEL_NUM > 1
+    /* the other flight recorders, a streamed channel is left to the consumer */
+    for (i = 1; i < RTI_CHANNEL_NUM; i++)
     {
-        if (rti_thread != RT_NULL)
+        channel = &rti_channel[i];
+        if (channel->policy != RTI_POLICY_OVERWRITE || rti_ring_data_len(&channel->ring) == 0)
+            continue;
+        rti_channel_mark(mark, i);
+        output(mark, sizeof(mark));
+        rti_dump_ring(&channel->ring, output);
+    }
+#endif
+}
+
+/* for a consumer that starts a new file while rti records, call it from a
+ * thread after a rti_data_commit that left rti_data_boundary true */
+void rti_preamble(void (*output)(const rt_uint8_t *ptr, rt_size_t length))
+{
+#if RTI_CHANNEL_NUM > 1
+    rt_uint8_t mark[4];
+#endif
+
+    if (rti_status.enable == RTI_DISABLE)
+        return ;
+    rti_send_preamble(output);
+
+#if RTI_CHANNEL_NUM > 1
+    /* a new stream starts in the event channel */
+    if (rti_reader.current != RTI_CHANNEL_EVENT && rti_reader.mark_len == 0)
+    {
+        rti_channel_mark(mark, rti_reader.current);
+        output(mark, sizeof(mark));
+    }
+#endif
+}
+
+static rt_size_t rti_data_put(const rt_uint8_t *ptr, rt_uint16_t length)
+{
+    struct rti_channel *channel = rti_channel_of(RTI_ID_NOP);
+    struct rti_ring *ring = &channel->ring;
+    rt_uint32_t index;
+    rt_base_t   level;
+    rt_err_t    result;
+
+    if (!rti_status.enable && !rti_dump_context())
+        return 0;
+
+    level = rti_ring_enter(ring);
+    do
+    {
+        index  = ring->reserve;
+        result = rti_ring_reserve(ring, index, length);
+    }
+    while (result == -RT_EBUSY);
+    if (result == RT_EOK)
+        rti_ring_write(ring, index, ptr, length);
+    rti_ring_leave(ring, level);
+
+    if (result != RT_EOK)
+        return 0;
+
+    rti_data_wakeup(channel);
+    return length;
+}
+
+/* resume the rti thread once a buffer is half full */
+static void rti_data_wakeup(struct rti_channel *channel)
+{
+    /* dumping, hand each preamble packet to the output at once */
+    if (channel == &dump_channel)
+    {
+        dump_channel.ring.read += rti_dump_ring(&dump_channel.ring, rti_status.dump);
+        return ;
+    }
+
+#ifdef RTI_USING_TRIGGER
+    /* the post-trigger window is complete, the rti thread dumps it */
+    if (!rti_trigger_post(rti_channel[RTI_CHANNEL_EVENT].ring.reserve))
+#endif
+    {
+        /* the flight recorder is only read by rti_dump */
+        if (channel->policy == RTI_POLICY_OVERWRITE)
+            return ;
+        if (rti_ring_data_len(&channel->ring) <= rti_ring_size(&channel->ring) / 2)
+            return ;
+    }
+    /* only one producer may resume the thread */
+    if (RTI_ATOMIC_CAS(&rti_status.thread_waiting, 1, 0))
+    {
+#ifdef RTI_USING_TELEMETRY
+        rti_telemetry_wakeup();
+#endif
+        rti_trace_disable(RTI_ALL);
+        rt_thread_resume(rti_thread);
+        rti_trace_enable(RTI_ALL);
+    }
+}
+
+/* the data to send in place, hand the spans to dma, a file or a socket and
+ * rti_data_commit what was sent. Returns the number of spans. */
+rt_uint8_t rti_data_peek(struct rti_span span[2])
+{
+    struct rti_channel *channel;
+    rt_uint8_t count = 0;
+#if RTI_CHANNEL_NUM > 1
+    struct rti_span data[2];
+    rt_uint8_t i;
+#endif
+
+    span[0].length = 0;
+    span[1].length = 0;
+    if (rti_channel[RTI_CHANNEL_EVENT].ring.buffer == RT_NULL)
+        return 0;
+
+#if RTI_CHANNEL_NUM > 1
+    /* all that was peeked is consumed, switch to the first channel with data */
+    channel = &rti_channel[rti_reader.current];
+    if (rti_reader.mark_len == 0 &&
+            (!rti_channel_readable(channel) || channel->ring.read == rti_reader.boundary))
+    {
+        for (i = 0; i < RTI_CHANNEL_NUM; i++)
         {
-            rti_trace_disable(RTI_ALL);
-            rt_thread_resume(rti_thread);
-            rti_trace_enable(RTI_ALL);
-            rti_thread = RT_NULL;
+            if (rti_channel_readable(&rti_channel[i]) && rti_ring_data_len(&rti_channel[i].ring))
+                break;
+        }
+        if (i < RTI_CHANNEL_NUM && i != rti_reader.current)
+        {
+            rti_reader.current = i;
+            rti_channel_mark(rti_reader.mark, i);
+            rti_reader.mark_len = sizeof(rti_reader.mark);
         }
     }
-    rt_hw_interrupt_enable(temp);
-    return size;
+
+    channel = &rti_channel[rti_reader.current];
+    if (rti_reader.mark_len)
+    {
+        span[0].ptr    = &rti_reader.mark[sizeof(rti_reader.mark) - rti_reader.mark_len];
+        span[0].length = rti_reader.mark_len;
+        count = 1;
+    }
+    /* a channel packet alone ends on a boundary too */
+    rti_reader.boundary = channel->ring.read;
+    if (!rti_channel_readable(channel))
+        return count;
+    if (count)
+    {
+        if (rti_ring_peek(&channel->ring, data) == 0)
+            return count;
+        /* the wrap may cut a packet, the boundary is past the second part
+         * that the next peek returns */
+        span[1] = data[0];
+        rti_reader.boundary = channel->ring.read + data[0].length + data[1].length;
+        return 2;
+    }
+    count = rti_ring_peek(&channel->ring, span);
+    rti_reader.boundary = channel->ring.read + span[0].length + span[1].length;
+    return count;
+#else
+    channel = &rti_channel[RTI_CHANNEL_EVENT];
+    rti_reader.boundary = channel->ring.read;
+    if (rti_channel_readable(channel))
+        count = rti_ring_peek(&channel->ring, span);
+    rti_reader.boundary += span[0].length + span[1].length;
+    return count;
+#endif
+}
+
+/* whether what was committed so far ends on a packet boundary, a sink
+ * may start a new file there */
+rt_bool_t rti_data_boundary(void)
+{
+#if RTI_CHANNEL_NUM > 1
+    if (rti_reader.mark_len)
+        return RT_FALSE;
+    return rti_channel[rti_reader.current].ring.read == rti_reader.boundary;
+#else
+    return rti_channel[RTI_CHANNEL_EVENT].ring.read == rti_reader.boundary;
+#endif
 }
 
-rt_size_t rti_data_get(rt_uint8_t *ptr, rt_uint16_t length)
+void rti_data_commit(rt_size_t length)
 {
-    if (tx_ringbuffer == RT_NULL)
+#ifdef RTI_USING_TELEMETRY
+    rt_size_t total = length;
+#endif
+    struct rti_channel *channel;
+
+    if (rti_channel[RTI_CHANNEL_EVENT].ring.buffer == RT_NULL)
+        return ;
+#if RTI_CHANNEL_NUM > 1
+    if (rti_reader.mark_len)
+    {
+        rt_size_t size = (length < rti_reader.mark_len) ? length : rti_reader.mark_len;
+
+        rti_reader.mark_len -= size;
+        length -= size;
+    }
+    channel = &rti_channel[rti_reader.current];
+#else
+    channel = &rti_channel[RTI_CHANNEL_EVENT];
+#endif
+    rti_ring_commit(&channel->ring, length);
+#ifdef RTI_USING_TELEMETRY
+    rti_telemetry_drain(total);
+#endif
+}
+
+rt_size_t rti_data_get(rt_uint8_t *ptr, rt_size_t length)
+{
+    struct rti_span span[2];
+    rt_size_t size, count = 0;
+    rt_uint8_t i, spans;
+
+    spans = rti_data_peek(span);
+    for (i = 0; i < spans && count < length; i++)
+    {
+        size = span[i].length;
+        if (size > length - count)
+            size = length - count;
+        rt_memcpy(ptr + count, span[i].ptr, size);
+        count += size;
+    }
+    rti_data_commit(count);
+    return count;
+}
+
+rt_size_t rti_channel_used(rt_uint8_t channel)
+{
+    if (channel >= RTI_CHANNEL_NUM)
         return 0;
-    return rt_ringbuffer_get(tx_ringbuffer, ptr, length);;
+    return rti_ring_data_len(&rti_channel[channel].ring);
 }
 
 rt_size_t rti_buffer_used(void)
 {
-    return rt_ringbuffer_data_len(tx_ringbuffer);
+    rt_size_t used = 0;
+    rt_uint8_t i;
+
+    for (i = 0; i < RTI_CHANNEL_NUM; i++)
+        used += rti_ring_data_len(&rti_channel[i].ring);
+    return used;
+}
+
+/* the data the consumer can read now */
+static rt_size_t rti_data_ready(void)
+{
+    rt_size_t ready = 0;
+    rt_uint8_t i;
+
+    for (i = 0; i < RTI_CHANNEL_NUM; i++)
+    {
+        if (rti_channel_readable(&rti_channel[i]))
+            ready += rti_ring_data_len(&rti_channel[i].ring);
+    }
+    return ready;
 }
 
 void rti_start(void)
 {
+    register rt_ubase_t temp;
+    rt_uint8_t i;
+
     rt_kprintf("rti start\n");
-    rt_ringbuffer_reset(tx_ringbuffer);
+    for (i = 0; i < RTI_CHANNEL_NUM; i++)
+    {
+        rti_ring_reset(&rti_channel[i].ring);
+        rti_channel[i].packet_count = 0;
+        rti_channel[i].state = RTI_ENABLE;
+        /* the first delta is the time stamp itself, so the host sees the
+         * time of the target in every channel and every recording */
+        rti_channel[i].time_stamp_last = 0;
+    }
+    rt_memset(&rti_reader, 0, sizeof(rti_reader));
+#if RTI_CFG(RTI_NAMED)
+    rt_memset(rti_name_cache, 0, sizeof(rti_name_cache));
+#endif
+
+    temp = rt_hw_interrupt_disable();
     rti_status.enable = RTI_ENABLE;
+    rti_mask_update();
+    rt_hw_interrupt_enable(temp);
+
     rti_send_sys_info();
 }
 
 void rti_stop(void)
 {
+    register rt_ubase_t temp;
+
     rti_send_packet_void(RTI_ID_STOP);
     rt_thread_delay(50);
     RT_OBJECT_HOOK_CALL(rti_data_new_data_notify, ());
     rt_thread_delay(50);
     RT_OBJECT_HOOK_CALL(rti_data_new_data_notify, ());
 
+    temp = rt_hw_interrupt_disable();
     rti_status.enable = RTI_DISABLE;
+    rti_mask_update();
+    rt_hw_interrupt_enable(temp);
+
     rt_kprintf("rti stop\n");
-    if (rti_thread != RT_NULL)
-    {
+    if (RTI_ATOMIC_CAS(&rti_status.thread_waiting, 1, 0))
         rt_thread_resume(rti_thread);
-        rti_thread = RT_NULL;
-    }
 }
 
 static void rti_thread_entry(void *parameter)
 {
     register rt_ubase_t temp;
-    rt_thread_t thread;
 
     while (1)
     {
-        thread = rt_thread_self();
-        while (rti_status.enable && (rti_buffer_used() > RTI_DATE_PACKAGE_SIZE))
+        /* without a consumer hook the data is polled with rti_data_get */
+        while (rti_status.enable && rti_data_new_data_notify != RT_NULL &&
+                (rti_data_ready() > RTI_DATE_PACKAGE_SIZE))
         {
             RT_OBJECT_HOOK_CALL(rti_data_new_data_notify, ());
         }
+#ifdef RTI_USING_TRIGGER
+        rti_trigger_flush();
+#endif
         temp = rt_hw_interrupt_disable();
 
-        rti_thread = thread;
-        rt_thread_suspend(thread);
+#ifdef RTI_USING_TRIGGER
+        /* the capture completed after the flush, its wakeup found us running */
+        if (rti_trigger_pending())
+        {
+            rt_hw_interrupt_enable(temp);
+            continue;
+        }
+#endif
+        rt_thread_suspend(rti_thread);
+        rti_status.thread_waiting = 1;
 
         rt_hw_interrupt_enable(temp);
 
@@ -755,44 +2212,123 @@ static void rti_thread_entry(void *parameter)
     }
 }
 
+#if defined(RTI_TIMESTAMP_TSC)
+rt_uint32_t rti_timestamp_freq;
+
+/* the tsc rate is not known on the host, count it over 10ms */
+static void rti_timestamp_init(void)
+{
+    struct timespec start, now;
+    rt_uint64_t ns;
+    rt_uint32_t cycles;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    cycles = RTI_GET_TIMESTAMP();
+    do
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        ns = (rt_uint64_t)(now.tv_sec - start.tv_sec) * 1000000000ULL + now.tv_nsec - start.tv_nsec;
+    }
+    while (ns < 10000000);
+    rti_timestamp_freq = (rt_uint32_t)((RTI_GET_TIMESTAMP() - cycles) * 1000000000ULL / ns);
+}
+#elif defined(RTI_TIMESTAMP_CLOCK)
+rt_uint32_t rti_timestamp_clock(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (rt_uint32_t)((rt_uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+static void rti_timestamp_init(void)
+{
+}
+#else
+static void rti_timestamp_init(void)
+{
+#if defined(RTI_TIMESTAMP_DWT)
+    /* DEMCR.TRCENA and DWT_CTRL.CYCCNTENA, a debugger may have set them already */
+    *(volatile rt_uint32_t *)0xE000EDFC |= 1UL << 24;
+    *(volatile rt_uint32_t *)0xE0001000 |= 1UL;
+#endif
+}
+#endif
+
 static int rti_init(void)
 {
-    rt_thread_t rti_thread = RT_NULL;
+#if RTI_CHANNEL_NUM > 1
+    rt_tick_t period;
+#endif
 
     tidle = rt_thread_idle_gethandler();
+    rti_timestamp_init();
+#ifdef RTI_USING_TELEMETRY
+    rti_telemetry_init();
+#endif
 
-    tx_ringbuffer = rt_ringbuffer_create(RTI_BUFFER_SIZE);
-    if (tx_ringbuffer == RT_NULL)
-        return -1;
+    rti_ring_init(&rti_channel[RTI_CHANNEL_EVENT].ring, rti_event_pool, RTI_BUFFER_SIZE);
+#if RTI_CHANNEL_NUM > 1
+    rti_ring_init(&rti_channel[RTI_CHANNEL_LOG].ring, rti_log_pool, RTI_LOG_BUFFER_SIZE);
+#endif
+    rti_ring_init(&dump_channel.ring, dump_pool, RTI_DUMP_BUFFER_SIZE);
 
-    rti_thread = rt_thread_create("rti",
-                                  rti_thread_entry,
-                                  RT_NULL,
-                                  1024, 20, 5);
-    if (rti_thread != RT_NULL)
-        rt_thread_startup(rti_thread);
-    else
-    {
-        rt_ringbuffer_destroy(tx_ringbuffer);
+    if (rt_thread_init(&rti_thread_obj, "rti",
+                       rti_thread_entry,
+                       RT_NULL,
+                       rti_thread_stack, sizeof(rti_thread_stack),
+                       RTI_THREAD_PRIORITY, 5) != RT_EOK)
         return -1;
-    }
-    /* register hooks */
+    rti_thread = &rti_thread_obj;
+    rt_thread_startup(rti_thread);
+#if RTI_CHANNEL_NUM > 1
+    /* a quarter of the wrap, a quiet channel is seen before half of it */
+    period = (rt_tick_t)((rt_uint64_t)(RTI_KEEPALIVE_AGE / 2) * RT_TICK_PER_SECOND / RTI_SYS_FREQ);
+    rt_timer_init(&rti_keepalive_timer, "rti_keep", rti_keepalive, RT_NULL,
+                  period ? period : 1, RT_TIMER_FLAG_PERIODIC);
+    rt_timer_start(&rti_keepalive_timer);
+#endif
+    /* register hooks, only for the event classes compiled in */
     //rt_object_attach_sethook(rti_object_attach);
+#if RTI_CFG(RTI_THREAD | RTI_NAMED)
     rt_object_detach_sethook(rti_object_detach);
+#endif
+#if RTI_CFG(RTI_HEAP) && defined(RT_USING_HEAP)
+    rt_malloc_sethook(rti_malloc);
+    rt_free_sethook(rti_free);
+#endif
+#if RTI_CFG(RTI_MEMPOOL) && defined(RT_USING_MEMPOOL)
+    rt_mp_alloc_sethook(rti_mp_alloc);
+    rt_mp_free_sethook(rti_mp_free);
+#endif
+#if RTI_CFG(RTI_IPC)
     rt_object_trytake_sethook(rti_object_trytake);
     rt_object_take_sethook(rti_object_take);
     rt_object_put_sethook(rti_object_put);
+#endif
 
+#if RTI_CFG(RTI_THREAD)
     rt_thread_suspend_sethook(rti_thread_suspend);
     rt_thread_resume_sethook(rti_thread_resume);
     rt_thread_inited_sethook(rti_thread_inited);
+#endif
+#if RTI_CFG(RTI_SCHEDULER)
     rt_scheduler_sethook(rti_scheduler);
+#endif
 
+#if RTI_CFG(RTI_TIMER)
     rt_timer_enter_sethook(rti_timer_enter);
     rt_timer_exit_sethook(rti_timer_exit);
+#endif
 
+#if RTI_CFG(RTI_INTERRUPT)
     rt_interrupt_enter_sethook(rti_interrupt_enter);
     rt_interrupt_leave_sethook(rti_interrupt_leave);
+#endif
+
+#ifdef RTI_USING_STACK
+    rti_stack_init();
+#endif
 
     return 0;
 }
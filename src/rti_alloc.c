@@ -0,0 +1,279 @@
+/*
+ * File      : rti_alloc.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+#include "rti_alloc.h"
+
+#ifdef RTI_USING_ALLOC
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#endif
+
+/* the entry after the table takes what does not fit */
+#define ALLOC_OTHER         "other"
+
+/* rt_memory_info takes rt_size_t since 4.1, rt_uint32_t before */
+#if defined(RTTHREAD_VERSION) && RTTHREAD_VERSION >= 40100
+typedef rt_size_t   rti_alloc_size_t;
+#else
+typedef rt_uint32_t rti_alloc_size_t;
+#endif
+
+struct rti_alloc_count
+{
+    rt_uint32_t allocs;
+    rt_uint32_t frees;
+    rt_uint64_t bytes;
+};
+
+struct rti_alloc_thread
+{
+    struct rti_thread_entry head;
+
+    /* since the reset and in the current period */
+    struct rti_alloc_count total;
+    struct rti_alloc_count period;
+};
+
+static struct
+{
+    volatile rt_uint8_t enable;
+
+    /* most heap bytes in use since the reset, sampled every period */
+    rt_uint32_t peak;
+
+    /* tick of the reset, for the rates */
+    rt_tick_t   reset;
+
+    struct rti_alloc_thread thread[RTI_ALLOC_THREAD_NUM + 1];
+
+    struct rt_timer period;
+
+    /* the summary packet, built in the period timer */
+    rt_uint32_t values[2 + 4 * (RTI_ALLOC_THREAD_NUM + 1)];
+} alloc;
+
+/* call with interrupts disabled, an interrupt counts for the thread it interrupted */
+static struct rti_alloc_thread *rti_alloc_thread_get(rt_thread_t thread)
+{
+    return rti_thread_entry_get(alloc.thread, sizeof(alloc.thread[0]), RTI_ALLOC_THREAD_NUM, thread);
+}
+
+/* takes the heap lock, not from the hooks or with interrupts off */
+static rt_uint32_t rti_alloc_heap_used(void)
+{
+#ifdef RT_USING_HEAP
+    rti_alloc_size_t total, used, max_used;
+
+    rt_memory_info(&total, &used, &max_used);
+    return (rt_uint32_t)used;
+#else
+    return 0;
+#endif
+}
+
+void rti_alloc_malloc(rt_size_t size)
+{
+    register rt_ubase_t temp;
+    struct rti_alloc_thread *entry;
+
+    if (!alloc.enable)
+        return ;
+
+    temp = rt_hw_interrupt_disable();
+    entry = rti_alloc_thread_get(rt_thread_self());
+    entry->total.allocs++;
+    entry->total.bytes += size;
+    entry->period.allocs++;
+    entry->period.bytes += size;
+    rt_hw_interrupt_enable(temp);
+}
+
+void rti_alloc_free(void)
+{
+    register rt_ubase_t temp;
+    struct rti_alloc_thread *entry;
+
+    if (!alloc.enable)
+        return ;
+
+    temp = rt_hw_interrupt_disable();
+    entry = rti_alloc_thread_get(rt_thread_self());
+    entry->total.frees++;
+    entry->period.frees++;
+    rt_hw_interrupt_enable(temp);
+}
+
+static rt_uint32_t rti_alloc_clamp(rt_uint64_t value)
+{
+    return value > 0xFFFFFFFFu ? 0xFFFFFFFFu : (rt_uint32_t)value;
+}
+
+/* the summary packet of the period */
+static void rti_alloc_period(void *parameter)
+{
+    register rt_ubase_t temp;
+    struct rti_alloc_thread *entry;
+    rt_uint16_t count = 2;
+    rt_uint32_t used;
+    rt_uint8_t i;
+
+    used = rti_alloc_heap_used();
+
+    temp = rt_hw_interrupt_disable();
+    if (used > alloc.peak)
+        alloc.peak = used;
+    alloc.values[0] = used;
+    alloc.values[1] = alloc.peak;
+    for (i = 0; i <= RTI_ALLOC_THREAD_NUM; i++)
+    {
+        entry = &alloc.thread[i];
+        if (entry->period.allocs == 0 && entry->period.frees == 0)
+            continue;
+        alloc.values[count++] = (i < RTI_ALLOC_THREAD_NUM) ? RTI_SHRINK_ID(entry->head.thread) : 0;
+        alloc.values[count++] = entry->period.allocs;
+        alloc.values[count++] = rti_alloc_clamp(entry->period.bytes);
+        alloc.values[count++] = entry->period.frees;
+        rt_memset(&entry->period, 0, sizeof(entry->period));
+    }
+    rt_hw_interrupt_enable(temp);
+
+    /* dropped while rti does not record */
+    rti_record_values(RTI_ID_ALLOC, alloc.values, count);
+}
+
+static void rti_alloc_count_add(struct rti_alloc_count *to, const struct rti_alloc_count *from)
+{
+    to->allocs += from->allocs;
+    to->frees += from->frees;
+    to->bytes += from->bytes;
+}
+
+/* the entry of a closed thread is free again, its counts stay in other */
+void rti_alloc_remove(rt_thread_t thread)
+{
+    register rt_ubase_t temp;
+    struct rti_alloc_thread *entry, *other = &alloc.thread[RTI_ALLOC_THREAD_NUM];
+
+    temp = rt_hw_interrupt_disable();
+    entry = rti_thread_entry_find(alloc.thread, sizeof(alloc.thread[0]), RTI_ALLOC_THREAD_NUM, thread);
+    if (entry != RT_NULL)
+    {
+        rti_alloc_count_add(&other->total, &entry->total);
+        rti_alloc_count_add(&other->period, &entry->period);
+        rt_memset(entry, 0, sizeof(*entry));
+    }
+    rt_hw_interrupt_enable(temp);
+}
+
+void rti_alloc_reset(void)
+{
+    register rt_ubase_t temp;
+    rt_uint32_t used;
+
+    used = rti_alloc_heap_used();
+
+    temp = rt_hw_interrupt_disable();
+    rt_memset(alloc.thread, 0, sizeof(alloc.thread));
+    rt_strncpy(alloc.thread[RTI_ALLOC_THREAD_NUM].head.name, ALLOC_OTHER, RT_NAME_MAX);
+    alloc.peak = used;
+    alloc.reset = rt_tick_get();
+    rt_hw_interrupt_enable(temp);
+}
+
+void rti_alloc_start(void)
+{
+    static rt_bool_t inited = RT_FALSE;
+    rt_tick_t period = RTI_ALLOC_PERIOD;
+
+    if (alloc.enable)
+        return ;
+    if (!inited)
+    {
+        rt_timer_init(&alloc.period, "rti_allc", rti_alloc_period, RT_NULL, period,
+                      RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_SOFT_TIMER);
+        inited = RT_TRUE;
+    }
+    rti_alloc_reset();
+    alloc.enable = 1;
+    rt_timer_start(&alloc.period);
+}
+
+void rti_alloc_stop(void)
+{
+    if (!alloc.enable)
+        return ;
+    alloc.enable = 0;
+    rt_timer_stop(&alloc.period);
+}
+
+void rti_alloc_show(void)
+{
+    struct rti_alloc_thread *entry;
+    struct rti_alloc_count *count;
+    rt_uint32_t ms, used;
+    rt_uint8_t i;
+
+    ms = (rt_uint32_t)((rt_uint64_t)(rt_tick_get() - alloc.reset) * 1000 / RT_TICK_PER_SECOND);
+    if (ms == 0)
+        ms = 1;
+    /* the peak is sampled by the period timer, it may not have run yet */
+    used = rti_alloc_heap_used();
+    rt_kprintf("%d ms", ms);
+#ifdef RT_USING_HEAP
+    rt_kprintf(", heap %d bytes used, peak %d bytes", used, used > alloc.peak ? used : alloc.peak);
+#endif
+    rt_kprintf("\n");
+
+    rt_kprintf("thread     allocs/s    bytes/s   frees/s     allocs        bytes      frees\n");
+    for (i = 0; i <= RTI_ALLOC_THREAD_NUM; i++)
+    {
+        entry = &alloc.thread[i];
+        count = &entry->total;
+        if (count->allocs == 0 && count->frees == 0)
+            continue;
+        rt_kprintf("%-8.*s %10d %10d %9d %10d %12d %10d\n", RT_NAME_MAX, entry->head.name,
+                   (rt_uint32_t)((rt_uint64_t)count->allocs * 1000 / ms),
+                   rti_alloc_clamp(count->bytes * 1000 / ms),
+                   (rt_uint32_t)((rt_uint64_t)count->frees * 1000 / ms),
+                   count->allocs, rti_alloc_clamp(count->bytes), count->frees);
+    }
+}
+
+#ifdef RT_USING_FINSH
+static void rti_alloc(int argc, char **argv)
+{
+    if (argc > 1 && !rt_strcmp(argv[1], "start"))
+        rti_alloc_start();
+    else if (argc > 1 && !rt_strcmp(argv[1], "stop"))
+        rti_alloc_stop();
+    else if (argc > 1 && !rt_strcmp(argv[1], "reset"))
+        rti_alloc_reset();
+    else
+        rti_alloc_show();
+}
+MSH_CMD_EXPORT(rti_alloc, rti allocation statistics: rti_alloc [start|stop|reset]);
+#endif
+
+#endif
@@ -0,0 +1,179 @@
+/*
+ * File      : stats.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+#include "rti_compress.h"
+
+#ifdef RTI_USING_COMPRESS
+
+#if RTI_COMPRESS_BLOCK_SIZE > 0xFFFF
+#error "RTI_COMPRESS_BLOCK_SIZE must fit the 2 byte lengths of a frame"
+#endif
+
+/* limits of the lz4 block format */
+#define COMPRESS_MIN_MATCH          4
+#define COMPRESS_LAST_LITERALS      5
+#define COMPRESS_MATCH_LIMIT        12
+
+/* position + 1 of the last 4 bytes with the hash, 0 while unused */
+static rt_uint16_t compress_hash[1 << RTI_COMPRESS_HASH_BITS];
+static rt_uint8_t compress_block[RTI_COMPRESS_BLOCK_SIZE];
+
+static rt_uint32_t rti_compress_read32(const rt_uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((rt_uint32_t)p[3] << 24);
+}
+
+static rt_uint32_t rti_compress_hash(const rt_uint8_t *p)
+{
+    return (rti_compress_read32(p) * 2654435761u) >> (32 - RTI_COMPRESS_HASH_BITS);
+}
+
+static rt_uint8_t *rti_compress_length(rt_uint8_t *op, rt_size_t length)
+{
+    while (length >= 255)
+    {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (rt_uint8_t)length;
+    return op;
+}
+
+/* one lz4 block, 0 when it does not fit in limit bytes */
+static rt_size_t rti_compress_lz4(const rt_uint8_t *src, rt_size_t length, rt_uint8_t *dst, rt_size_t limit)
+{
+    const rt_uint8_t *ip = src, *anchor = src, *ref;
+    const rt_uint8_t *match_limit = src + length - COMPRESS_MATCH_LIMIT;
+    const rt_uint8_t *match_end = src + length - COMPRESS_LAST_LITERALS;
+    rt_uint8_t *op = dst, *token;
+    rt_size_t literals, match;
+    rt_uint32_t h, pos;
+
+    rt_memset(compress_hash, 0, sizeof(compress_hash));
+    while (length > COMPRESS_MATCH_LIMIT && ip < match_limit)
+    {
+        h = rti_compress_hash(ip);
+        pos = compress_hash[h];
+        compress_hash[h] = (rt_uint16_t)(ip - src + 1);
+        if (pos == 0 || rti_compress_read32(src + pos - 1) != rti_compress_read32(ip))
+        {
+            /* step faster through data that does not match */
+            ip += 1 + ((ip - anchor) >> 6);
+            continue;
+        }
+
+        ref = src + pos - 1;
+        while (ip > anchor && ref > src && ip[-1] == ref[-1])
+        {
+            ip--;
+            ref--;
+        }
+        match = COMPRESS_MIN_MATCH;
+        while (ip + match < match_end && ip[match] == ref[match])
+            match++;
+
+        /* token, literals and their length, offset, match length */
+        literals = ip - anchor;
+        if ((rt_size_t)(op - dst) + 1 + literals + literals / 255 + 1 + 2 + match / 255 + 1 > limit)
+            return 0;
+        token = op++;
+        if (literals >= 15)
+        {
+            *token = 15 << 4;
+            op = rti_compress_length(op, literals - 15);
+        }
+        else
+            *token = (rt_uint8_t)(literals << 4);
+        rt_memcpy(op, anchor, literals);
+        op += literals;
+        *op++ = (rt_uint8_t)(ip - ref);
+        *op++ = (rt_uint8_t)((ip - ref) >> 8);
+        if (match - COMPRESS_MIN_MATCH >= 15)
+        {
+            *token |= 15;
+            op = rti_compress_length(op, match - COMPRESS_MIN_MATCH - 15);
+        }
+        else
+            *token |= (rt_uint8_t)(match - COMPRESS_MIN_MATCH);
+
+        ip += match;
+        anchor = ip;
+        /* the next packet often repeats the one just matched */
+        compress_hash[rti_compress_hash(ip - 2)] = (rt_uint16_t)(ip - 2 - src + 1);
+    }
+
+    /* the block ends with literals */
+    literals = src + length - anchor;
+    if ((rt_size_t)(op - dst) + 1 + literals + literals / 255 + 1 > limit)
+        return 0;
+    token = op++;
+    if (literals >= 15)
+    {
+        *token = 15 << 4;
+        op = rti_compress_length(op, literals - 15);
+    }
+    else
+        *token = (rt_uint8_t)(literals << 4);
+    rt_memcpy(op, anchor, literals);
+    op += literals;
+
+    return op - dst;
+}
+
+/* pack length bytes into a frame of up to RTI_COMPRESS_HEAD_SIZE + length bytes, returns the frame size */
+rt_size_t rti_compress_block(const rt_uint8_t *src, rt_size_t length, rt_uint8_t *frame)
+{
+    rt_size_t size;
+
+    RT_ASSERT(length <= RTI_COMPRESS_BLOCK_SIZE);
+
+    if (length == 0)
+        return 0;
+
+    size = rti_compress_lz4(src, length, frame + RTI_COMPRESS_HEAD_SIZE, length - 1);
+    if (size > 0)
+        frame[1] = RTI_COMPRESS_LZ4;
+    else
+    {
+        rt_memcpy(frame + RTI_COMPRESS_HEAD_SIZE, src, length);
+        size = length;
+        frame[1] = RTI_COMPRESS_STORED;
+    }
+    frame[0] = RTI_COMPRESS_MAGIC;
+    frame[2] = (rt_uint8_t)length;
+    frame[3] = (rt_uint8_t)(length >> 8);
+    frame[4] = (rt_uint8_t)size;
+    frame[5] = (rt_uint8_t)(size >> 8);
+    return RTI_COMPRESS_HEAD_SIZE + size;
+}
+
+/* take the next block from the rti buffer and pack it into frame, which
+ * holds RTI_COMPRESS_FRAME_SIZE bytes. Returns the frame size, 0 when the
+ * buffer is empty. One consumer at a time. */
+rt_size_t rti_compress_get(rt_uint8_t *frame)
+{
+    return rti_compress_block(compress_block, rti_data_get(compress_block, sizeof(compress_block)), frame);
+}
+
+#endif
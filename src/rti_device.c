@@ -0,0 +1,462 @@
+/*
+ * File      : rti_device.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+#include "rti_device.h"
+
+#if RTI_CFG(RTI_DEVICE) && defined(RT_USING_DEVICE)
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#endif
+
+/* the operation in the packets and the histograms */
+#define DEVICE_OP_READ          0
+#define DEVICE_OP_WRITE         1
+#define DEVICE_OP_CONTROL       2
+#define DEVICE_OP_NUM           3
+
+/* the driver function behind the trampoline, and the function the kernel
+ * calls now */
+#ifdef RT_USING_DEVICE_OPS
+    #define DEVICE_DRIVER(entry, op)    ((entry)->driver->op)
+    #define DEVICE_CURRENT(dev, op)     ((dev)->ops->op)
+#else
+    #define DEVICE_DRIVER(entry, op)    ((entry)->op)
+    #define DEVICE_CURRENT(dev, op)     ((dev)->op)
+#endif
+
+#ifdef RTI_USING_DEVICE_HIST
+struct rti_device_hist
+{
+    rt_uint32_t count;
+    rt_uint32_t max;
+    rt_uint64_t total;
+    rt_uint32_t bucket[RTI_STATS_BUCKET_NUM];
+};
+#endif
+
+struct rti_device_entry
+{
+    /* zero while the entry is free */
+    rt_device_t device;
+
+    /* the traced operations */
+    rt_uint8_t  ops;
+
+    /* calls in the trampolines, an untraced or unregistered device keeps
+     * its entry until the last one is out */
+    rt_uint8_t  removed;
+    rt_uint16_t busy;
+
+#ifdef RT_USING_DEVICE_OPS
+    const struct rt_device_ops *driver;
+    struct rt_device_ops trampoline;
+#else
+    rt_size_t (*read)(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size);
+    rt_size_t (*write)(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size);
+    rt_err_t  (*control)(rt_device_t dev, int cmd, void *args);
+#endif
+
+#ifdef RTI_USING_DEVICE_HIST
+    struct rti_device_hist hist[DEVICE_OP_NUM];
+#endif
+};
+
+static struct rti_device_entry device_entry[RTI_DEVICE_TRACE_NUM];
+
+static const char * const device_op_names[DEVICE_OP_NUM] =
+{
+    "read", "write", "control"
+};
+
+static struct rti_device_entry *rti_device_entry_get(rt_device_t device)
+{
+    rt_uint8_t i;
+
+    for (i = 0; i < RTI_DEVICE_TRACE_NUM; i++)
+    {
+        if (device_entry[i].device == device && !device_entry[i].removed)
+            return &device_entry[i];
+    }
+    return RT_NULL;
+}
+
+/* the entry of a call in a trampoline, it stays while the call is in. RT_NULL
+ * when the device was untraced after the kernel took the trampoline, the
+ * driver is back in the device then. */
+static struct rti_device_entry *rti_device_begin(rt_device_t device)
+{
+    register rt_ubase_t temp;
+    struct rti_device_entry *entry;
+
+    temp = rt_hw_interrupt_disable();
+    entry = rti_device_entry_get(device);
+    if (entry != RT_NULL)
+        entry->busy++;
+    rt_hw_interrupt_enable(temp);
+    return entry;
+}
+
+static void rti_device_end(struct rti_device_entry *entry)
+{
+    register rt_ubase_t temp;
+
+    temp = rt_hw_interrupt_disable();
+    if (--entry->busy == 0 && entry->removed)
+        rt_memset(entry, 0, sizeof(*entry));
+    rt_hw_interrupt_enable(temp);
+}
+
+#ifdef RTI_USING_DEVICE_HIST
+static void rti_device_hist_add(struct rti_device_hist *hist, rt_uint32_t cycles)
+{
+    register rt_ubase_t temp;
+    rt_uint32_t value = cycles >> RTI_STATS_BUCKET_SHIFT;
+    rt_uint8_t bucket = 0;
+
+    while (value && bucket < RTI_STATS_BUCKET_NUM - 1)
+    {
+        value >>= 1;
+        bucket++;
+    }
+
+    temp = rt_hw_interrupt_disable();
+    hist->bucket[bucket]++;
+    hist->count++;
+    hist->total += cycles;
+    if (cycles > hist->max)
+        hist->max = cycles;
+    rt_hw_interrupt_enable(temp);
+}
+#endif
+
+static void rti_device_enter(rt_device_t device, rt_uint8_t op, rt_uint32_t arg)
+{
+    rt_uint32_t values[2];
+
+    values[0] = op;
+    values[1] = arg;
+    rti_record_device(RTI_ID_DEVICE_ENTER, device, values, 2);
+}
+
+static void rti_device_exit(struct rti_device_entry *entry, rt_uint8_t op, rt_uint32_t result, rt_uint32_t start)
+{
+    rt_uint32_t values[3];
+    rt_uint32_t cycles;
+
+    cycles = RTI_GET_TIMESTAMP() - start;
+#ifdef RTI_USING_DEVICE_HIST
+    rti_device_hist_add(&entry->hist[op], cycles);
+#endif
+    values[0] = op;
+    values[1] = result;
+    values[2] = cycles;
+    rti_record_device(RTI_ID_DEVICE_EXIT, entry->device, values, 3);
+}
+
+static rt_size_t rti_device_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    struct rti_device_entry *entry = rti_device_begin(dev);
+    rt_uint32_t start;
+    rt_size_t result;
+
+    if (entry == RT_NULL)
+        return DEVICE_CURRENT(dev, read)(dev, pos, buffer, size);
+    rti_device_enter(dev, DEVICE_OP_READ, size);
+    start = RTI_GET_TIMESTAMP();
+    result = DEVICE_DRIVER(entry, read)(dev, pos, buffer, size);
+    rti_device_exit(entry, DEVICE_OP_READ, result, start);
+    rti_device_end(entry);
+    return result;
+}
+
+static rt_size_t rti_device_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    struct rti_device_entry *entry = rti_device_begin(dev);
+    rt_uint32_t start;
+    rt_size_t result;
+
+    if (entry == RT_NULL)
+        return DEVICE_CURRENT(dev, write)(dev, pos, buffer, size);
+    rti_device_enter(dev, DEVICE_OP_WRITE, size);
+    start = RTI_GET_TIMESTAMP();
+    result = DEVICE_DRIVER(entry, write)(dev, pos, buffer, size);
+    rti_device_exit(entry, DEVICE_OP_WRITE, result, start);
+    rti_device_end(entry);
+    return result;
+}
+
+static rt_err_t rti_device_control(rt_device_t dev, int cmd, void *args)
+{
+    struct rti_device_entry *entry = rti_device_begin(dev);
+    rt_uint32_t start;
+    rt_err_t result;
+
+    if (entry == RT_NULL)
+        return DEVICE_CURRENT(dev, control)(dev, cmd, args);
+    rti_device_enter(dev, DEVICE_OP_CONTROL, cmd);
+    start = RTI_GET_TIMESTAMP();
+    result = DEVICE_DRIVER(entry, control)(dev, cmd, args);
+    rti_device_exit(entry, DEVICE_OP_CONTROL, result, start);
+    rti_device_end(entry);
+    return result;
+}
+
+/* take the driver functions of a new entry, call with interrupts disabled */
+static rt_err_t rti_device_attach(struct rti_device_entry *entry, rt_device_t device)
+{
+#ifdef RT_USING_DEVICE_OPS
+    if (device->ops == RT_NULL)
+        return -RT_ERROR;
+    rt_memset(entry, 0, sizeof(*entry));
+    entry->driver = device->ops;
+    entry->trampoline = *device->ops;
+#else
+    rt_memset(entry, 0, sizeof(*entry));
+    entry->read = device->read;
+    entry->write = device->write;
+    entry->control = device->control;
+#endif
+    entry->device = device;
+    return RT_EOK;
+}
+
+/* put the trampolines of ops in front of the driver, call with interrupts disabled */
+static void rti_device_install(struct rti_device_entry *entry, rt_uint8_t ops)
+{
+    rt_device_t device = entry->device;
+
+    /* the kernel checks for the operations a driver does not have */
+    if (DEVICE_DRIVER(entry, read) == RT_NULL)
+        ops &= ~RTI_DEVICE_READ;
+    if (DEVICE_DRIVER(entry, write) == RT_NULL)
+        ops &= ~RTI_DEVICE_WRITE;
+    if (DEVICE_DRIVER(entry, control) == RT_NULL)
+        ops &= ~RTI_DEVICE_CONTROL;
+
+#ifdef RT_USING_DEVICE_OPS
+    entry->trampoline.read = (ops & RTI_DEVICE_READ) ? rti_device_read : entry->driver->read;
+    entry->trampoline.write = (ops & RTI_DEVICE_WRITE) ? rti_device_write : entry->driver->write;
+    entry->trampoline.control = (ops & RTI_DEVICE_CONTROL) ? rti_device_control : entry->driver->control;
+    device->ops = ops ? &entry->trampoline : entry->driver;
+#else
+    device->read = (ops & RTI_DEVICE_READ) ? rti_device_read : entry->read;
+    device->write = (ops & RTI_DEVICE_WRITE) ? rti_device_write : entry->write;
+    device->control = (ops & RTI_DEVICE_CONTROL) ? rti_device_control : entry->control;
+#endif
+    entry->ops = ops;
+}
+
+/* give the device its driver back and free the entry, the last call out of
+ * a trampoline frees it if one is in. Call with interrupts disabled */
+static void rti_device_free(struct rti_device_entry *entry)
+{
+    rti_device_install(entry, 0);
+    if (entry->busy > 0)
+        entry->removed = RT_TRUE;
+    else
+        rt_memset(entry, 0, sizeof(*entry));
+}
+
+rt_err_t rti_device_trace(const char *name, rt_uint8_t ops)
+{
+    register rt_ubase_t temp;
+    struct rti_device_entry *entry;
+    rt_device_t device;
+    rt_uint8_t i;
+
+    if (ops == 0 || (ops & ~RTI_DEVICE_ALL))
+        return -RT_EINVAL;
+    device = rt_device_find(name);
+    if (device == RT_NULL)
+        return -RT_ERROR;
+
+    temp = rt_hw_interrupt_disable();
+    entry = rti_device_entry_get(device);
+    if (entry == RT_NULL)
+    {
+        for (i = 0; i < RTI_DEVICE_TRACE_NUM && entry == RT_NULL; i++)
+        {
+            if (device_entry[i].device == RT_NULL)
+                entry = &device_entry[i];
+        }
+        if (entry == RT_NULL)
+        {
+            rt_hw_interrupt_enable(temp);
+            return -RT_EFULL;
+        }
+        if (rti_device_attach(entry, device) != RT_EOK)
+        {
+            rt_hw_interrupt_enable(temp);
+            return -RT_ERROR;
+        }
+    }
+    rti_device_install(entry, ops);
+    rt_hw_interrupt_enable(temp);
+    return RT_EOK;
+}
+
+rt_err_t rti_device_untrace(const char *name)
+{
+    register rt_ubase_t temp;
+    struct rti_device_entry *entry;
+    rt_device_t device;
+
+    device = rt_device_find(name);
+    if (device == RT_NULL)
+        return -RT_ERROR;
+
+    temp = rt_hw_interrupt_disable();
+    entry = rti_device_entry_get(device);
+    if (entry != RT_NULL)
+        rti_device_free(entry);
+    rt_hw_interrupt_enable(temp);
+    return RT_EOK;
+}
+
+/* the device is unregistered, its trampolines go with it */
+void rti_device_remove(rt_device_t device)
+{
+    register rt_ubase_t temp;
+    struct rti_device_entry *entry;
+
+    temp = rt_hw_interrupt_disable();
+    entry = rti_device_entry_get(device);
+    if (entry != RT_NULL)
+        rti_device_free(entry);
+    rt_hw_interrupt_enable(temp);
+}
+
+void rti_device_reset(void)
+{
+#ifdef RTI_USING_DEVICE_HIST
+    register rt_ubase_t temp;
+    rt_uint8_t i;
+
+    temp = rt_hw_interrupt_disable();
+    for (i = 0; i < RTI_DEVICE_TRACE_NUM; i++)
+        rt_memset(device_entry[i].hist, 0, sizeof(device_entry[i].hist));
+    rt_hw_interrupt_enable(temp);
+#endif
+}
+
+#ifdef RTI_USING_DEVICE_HIST
+/* one decimal place, rt_kprintf has no floating point */
+static rt_uint32_t rti_device_us10(rt_uint64_t cycles)
+{
+    return (rt_uint32_t)(cycles * 10000000ULL / RTI_SYS_FREQ);
+}
+
+static void rti_device_show_hist(struct rti_device_entry *entry)
+{
+    struct rti_device_hist *hist;
+    rt_uint32_t avg, max;
+    rt_uint8_t op, j;
+
+    for (op = 0; op < DEVICE_OP_NUM; op++)
+    {
+        hist = &entry->hist[op];
+        if (hist->count == 0)
+            continue;
+        avg = rti_device_us10(hist->total / hist->count);
+        max = rti_device_us10(hist->max);
+        rt_kprintf("  %-7s %8d %6d.%d %6d.%d ", device_op_names[op], hist->count,
+                   avg / 10, avg % 10, max / 10, max % 10);
+        for (j = 0; j < RTI_STATS_BUCKET_NUM; j++)
+        {
+            /* the upper bound of the bucket, the last one has none */
+            if (hist->bucket[j] == 0)
+                continue;
+            if (j < RTI_STATS_BUCKET_NUM - 1)
+                rt_kprintf(" <%d:%d", 1 << (RTI_STATS_BUCKET_SHIFT + j), hist->bucket[j]);
+            else
+                rt_kprintf(" >=%d:%d", 1 << (RTI_STATS_BUCKET_SHIFT + j - 1), hist->bucket[j]);
+        }
+        rt_kprintf("\n");
+    }
+}
+#endif
+
+void rti_device_show(void)
+{
+    struct rti_device_entry *entry;
+    rt_uint8_t i, op;
+
+    rt_kprintf("device   traced\n");
+#ifdef RTI_USING_DEVICE_HIST
+    rt_kprintf("  op         count  avg(us)  max(us)  cycles:count\n");
+#endif
+    for (i = 0; i < RTI_DEVICE_TRACE_NUM; i++)
+    {
+        entry = &device_entry[i];
+        if (entry->device == RT_NULL || entry->removed)
+            continue;
+        rt_kprintf("%-8.*s", RT_NAME_MAX, entry->device->parent.name);
+        for (op = 0; op < DEVICE_OP_NUM; op++)
+        {
+            if (entry->ops & (1 << op))
+                rt_kprintf(" %s", device_op_names[op]);
+        }
+        rt_kprintf(entry->ops ? "\n" : " -\n");
+#ifdef RTI_USING_DEVICE_HIST
+        rti_device_show_hist(entry);
+#endif
+    }
+}
+
+#ifdef RT_USING_FINSH
+static void rti_device(int argc, char **argv)
+{
+    rt_uint8_t ops = 0;
+    const char *p;
+    rt_err_t result = RT_EOK;
+
+    if (argc > 2 && !rt_strcmp(argv[1], "trace"))
+    {
+        /* r, w and c choose the operations, all of them by default */
+        for (p = argc > 3 ? argv[3] : "rwc"; *p; p++)
+        {
+            if (*p == 'r')
+                ops |= RTI_DEVICE_READ;
+            else if (*p == 'w')
+                ops |= RTI_DEVICE_WRITE;
+            else if (*p == 'c')
+                ops |= RTI_DEVICE_CONTROL;
+        }
+        result = rti_device_trace(argv[2], ops);
+    }
+    else if (argc > 2 && !rt_strcmp(argv[1], "untrace"))
+        result = rti_device_untrace(argv[2]);
+    else if (argc > 1 && !rt_strcmp(argv[1], "reset"))
+        rti_device_reset();
+    else
+        rti_device_show();
+
+    if (result != RT_EOK)
+        rt_kprintf("rti device: %s failed (%d)\n", argv[1], result);
+}
+MSH_CMD_EXPORT(rti_device, rti device io: rti_device [trace name [rwc]|untrace name|reset]);
+#endif
+
+#endif
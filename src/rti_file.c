@@ -0,0 +1,403 @@
+/*
+ * File      : stats.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#include "rti_file.h"
+
+#ifdef RTI_USING_FILE
+
+#ifndef RT_USING_DFS
+    #error "the rti file sink needs RT_USING_DFS"
+#endif
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#include <stdlib.h>
+#endif
+
+#ifdef RTI_USING_COMPRESS
+#include "rti_compress.h"
+#endif
+
+#if (RTI_FILE_BUFFER_SIZE % 512) != 0
+    #error "RTI_FILE_BUFFER_SIZE must be a multiple of 512"
+#endif
+
+static struct
+{
+    int fd;
+    char path[RTI_FILE_PATH_MAX];
+    rt_uint32_t rotate_size;
+
+    /* number of the current file and the bytes written to it */
+    rt_uint32_t index;
+    rt_uint32_t size;
+
+    /* bytes in the write buffer */
+    rt_uint32_t fill;
+
+    /* the rti thread and rti_file_stop both drain */
+    struct rt_mutex lock;
+
+#ifdef RTI_USING_COMPRESS
+    /* frames instead of the plain stream, the next start takes it */
+    rt_bool_t compress;
+    rt_bool_t packed;
+
+    /* bytes of the preamble of a rotated file waiting in raw_buf */
+    rt_uint32_t raw;
+#endif
+
+    /* since rti_file_start */
+    rt_uint32_t files;
+    rt_uint32_t writes;
+    rt_uint32_t errors;
+    rt_uint64_t bytes;
+    rt_uint64_t cycles;
+} file = {.fd = -1};
+
+ALIGN(RT_ALIGN_SIZE) static rt_uint8_t file_buf[RTI_FILE_BUFFER_SIZE];
+
+#ifdef RTI_USING_COMPRESS
+static rt_uint8_t raw_buf[RTI_COMPRESS_BLOCK_SIZE];
+static rt_uint8_t frame_buf[RTI_COMPRESS_FRAME_SIZE];
+#endif
+
+/* trace.SVDat is trace_3.SVDat as the file with number 3 */
+static void rti_file_name(char *name, rt_uint32_t index)
+{
+    const char *ext;
+
+    if (file.rotate_size == 0)
+    {
+        rt_strncpy(name, file.path, RTI_FILE_PATH_MAX);
+        return ;
+    }
+    ext = strrchr(file.path, '.');
+    if (ext == RT_NULL || strchr(ext, '/') != RT_NULL)
+        ext = file.path + rt_strlen(file.path);
+    rt_snprintf(name, RTI_FILE_PATH_MAX, "%.*s_%d%s", (int)(ext - file.path), file.path,
+                index % RTI_FILE_ROTATE_NUM, ext);
+}
+
+static rt_err_t rti_file_open(void)
+{
+    char name[RTI_FILE_PATH_MAX];
+
+    rti_file_name(name, file.index);
+    file.fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (file.fd < 0)
+    {
+        file.errors ++;
+        return -RT_ERROR;
+    }
+    file.size = 0;
+    file.files ++;
+    return RT_EOK;
+}
+
+/* write the buffer out */
+static void rti_file_write(void)
+{
+    rt_uint32_t start;
+    int result;
+
+    if (file.fill == 0)
+        return ;
+    start = RTI_GET_TIMESTAMP();
+    result = write(file.fd, file_buf, file.fill);
+    file.cycles += (rt_uint32_t)(RTI_GET_TIMESTAMP() - start);
+    if (result != (int)file.fill)
+        file.errors ++;
+    else
+        file.bytes += file.fill;
+    file.writes ++;
+    file.size += file.fill;
+    file.fill = 0;
+}
+
+/* copy to the write buffer */
+static void rti_file_append(const rt_uint8_t *ptr, rt_size_t length)
+{
+    rt_size_t size;
+
+    while (length > 0)
+    {
+        if (file.fill == RTI_FILE_BUFFER_SIZE)
+            rti_file_write();
+        size = RTI_FILE_BUFFER_SIZE - file.fill;
+        if (size > length)
+            size = length;
+        rt_memcpy(file_buf + file.fill, ptr, size);
+        file.fill += size;
+        ptr += size;
+        length -= size;
+    }
+}
+
+#ifdef RTI_USING_COMPRESS
+/* pack the preamble collected in raw_buf */
+static void rti_file_pack(void)
+{
+    if (file.raw == 0)
+        return ;
+    rti_file_append(frame_buf, rti_compress_block(raw_buf, file.raw, frame_buf));
+    file.raw = 0;
+}
+#endif
+
+/* collects the preamble of a new file */
+static void rti_file_output(const rt_uint8_t *ptr, rt_size_t length)
+{
+#ifdef RTI_USING_COMPRESS
+    rt_size_t size;
+
+    if (file.packed)
+    {
+        while (length > 0)
+        {
+            if (file.raw == sizeof(raw_buf))
+                rti_file_pack();
+            size = sizeof(raw_buf) - file.raw;
+            if (size > length)
+                size = length;
+            rt_memcpy(raw_buf + file.raw, ptr, size);
+            file.raw += size;
+            ptr += size;
+            length -= size;
+        }
+        return ;
+    }
+#endif
+    rti_file_append(ptr, length);
+}
+
+static void rti_file_rotate(void)
+{
+    rti_file_write();
+    fsync(file.fd);
+    close(file.fd);
+
+    file.index ++;
+    if (rti_file_open() != RT_EOK)
+    {
+        /* the rti thread would call us for ever */
+        rti_data_new_data_notify_set_hook(RT_NULL);
+        return ;
+    }
+    rti_preamble(rti_file_output);
+#ifdef RTI_USING_COMPRESS
+    rti_file_pack();
+#endif
+}
+
+#ifdef RTI_USING_COMPRESS
+/* move the rti buffer to the file in frames, a frame ends where a read
+ * of the buffer ends, so the files still start on packet boundaries */
+static void rti_file_drain_packed(void)
+{
+    rt_size_t size;
+
+    while ((size = rti_compress_get(frame_buf)) > 0)
+    {
+        rti_file_append(frame_buf, size);
+        if (file.rotate_size && rti_data_boundary() && file.size + file.fill >= file.rotate_size)
+            rti_file_rotate();
+        if (file.fd < 0)
+            break;
+    }
+}
+#endif
+
+/* move the rti buffer to the file */
+static void rti_file_drain(void)
+{
+    struct rti_span span[2];
+    rt_size_t size, taken;
+    rt_uint8_t i, count;
+
+#ifdef RTI_USING_COMPRESS
+    if (file.packed)
+    {
+        rti_file_drain_packed();
+        return ;
+    }
+#endif
+    while ((count = rti_data_peek(span)) > 0)
+    {
+        taken = 0;
+        for (i = 0; i < count; i++)
+        {
+            size = RTI_FILE_BUFFER_SIZE - file.fill;
+            if (size > span[i].length)
+                size = span[i].length;
+            rt_memcpy(file_buf + file.fill, span[i].ptr, size);
+            file.fill += size;
+            taken += size;
+            if (size < span[i].length)
+                break;
+        }
+        rti_data_commit(taken);
+
+        /* the reader knows where the packets end, taking all that was
+         * peeked may stop at the wrap of a channel in a packet */
+        if (file.rotate_size && rti_data_boundary() && file.size + file.fill >= file.rotate_size)
+            rti_file_rotate();
+        else if (file.fill == RTI_FILE_BUFFER_SIZE)
+            rti_file_write();
+        if (file.fd < 0)
+            break;
+    }
+}
+
+/* called from the rti thread while the rti buffer is filling up */
+static void rti_file_notify(void)
+{
+    rt_mutex_take(&file.lock, RT_WAITING_FOREVER);
+    if (file.fd >= 0)
+        rti_file_drain();
+    rt_mutex_release(&file.lock);
+}
+
+rt_err_t rti_file_start(const char *path, rt_uint32_t rotate_size)
+{
+    static rt_bool_t inited;
+    rt_err_t result;
+
+    RT_ASSERT(path != RT_NULL);
+
+    if (file.fd >= 0)
+        return -RT_EBUSY;
+    if (rt_strlen(path) + 12 > RTI_FILE_PATH_MAX)
+        return -RT_EINVAL;
+
+    if (!inited)
+    {
+        rt_mutex_init(&file.lock, "rti_file", RT_IPC_FLAG_FIFO);
+        inited = RT_TRUE;
+    }
+
+    rt_strncpy(file.path, path, RTI_FILE_PATH_MAX);
+    file.rotate_size = rotate_size;
+    file.index = 0;
+    file.fill = 0;
+    file.files = 0;
+    file.writes = 0;
+    file.errors = 0;
+    file.bytes = 0;
+    file.cycles = 0;
+#ifdef RTI_USING_COMPRESS
+    file.packed = file.compress;
+    file.raw = 0;
+#endif
+    result = rti_file_open();
+    if (result != RT_EOK)
+        return result;
+
+    /* the first file gets its preamble from rti_start */
+    rti_data_new_data_notify_set_hook(rti_file_notify);
+    rti_start();
+    return RT_EOK;
+}
+
+void rti_file_stop(void)
+{
+    if (file.fd < 0)
+        return ;
+
+    /* rti_stop sends what is left through the notify hook */
+    rti_stop();
+    rti_data_new_data_notify_set_hook(RT_NULL);
+
+    rt_mutex_take(&file.lock, RT_WAITING_FOREVER);
+    if (file.fd >= 0)
+    {
+        rti_file_drain();
+        rti_file_write();
+        fsync(file.fd);
+        close(file.fd);
+        file.fd = -1;
+    }
+    rt_mutex_release(&file.lock);
+}
+
+#ifdef RTI_USING_COMPRESS
+void rti_file_compress(rt_bool_t enable)
+{
+    file.compress = enable;
+}
+#endif
+
+void rti_file_show(void)
+{
+    rt_uint32_t rate;
+
+    rt_kprintf("%s, %d files, %d bytes in %d writes, %d errors\n", file.fd >= 0 ? "recording" : "stopped",
+               file.files, (rt_uint32_t)file.bytes, file.writes, file.errors);
+    if (file.cycles > 0)
+    {
+        rate = (rt_uint32_t)(file.bytes * RTI_SYS_FREQ / file.cycles);
+        rt_kprintf("write rate %d bytes/s\n", rate);
+    }
+#ifdef RTI_USING_COMPRESS
+    if (file.packed)
+        rt_kprintf("compressed frames\n");
+#endif
+}
+
+#ifdef RT_USING_FINSH
+static void rti_file(int argc, char **argv)
+{
+    rt_err_t result;
+
+    if (argc > 2 && !rt_strcmp(argv[1], "start"))
+    {
+#ifdef RTI_USING_COMPRESS
+        rti_file_compress(!rt_strcmp(argv[2], "-z"));
+        if (file.compress)
+        {
+            argc--;
+            argv++;
+        }
+        if (argc < 3)
+        {
+            rt_kprintf("rti_file: no path\n");
+            return ;
+        }
+#endif
+        result = rti_file_start(argv[2], argc > 3 ? atoi(argv[3]) * 1024 : 0);
+        if (result != RT_EOK)
+            rt_kprintf("rti_file: start failed %d\n", result);
+    }
+    else if (argc > 1 && !rt_strcmp(argv[1], "stop"))
+        rti_file_stop();
+    else
+        rti_file_show();
+}
+MSH_CMD_EXPORT(rti_file, record rti to a file: rti_file [start [-z] path [rotate_kb]|stop]);
+#endif
+
+#endif
@@ -0,0 +1,396 @@
+/*
+ * File      : stats.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+#include "rti_lock.h"
+
+#ifdef RTI_USING_LOCK
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#endif
+
+struct rti_lock_count
+{
+    rt_uint32_t acquired;
+    rt_uint32_t contended;
+    rt_uint32_t inversions;
+    rt_uint32_t wait_max;
+    rt_uint32_t hold_max;
+    rt_uint64_t wait;
+    rt_uint64_t hold;
+};
+
+struct rti_lock_entry
+{
+    /* zero while the entry is free */
+    rt_object_t object;
+    char        name[RT_NAME_MAX];
+
+    /* the mutex is held since taken */
+    rt_bool_t   held;
+    rt_uint32_t taken;
+
+    /* since the reset and since the last summary */
+    struct rti_lock_count total;
+    struct rti_lock_count period;
+};
+
+/* a thread between trytake and taken */
+struct rti_lock_waiter
+{
+    rt_thread_t thread;
+    rt_object_t object;
+    rt_uint32_t trytake;
+    rt_bool_t   contended;
+    rt_bool_t   inversion;
+};
+
+static struct
+{
+    volatile rt_uint8_t enable;
+
+    struct rti_lock_entry  entry[RTI_LOCK_NUM];
+    struct rti_lock_waiter waiter[RTI_LOCK_WAITER_NUM];
+
+    struct rt_timer period;
+} lock;
+
+static rt_bool_t rti_lock_profiled(rt_object_t object)
+{
+    rt_uint8_t type = object->type & (~RT_Object_Class_Static);
+
+    return type == RT_Object_Class_Semaphore || type == RT_Object_Class_Mutex;
+}
+
+/* call with interrupts disabled, RT_NULL when the table is full of held mutexes */
+static struct rti_lock_entry *rti_lock_entry_get(rt_object_t object, rt_bool_t create)
+{
+    struct rti_lock_entry *entry, *least = RT_NULL;
+    rt_uint8_t i;
+
+    for (i = 0; i < RTI_LOCK_NUM; i++)
+    {
+        entry = &lock.entry[i];
+        if (entry->object == object)
+            return entry;
+        if (entry->object == RT_NULL)
+        {
+            if (least == RT_NULL || least->object != RT_NULL)
+                least = entry;
+        }
+        else if (!entry->held && (least == RT_NULL ||
+                                  (least->object != RT_NULL && entry->total.wait < least->total.wait)))
+            least = entry;
+    }
+    if (!create || least == RT_NULL)
+        return RT_NULL;
+
+    rt_memset(least, 0, sizeof(*least));
+    least->object = object;
+    rt_strncpy(least->name, object->name, RT_NAME_MAX);
+    return least;
+}
+
+/* call with interrupts disabled */
+static struct rti_lock_waiter *rti_lock_waiter_get(rt_thread_t thread, rt_bool_t create)
+{
+    struct rti_lock_waiter *free = RT_NULL;
+    rt_uint8_t i;
+
+    for (i = 0; i < RTI_LOCK_WAITER_NUM; i++)
+    {
+        if (lock.waiter[i].thread == thread)
+            return &lock.waiter[i];
+        if (lock.waiter[i].thread == RT_NULL && free == RT_NULL)
+            free = &lock.waiter[i];
+    }
+    if (create && free != RT_NULL)
+        free->thread = thread;
+    return create ? free : RT_NULL;
+}
+
+static void rti_lock_count_add(struct rti_lock_count *count, rt_uint32_t wait, struct rti_lock_waiter *waiter)
+{
+    count->acquired++;
+    if (waiter == RT_NULL || !waiter->contended)
+        return ;
+    count->contended++;
+    if (waiter->inversion)
+        count->inversions++;
+    count->wait += wait;
+    if (wait > count->wait_max)
+        count->wait_max = wait;
+}
+
+static void rti_lock_hold_add(struct rti_lock_count *count, rt_uint32_t hold)
+{
+    count->hold += hold;
+    if (hold > count->hold_max)
+        count->hold_max = hold;
+}
+
+static void rti_lock_wait(rt_object_t object, rt_thread_t thread)
+{
+    struct rti_lock_waiter *waiter;
+    rt_thread_t owner;
+
+    waiter = rti_lock_waiter_get(thread, RT_TRUE);
+    if (waiter == RT_NULL)
+        return ;
+    waiter->object    = object;
+    waiter->contended = RT_FALSE;
+    waiter->inversion = RT_FALSE;
+    /* the hook runs before the kernel looks at the object */
+    if ((object->type & (~RT_Object_Class_Static)) == RT_Object_Class_Mutex)
+    {
+        owner = ((rt_mutex_t)object)->owner;
+        if (owner != RT_NULL && owner != thread)
+        {
+            waiter->contended = RT_TRUE;
+            /* and before the owner inherits the priority */
+            waiter->inversion = owner->current_priority > thread->current_priority;
+        }
+    }
+    else if (((rt_sem_t)object)->value == 0)
+        waiter->contended = RT_TRUE;
+    waiter->trytake = RTI_GET_TIMESTAMP();
+}
+
+static void rti_lock_acquire(rt_object_t object, rt_thread_t thread)
+{
+    struct rti_lock_entry *entry;
+    struct rti_lock_waiter *waiter;
+    rt_uint32_t now, wait = 0;
+
+    now = RTI_GET_TIMESTAMP();
+    waiter = rti_lock_waiter_get(thread, RT_FALSE);
+    if (waiter != RT_NULL && waiter->object != object)
+        waiter = RT_NULL;
+    if (waiter != RT_NULL)
+    {
+        wait = now - waiter->trytake;
+        waiter->thread = RT_NULL;
+    }
+
+    entry = rti_lock_entry_get(object, RT_TRUE);
+    if (entry == RT_NULL)
+        return ;
+    rti_lock_count_add(&entry->total, wait, waiter);
+    rti_lock_count_add(&entry->period, wait, waiter);
+    /* a recursive take keeps the first time stamp */
+    if ((object->type & (~RT_Object_Class_Static)) == RT_Object_Class_Mutex && !entry->held)
+    {
+        entry->taken = now;
+        entry->held = RT_TRUE;
+    }
+}
+
+static void rti_lock_hold(rt_object_t object, rt_thread_t thread)
+{
+    struct rti_lock_entry *entry;
+    rt_mutex_t mutex = (rt_mutex_t)object;
+    rt_uint32_t hold;
+
+    if ((object->type & (~RT_Object_Class_Static)) != RT_Object_Class_Mutex)
+        return ;
+    /* the hook runs before the owner is checked and the hold count drops */
+    if (mutex->owner != thread || mutex->hold > 1)
+        return ;
+
+    entry = rti_lock_entry_get(object, RT_FALSE);
+    if (entry == RT_NULL || !entry->held)
+        return ;
+    hold = RTI_GET_TIMESTAMP() - entry->taken;
+    rti_lock_hold_add(&entry->total, hold);
+    rti_lock_hold_add(&entry->period, hold);
+    entry->held = RT_FALSE;
+}
+
+static void rti_lock_event(rt_object_t object, void (*handler)(rt_object_t object, rt_thread_t thread))
+{
+    register rt_ubase_t temp;
+
+    if (!lock.enable || !rti_lock_profiled(object))
+        return ;
+    /* interrupts never wait and hold nothing */
+    if (rt_interrupt_get_nest() > 0)
+        return ;
+
+    temp = rt_hw_interrupt_disable();
+    handler(object, rt_thread_self());
+    rt_hw_interrupt_enable(temp);
+}
+
+void rti_lock_trytake(rt_object_t object)
+{
+    rti_lock_event(object, rti_lock_wait);
+}
+
+void rti_lock_take(rt_object_t object)
+{
+    rti_lock_event(object, rti_lock_acquire);
+}
+
+void rti_lock_release(rt_object_t object)
+{
+    rti_lock_event(object, rti_lock_hold);
+}
+
+static rt_uint32_t rti_lock_clamp(rt_uint64_t value)
+{
+    return value > 0xFFFFFFFFu ? 0xFFFFFFFFu : (rt_uint32_t)value;
+}
+
+/* the summaries of the period, one packet per object that was taken */
+static void rti_lock_period(void *parameter)
+{
+    register rt_ubase_t temp;
+    struct rti_lock_entry *entry;
+    struct rti_lock_count *count;
+    rt_uint32_t values[8];
+    rt_uint8_t i;
+
+    for (i = 0; i < RTI_LOCK_NUM; i++)
+    {
+        entry = &lock.entry[i];
+        count = &entry->period;
+
+        temp = rt_hw_interrupt_disable();
+        if (entry->object == RT_NULL || count->acquired == 0)
+        {
+            rt_hw_interrupt_enable(temp);
+            continue;
+        }
+        values[0] = RTI_SHRINK_ID(entry->object);
+        values[1] = count->acquired;
+        values[2] = count->contended;
+        values[3] = count->inversions;
+        values[4] = rti_lock_clamp(count->wait);
+        values[5] = count->wait_max;
+        values[6] = rti_lock_clamp(count->hold);
+        values[7] = count->hold_max;
+        rt_memset(count, 0, sizeof(*count));
+        rt_hw_interrupt_enable(temp);
+
+        /* dropped while rti does not record */
+        rti_record_values(RTI_ID_LOCK, values, 8);
+    }
+}
+
+void rti_lock_reset(void)
+{
+    register rt_ubase_t temp;
+
+    temp = rt_hw_interrupt_disable();
+    rt_memset(lock.entry, 0, sizeof(lock.entry));
+    rt_memset(lock.waiter, 0, sizeof(lock.waiter));
+    rt_hw_interrupt_enable(temp);
+}
+
+void rti_lock_start(void)
+{
+    static rt_bool_t inited = RT_FALSE;
+    rt_tick_t period = RTI_LOCK_PERIOD;
+
+    if (lock.enable)
+        return ;
+    if (!inited)
+    {
+        rt_timer_init(&lock.period, "rti_lock", rti_lock_period, RT_NULL, period,
+                      RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_SOFT_TIMER);
+        inited = RT_TRUE;
+    }
+    rti_lock_reset();
+    lock.enable = 1;
+    rt_timer_start(&lock.period);
+}
+
+void rti_lock_stop(void)
+{
+    if (!lock.enable)
+        return ;
+    lock.enable = 0;
+    rt_timer_stop(&lock.period);
+}
+
+/* one decimal place, rt_kprintf has no floating point */
+static rt_uint32_t rti_lock_us10(rt_uint64_t cycles)
+{
+    return (rt_uint32_t)(cycles * 10000000ULL / RTI_SYS_FREQ);
+}
+
+void rti_lock_show(void)
+{
+    struct rti_lock_entry *order[RTI_LOCK_NUM], *entry;
+    struct rti_lock_count *count;
+    rt_uint32_t wait, wait_max, hold, hold_max;
+    rt_uint8_t i, j, num = 0;
+
+    /* most waited for first */
+    for (i = 0; i < RTI_LOCK_NUM; i++)
+    {
+        entry = &lock.entry[i];
+        if (entry->object == RT_NULL)
+            continue;
+        for (j = num++; j > 0 && order[j - 1]->total.wait < entry->total.wait; j--)
+            order[j] = order[j - 1];
+        order[j] = entry;
+    }
+    if (num == 0)
+    {
+        rt_kprintf("rti lock: nothing recorded\n");
+        return ;
+    }
+
+    rt_kprintf("lock       taken  waited inverted wait avg/max(us)   hold avg/max(us)\n");
+    for (i = 0; i < num; i++)
+    {
+        count = &order[i]->total;
+        wait = count->contended ? rti_lock_us10(count->wait / count->contended) : 0;
+        wait_max = rti_lock_us10(count->wait_max);
+        hold = count->acquired ? rti_lock_us10(count->hold / count->acquired) : 0;
+        hold_max = rti_lock_us10(count->hold_max);
+        rt_kprintf("%-8.*s %7d %7d %8d %7d.%d/%7d.%d %7d.%d/%7d.%d\n", RT_NAME_MAX, order[i]->name,
+                   count->acquired, count->contended, count->inversions,
+                   wait / 10, wait % 10, wait_max / 10, wait_max % 10,
+                   hold / 10, hold % 10, hold_max / 10, hold_max % 10);
+    }
+}
+
+#ifdef RT_USING_FINSH
+static void rti_lock(int argc, char **argv)
+{
+    if (argc > 1 && !rt_strcmp(argv[1], "start"))
+        rti_lock_start();
+    else if (argc > 1 && !rt_strcmp(argv[1], "stop"))
+        rti_lock_stop();
+    else if (argc > 1 && !rt_strcmp(argv[1], "reset"))
+        rti_lock_reset();
+    else
+        rti_lock_show();
+}
+MSH_CMD_EXPORT(rti_lock, rti lock contention: rti_lock [start|stop|reset]);
+#endif
+
+#endif
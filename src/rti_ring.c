@@ -0,0 +1,221 @@
+/*
+ * File      : rti_ring.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+#include <rthw.h>
+#include "rti_ring.h"
+
+#if defined(ARCH_ARM_CORTEX_M0)
+rt_bool_t rti_atomic_cas(volatile rt_uint32_t *ptr, rt_uint32_t old, rt_uint32_t value)
+{
+    register rt_ubase_t temp;
+    rt_bool_t result = RT_FALSE;
+
+    temp = rt_hw_interrupt_disable();
+    if (*ptr == old)
+    {
+        *ptr = value;
+        result = RT_TRUE;
+    }
+    rt_hw_interrupt_enable(temp);
+    return result;
+}
+#endif
+
+rt_uint32_t rti_atomic_add(volatile rt_uint32_t *ptr, rt_uint32_t value)
+{
+    rt_uint32_t old;
+
+    do
+    {
+        old = *ptr;
+    }
+    while (!RTI_ATOMIC_CAS(ptr, old, old + value));
+    return old + value;
+}
+
+void rti_ring_init(struct rti_ring *ring, rt_uint8_t *pool, rt_uint32_t size)
+{
+    RT_ASSERT(ring != RT_NULL);
+    RT_ASSERT((size & (size - 1)) == 0);
+
+    ring->buffer = pool;
+    ring->mask   = size - 1;
+    ring->committing = 0;
+    ring->skip   = RT_NULL;
+    rti_ring_reset(ring);
+}
+
+void rti_ring_reset(struct rti_ring *ring)
+{
+    ring->reserve = 0;
+    ring->commit  = 0;
+    ring->read    = 0;
+}
+
+rt_base_t rti_ring_enter(struct rti_ring *ring)
+{
+    rt_base_t level = 0;
+
+    /* the producers nesting on top of us must leave before we resume.
+     * Interrupts do, a thread could be switched out for another one in
+     * the middle, so threads keep interrupts off until they leave */
+    if (rt_interrupt_get_nest() == 0)
+        level = rt_hw_interrupt_disable();
+    rti_atomic_add(&ring->committing, 1);
+    RTI_BARRIER();
+    return level;
+}
+
+/* overwrite mode, move the read index past the oldest packets until
+ * length bytes are free after index */
+static rt_err_t rti_ring_drop(struct rti_ring *ring, rt_uint32_t index, rt_uint32_t length)
+{
+    rt_uint32_t read, next, commit, size;
+
+    read   = ring->read;
+    commit = ring->commit;
+    next   = read;
+    while (length > rti_ring_size(ring) - (index - next))
+    {
+        /* the rest is still being written */
+        if (next == commit)
+            return -RT_EFULL;
+
+        size = ring->skip(ring, next);
+        if (size == 0 || size > commit - next)
+        {
+            /* a producer that interrupted us overwrote the packet we
+             * were looking at, otherwise the data is broken */
+            return (ring->read != read) ? -RT_EBUSY : -RT_EFULL;
+        }
+        next += size;
+    }
+    if (!RTI_ATOMIC_CAS(&ring->read, read, next))
+        return -RT_EBUSY;
+    return RT_EOK;
+}
+
+/* try to move the reserve index from index to index + length.
+ * -RT_EBUSY means another producer got in first, take a new snapshot and retry. */
+rt_err_t rti_ring_reserve(struct rti_ring *ring, rt_uint32_t index, rt_uint32_t length)
+{
+    rt_err_t result;
+
+    if (length > rti_ring_size(ring) - (index - ring->read))
+    {
+        if (ring->skip == RT_NULL)
+            return -RT_EFULL;
+        result = rti_ring_drop(ring, index, length);
+        if (result != RT_EOK)
+            return result;
+    }
+    if (!RTI_ATOMIC_CAS(&ring->reserve, index, index + length))
+        return -RT_EBUSY;
+    return RT_EOK;
+}
+
+void rti_ring_write(struct rti_ring *ring, rt_uint32_t index, const rt_uint8_t *ptr, rt_uint32_t length)
+{
+    rt_uint32_t offset, size;
+
+    offset = index & ring->mask;
+    size   = rti_ring_size(ring) - offset;
+    if (size >= length)
+    {
+        rt_memcpy(&ring->buffer[offset], ptr, length);
+    }
+    else
+    {
+        rt_memcpy(&ring->buffer[offset], ptr, size);
+        rt_memcpy(&ring->buffer[0], ptr + size, length - size);
+    }
+}
+
+void rti_ring_leave(struct rti_ring *ring, rt_base_t level)
+{
+    rt_uint32_t reserve;
+
+again:
+    if (ring->committing != 1)
+    {
+        /* an outer producer is still writing, it publishes for us */
+        rti_atomic_add(&ring->committing, (rt_uint32_t)-1);
+    }
+    else
+    {
+        reserve = ring->reserve;
+        RTI_BARRIER();
+        ring->commit = reserve;
+        RTI_BARRIER();
+
+        /* a producer interrupted us after we sampled the reserve index,
+         * it saw us still committing and left its data unpublished */
+        if (rti_atomic_add(&ring->committing, (rt_uint32_t)-1) == 0 && ring->reserve != reserve)
+        {
+            rti_atomic_add(&ring->committing, 1);
+            goto again;
+        }
+    }
+
+    if (rt_interrupt_get_nest() == 0)
+        rt_hw_interrupt_enable(level);
+}
+
+/* the committed data from the read index, in at most two parts because
+ * of the wrap. Returns the number of parts, the unused lengths are zero. */
+rt_uint8_t rti_ring_peek(struct rti_ring *ring, struct rti_span span[2])
+{
+    rt_uint32_t read, length, offset, size;
+
+    read   = ring->read;
+    length = ring->commit - read;
+    span[0].length = 0;
+    span[1].length = 0;
+    if (length == 0)
+        return 0;
+    RTI_BARRIER();
+
+    offset = read & ring->mask;
+    size   = rti_ring_size(ring) - offset;
+    span[0].ptr = &ring->buffer[offset];
+    if (size >= length)
+    {
+        span[0].length = length;
+        return 1;
+    }
+    span[0].length = size;
+    span[1].ptr    = &ring->buffer[0];
+    span[1].length = length - size;
+    return 2;
+}
+
+/* give length bytes from the read index back to the producers */
+void rti_ring_commit(struct rti_ring *ring, rt_size_t length)
+{
+    RT_ASSERT(length <= rti_ring_data_len(ring));
+
+    /* done with the data before the space is reused */
+    RTI_BARRIER();
+    ring->read += length;
+}
@@ -0,0 +1,247 @@
+/*
+ * File      : serial.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+#include <rtdevice.h>
+#include "rti_serial.h"
+#include "rti_ring.h"
+
+#if defined(RT_USING_SERIAL) && defined(RT_USING_SEMAPHORE)
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#endif
+
+#define SERIAL_XFER_NUM     2
+
+static struct
+{
+    rt_device_t dev;
+    rt_bool_t   dma;
+
+    /* transfers handed to the driver, oldest first. Their data stays in
+     * the rti buffer and is committed when the driver is done with it. */
+    rt_size_t   xfer[SERIAL_XFER_NUM];
+    rt_uint8_t  head;
+    rt_uint8_t  count;
+    rt_size_t   queued;
+
+    /* transfers the driver completed, counted in the tx complete callback */
+    volatile rt_uint32_t completed;
+    rt_uint32_t retired;
+
+    /* one context fills at a time, the others leave a note to look again */
+    volatile rt_uint32_t filling;
+    volatile rt_uint32_t missed;
+
+    /* released on every completion. The rti thread and rti_serial_stop
+     * may wait on it at the same time, which a completion does not allow. */
+    struct rt_semaphore tx_done;
+} serial;
+
+/* the data after the queued transfers, in one piece */
+static rt_size_t rti_serial_next(const rt_uint8_t **ptr)
+{
+    struct rti_span span[2];
+    rt_size_t offset = serial.queued;
+    rt_size_t length;
+
+    rti_data_peek(span);
+    if (offset < span[0].length)
+    {
+        *ptr   = span[0].ptr + offset;
+        length = span[0].length - offset;
+    }
+    else
+    {
+        offset -= span[0].length;
+        *ptr   = span[1].ptr + offset;
+        length = span[1].length - offset;
+    }
+    return (length > RTI_SERIAL_XFER_SIZE) ? RTI_SERIAL_XFER_SIZE : length;
+}
+
+/* commit the completed transfers and queue new ones while there is data, thread or isr */
+static void rti_serial_fill(void)
+{
+    const rt_uint8_t *ptr;
+    rt_size_t length;
+
+    do
+    {
+        serial.missed = 0;
+        if (!RTI_ATOMIC_CAS(&serial.filling, 0, 1))
+        {
+            /* the context we interrupted fills for us */
+            serial.missed = 1;
+            return ;
+        }
+
+        while (serial.retired != serial.completed)
+        {
+            length = serial.xfer[serial.head];
+            serial.head = (serial.head + 1) % SERIAL_XFER_NUM;
+            serial.count --;
+            serial.queued -= length;
+            serial.retired ++;
+            rti_data_commit(length);
+        }
+
+        while (serial.count < SERIAL_XFER_NUM)
+        {
+            length = rti_serial_next(&ptr);
+            if (length == 0)
+                break;
+
+            if (!serial.dma)
+            {
+                /* blocks until the data is out */
+                rt_device_write(serial.dev, 0, ptr, length);
+                rti_data_commit(length);
+                continue;
+            }
+            serial.xfer[(serial.head + serial.count) % SERIAL_XFER_NUM] = length;
+            serial.count ++;
+            serial.queued += length;
+            /* queued behind the transfer in flight, straight from the rti buffer */
+            rt_device_write(serial.dev, 0, ptr, length);
+        }
+        serial.filling = 0;
+    }
+    while (serial.missed);
+}
+
+/* called from the dma done interrupt, the driver completes in order */
+static rt_err_t rti_serial_tx_done(rt_device_t dev, void *buffer)
+{
+    rti_atomic_add(&serial.completed, 1);
+    rti_serial_fill();
+    rt_sem_release(&serial.tx_done);
+    return RT_EOK;
+}
+
+/* wait for the next completion, RT_FALSE when the line is stuck */
+static rt_bool_t rti_serial_wait(void)
+{
+    /* the completions nobody waited for are old news */
+    while (rt_sem_trytake(&serial.tx_done) == RT_EOK);
+    if (serial.count == 0)
+        return RT_TRUE;
+    return rt_sem_take(&serial.tx_done, RT_TICK_PER_SECOND) == RT_EOK;
+}
+
+/* called from the rti thread while the rti buffer is filling up, and from
+ * the thread calling rti_stop */
+static void rti_serial_notify(void)
+{
+    rti_serial_fill();
+
+    /* the rest is on the line, wait for it instead of spinning */
+    if (serial.count > 0)
+        rti_serial_wait();
+}
+
+rt_err_t rti_serial_start(rt_device_t dev)
+{
+    static rt_bool_t inited;
+    rt_uint16_t oflag = RT_DEVICE_OFLAG_WRONLY;
+    rt_err_t result;
+
+    RT_ASSERT(dev != RT_NULL);
+
+    if (serial.dev != RT_NULL)
+        return -RT_EBUSY;
+
+    serial.dma = (dev->flag & RT_DEVICE_FLAG_DMA_TX) ? RT_TRUE : RT_FALSE;
+    if (serial.dma)
+        oflag |= RT_DEVICE_FLAG_DMA_TX;
+    result = rt_device_open(dev, oflag);
+    if (result != RT_EOK)
+        return result;
+
+    serial.dev = dev;
+    serial.head = 0;
+    serial.count = 0;
+    serial.queued = 0;
+    serial.completed = 0;
+    serial.retired = 0;
+    serial.filling = 0;
+    serial.missed = 0;
+    /* kept over a stop, the rti thread may still be about to wait on it */
+    if (!inited)
+    {
+        rt_sem_init(&serial.tx_done, "rti_tx", 0, RT_IPC_FLAG_FIFO);
+        inited = RT_TRUE;
+    }
+    if (serial.dma)
+        rt_device_set_tx_complete(dev, rti_serial_tx_done);
+
+    rti_data_new_data_notify_set_hook(rti_serial_notify);
+    rti_start();
+    return RT_EOK;
+}
+
+void rti_serial_stop(void)
+{
+    if (serial.dev == RT_NULL)
+        return ;
+
+    /* rti_stop sends what is left through the notify hook */
+    rti_stop();
+    rti_data_new_data_notify_set_hook(RT_NULL);
+
+    while (serial.count > 0 && rti_serial_wait());
+
+    if (serial.dma)
+        rt_device_set_tx_complete(serial.dev, RT_NULL);
+    rt_device_close(serial.dev);
+    serial.dev = RT_NULL;
+}
+
+#ifdef RT_USING_FINSH
+static void rti_serial(int argc, char **argv)
+{
+    rt_device_t dev;
+    rt_err_t result;
+
+    if (argc > 2 && !rt_strcmp(argv[1], "start"))
+    {
+        dev = rt_device_find(argv[2]);
+        if (dev == RT_NULL)
+        {
+            rt_kprintf("rti_serial: no device %s\n", argv[2]);
+            return ;
+        }
+        result = rti_serial_start(dev);
+        if (result != RT_EOK)
+            rt_kprintf("rti_serial: start failed %d\n", result);
+    }
+    else if (argc > 1 && !rt_strcmp(argv[1], "stop"))
+        rti_serial_stop();
+    else
+        rt_kprintf("rti_serial: %s\n", serial.dev ? serial.dev->parent.name : "stopped");
+}
+MSH_CMD_EXPORT(rti_serial, record to a uart: rti_serial [start device|stop]);
+#endif
+
+#endif
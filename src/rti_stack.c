@@ -0,0 +1,251 @@
+/*
+ * File      : stats.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#include "rti_stack.h"
+
+#ifdef RTI_USING_STACK
+
+#if !RTI_CFG(RTI_THREAD)
+    #error "the stack scan needs RTI_THREAD in RTI_CFG_CLASSES"
+#endif
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#endif
+
+#define STACK_FILL          '#'
+#define STACK_FILL_WORD     0x23232323
+
+struct rti_stack_entry
+{
+    /* zero while the entry is free */
+    rt_thread_t thread;
+
+    /* bytes at the far end of the stack never touched */
+    rt_uint32_t free;
+};
+
+static struct
+{
+    struct rti_stack_entry entry[RTI_STACK_THREAD_NUM];
+
+    /* entry being scanned and the bytes of it checked in this pass */
+    rt_uint16_t index;
+    rt_uint32_t offset;
+
+    /* threads created while the table was full */
+    rt_uint32_t missed;
+} stack;
+
+static struct rt_thread stack_thread;
+ALIGN(RT_ALIGN_SIZE) static rt_uint8_t stack_thread_stack[512];
+
+/* the untouched bytes from the far end of the stack, between offset and limit */
+static rt_uint32_t rti_stack_check(rt_thread_t thread, rt_uint32_t offset, rt_uint32_t limit)
+{
+#ifdef ARCH_CPU_STACK_GROWS_UPWARD
+    rt_uint8_t *p = (rt_uint8_t *)thread->stack_addr + thread->stack_size - 1 - offset;
+
+    while (offset < limit && *p == STACK_FILL)
+    {
+        p--;
+        offset++;
+    }
+#else
+    rt_uint8_t *p = (rt_uint8_t *)thread->stack_addr + offset;
+
+    while (offset + 4 <= limit && ((rt_ubase_t)p & 3) == 0 && *(rt_uint32_t *)p == STACK_FILL_WORD)
+    {
+        p += 4;
+        offset += 4;
+    }
+    while (offset < limit && *p == STACK_FILL)
+    {
+        p++;
+        offset++;
+    }
+#endif
+    return offset;
+}
+
+/* check the next piece of the current stack, RT_FALSE at the end of a pass */
+static rt_bool_t rti_stack_step(void)
+{
+    struct rti_stack_entry *entry;
+    rt_thread_t thread;
+    rt_uint32_t limit, offset, values[4];
+
+    rt_enter_critical();
+    entry = &stack.entry[stack.index];
+    thread = entry->thread;
+    if (thread != RT_NULL)
+    {
+        limit = stack.offset + RTI_STACK_SCAN_SIZE;
+        if (limit > entry->free)
+            limit = entry->free;
+        offset = rti_stack_check(thread, stack.offset, limit);
+        if (offset == limit && limit < entry->free)
+        {
+            /* all untouched so far, go on with the next piece */
+            stack.offset = limit;
+            rt_exit_critical();
+            return RT_TRUE;
+        }
+        if (offset < entry->free)
+        {
+            entry->free = offset;
+            values[0] = RTI_SHRINK_ID(thread);
+            values[1] = (rt_uint32_t)(rt_ubase_t)thread->stack_addr;
+            values[2] = thread->stack_size;
+            values[3] = thread->stack_size - offset;
+            rti_record_values(RTI_ID_STACK_INFO, values, 4);
+        }
+    }
+    stack.offset = 0;
+    stack.index ++;
+    if (stack.index == RTI_STACK_THREAD_NUM)
+        stack.index = 0;
+    rt_exit_critical();
+    return stack.index != 0;
+}
+
+static void rti_stack_entry(void *parameter)
+{
+    while (1)
+    {
+        while (rti_stack_step())
+            ;
+        rt_thread_delay(RTI_STACK_PERIOD);
+    }
+}
+
+void rti_stack_add(rt_thread_t thread)
+{
+    register rt_ubase_t temp;
+    rt_uint16_t i;
+
+    temp = rt_hw_interrupt_disable();
+    for (i = 0; i < RTI_STACK_THREAD_NUM; i++)
+    {
+        if (stack.entry[i].thread == RT_NULL || stack.entry[i].thread == thread)
+        {
+            stack.entry[i].thread = thread;
+            stack.entry[i].free = thread->stack_size;
+            break;
+        }
+    }
+    if (i == RTI_STACK_THREAD_NUM)
+        stack.missed ++;
+    rt_hw_interrupt_enable(temp);
+}
+
+void rti_stack_remove(rt_thread_t thread)
+{
+    register rt_ubase_t temp;
+    rt_uint16_t i;
+
+    temp = rt_hw_interrupt_disable();
+    for (i = 0; i < RTI_STACK_THREAD_NUM; i++)
+    {
+        if (stack.entry[i].thread == thread)
+        {
+            stack.entry[i].thread = RT_NULL;
+            if (stack.index == i)
+                stack.offset = 0;
+            break;
+        }
+    }
+    rt_hw_interrupt_enable(temp);
+}
+
+rt_uint32_t rti_stack_used(rt_thread_t thread)
+{
+    rt_uint16_t i;
+
+    for (i = 0; i < RTI_STACK_THREAD_NUM; i++)
+    {
+        if (stack.entry[i].thread == thread)
+            return thread->stack_size - stack.entry[i].free;
+    }
+    return 0;
+}
+
+void rti_stack_init(void)
+{
+    struct rt_list_node *node, *list;
+    rt_thread_t thread;
+
+    /* the threads from before rti, the hooks tell about the rest */
+    list = &rt_object_get_information(RT_Object_Class_Thread)->object_list;
+    rt_enter_critical();
+    for (node = list->next; node != list; node = node->next)
+    {
+        thread = rt_list_entry(node, struct rt_thread, list);
+        rti_stack_add(thread);
+    }
+    rt_exit_critical();
+
+    rt_thread_init(&stack_thread, "rti_stk", rti_stack_entry, RT_NULL,
+                   stack_thread_stack, sizeof(stack_thread_stack), RTI_STACK_THREAD_PRIORITY, 10);
+    rt_thread_startup(&stack_thread);
+}
+
+void rti_stack_show(void)
+{
+    char name[RT_NAME_MAX + 1];
+    rt_uint32_t size = 0, used = 0;
+    rt_thread_t thread;
+    rt_uint16_t i;
+
+    rt_kprintf("%-*.*s  size   used  used%%\n", RT_NAME_MAX, RT_NAME_MAX, "thread");
+    for (i = 0; i < RTI_STACK_THREAD_NUM; i++)
+    {
+        /* the thread may go away while we print */
+        rt_enter_critical();
+        thread = stack.entry[i].thread;
+        if (thread != RT_NULL)
+        {
+            rt_strncpy(name, thread->name, RT_NAME_MAX);
+            name[RT_NAME_MAX] = '\0';
+            size = thread->stack_size;
+            used = size - stack.entry[i].free;
+        }
+        rt_exit_critical();
+
+        if (thread != RT_NULL)
+            rt_kprintf("%-*.*s %5d  %5d  %3d%%\n", RT_NAME_MAX, RT_NAME_MAX, name,
+                       size, used, size ? used * 100 / size : 0);
+    }
+    if (stack.missed)
+        rt_kprintf("%d threads not measured, the table is full\n", stack.missed);
+}
+
+#ifdef RT_USING_FINSH
+static void rti_stack(int argc, char **argv)
+{
+    rti_stack_show();
+}
+MSH_CMD_EXPORT(rti_stack, show the stack high water marks);
+#endif
+
+#endif
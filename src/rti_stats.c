@@ -0,0 +1,404 @@
+/*
+ * File      : stats.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+#include "rti_stats.h"
+
+#ifdef RTI_USING_STATS
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#endif
+
+#define STATS_ISR_NEST      8
+
+/* the entry after the table takes what does not fit */
+#define STATS_OTHER         "other"
+
+struct rti_stats_thread
+{
+    struct rti_thread_entry head;
+
+    /* cycles since the reset and in the current period */
+    rt_uint64_t run;
+    rt_uint32_t run_period;
+    rt_uint32_t switches;
+};
+
+struct rti_stats_hist
+{
+    /* interrupt vector or timer, zero while the entry is free */
+    rt_uint32_t id;
+    char        name[RT_NAME_MAX];
+
+    rt_uint32_t enter;
+    rt_uint32_t count;
+    rt_uint32_t max;
+    rt_uint64_t total;
+    rt_uint32_t bucket[RTI_STATS_BUCKET_NUM];
+};
+
+static struct
+{
+    volatile rt_uint8_t enable;
+
+    /* time stamp up to which the running thread is accounted */
+    rt_uint32_t last;
+    rt_uint32_t switches_period;
+
+    struct rti_stats_thread thread[RTI_STATS_THREAD_NUM + 1];
+    struct rti_stats_hist   isr[RTI_STATS_ISR_NUM + 1];
+    struct rti_stats_hist   timer[RTI_STATS_TIMER_NUM + 1];
+
+    /* interrupts in progress, by nest level */
+    rt_uint32_t isr_enter[STATS_ISR_NEST];
+    rt_uint32_t isr_id[STATS_ISR_NEST];
+
+    struct rt_timer period;
+
+    /* the summary packet, built in the period timer */
+    rt_uint32_t values[2 + 2 * (RTI_STATS_THREAD_NUM + 1)];
+} stats;
+
+/* call with interrupts disabled */
+static struct rti_stats_thread *rti_stats_thread_get(rt_thread_t thread)
+{
+    return rti_thread_entry_get(stats.thread, sizeof(stats.thread[0]), RTI_STATS_THREAD_NUM, thread);
+}
+
+/* call with interrupts disabled */
+static struct rti_stats_hist *rti_stats_hist_get(struct rti_stats_hist *table, rt_uint8_t num, rt_uint32_t id)
+{
+    rt_uint8_t i;
+
+    for (i = 0; i < num; i++)
+    {
+        if (table[i].id == id)
+            return &table[i];
+        if (table[i].id == 0)
+        {
+            table[i].id = id;
+            return &table[i];
+        }
+    }
+    return &table[num];
+}
+
+static void rti_stats_hist_add(struct rti_stats_hist *hist, rt_uint32_t cycles)
+{
+    rt_uint32_t value = cycles >> RTI_STATS_BUCKET_SHIFT;
+    rt_uint8_t bucket = 0;
+
+    while (value && bucket < RTI_STATS_BUCKET_NUM - 1)
+    {
+        value >>= 1;
+        bucket++;
+    }
+    hist->bucket[bucket]++;
+    hist->count++;
+    hist->total += cycles;
+    if (cycles > hist->max)
+        hist->max = cycles;
+}
+
+/* charge the time since the last call to the running thread, with interrupts disabled */
+static void rti_stats_account(rt_uint32_t now)
+{
+    struct rti_stats_thread *entry;
+    rt_uint32_t cycles;
+
+    cycles = now - stats.last;
+    stats.last = now;
+    entry = rti_stats_thread_get(rt_thread_self());
+    entry->run += cycles;
+    entry->run_period += cycles;
+}
+
+void rti_stats_schedule(rt_thread_t from, rt_thread_t to)
+{
+    register rt_ubase_t temp;
+
+    if (!stats.enable)
+        return ;
+
+    temp = rt_hw_interrupt_disable();
+    /* the kernel still runs on from */
+    rti_stats_account(RTI_GET_TIMESTAMP());
+    rti_stats_thread_get(to)->switches++;
+    stats.switches_period++;
+    rt_hw_interrupt_enable(temp);
+}
+
+void rti_stats_isr_enter(void)
+{
+    rt_uint8_t nest;
+
+    if (!stats.enable)
+        return ;
+
+    /* the kernel has counted this interrupt already */
+    nest = rt_interrupt_get_nest();
+    if (nest > 0 && nest <= STATS_ISR_NEST)
+    {
+        stats.isr_id[nest - 1]    = RTI_GET_ISR_ID();
+        stats.isr_enter[nest - 1] = RTI_GET_TIMESTAMP();
+    }
+}
+
+void rti_stats_isr_leave(void)
+{
+    register rt_ubase_t temp;
+    rt_uint32_t now;
+    rt_uint8_t nest;
+
+    if (!stats.enable)
+        return ;
+
+    now = RTI_GET_TIMESTAMP();
+    /* and has already uncounted it here */
+    nest = rt_interrupt_get_nest();
+    temp = rt_hw_interrupt_disable();
+    if (nest < STATS_ISR_NEST)
+    {
+        /* vector 0 marks a free entry, it is never an interrupt */
+        rti_stats_hist_add(rti_stats_hist_get(stats.isr, RTI_STATS_ISR_NUM, stats.isr_id[nest] + 1),
+                           now - stats.isr_enter[nest]);
+    }
+    /* keeps the accounting ahead of the time stamp wrap */
+    if (nest == 0)
+        rti_stats_account(now);
+    rt_hw_interrupt_enable(temp);
+}
+
+void rti_stats_timer_enter(rt_timer_t timer)
+{
+    register rt_ubase_t temp;
+    struct rti_stats_hist *hist;
+
+    if (!stats.enable)
+        return ;
+
+    temp = rt_hw_interrupt_disable();
+    hist = rti_stats_hist_get(stats.timer, RTI_STATS_TIMER_NUM, (rt_uint32_t)(rt_ubase_t)timer);
+    if (hist->name[0] == '\0')
+        rt_strncpy(hist->name, timer->parent.name, RT_NAME_MAX);
+    hist->enter = RTI_GET_TIMESTAMP();
+    rt_hw_interrupt_enable(temp);
+}
+
+void rti_stats_timer_exit(rt_timer_t timer)
+{
+    register rt_ubase_t temp;
+    struct rti_stats_hist *hist;
+
+    if (!stats.enable)
+        return ;
+
+    temp = rt_hw_interrupt_disable();
+    hist = rti_stats_hist_get(stats.timer, RTI_STATS_TIMER_NUM, (rt_uint32_t)(rt_ubase_t)timer);
+    rti_stats_hist_add(hist, RTI_GET_TIMESTAMP() - hist->enter);
+    rt_hw_interrupt_enable(temp);
+}
+
+/* the summary packet of the period */
+static void rti_stats_period(void *parameter)
+{
+    register rt_ubase_t temp;
+    struct rti_stats_thread *entry;
+    rt_uint32_t period = 0;
+    rt_uint16_t count = 2;
+    rt_uint8_t i;
+
+    temp = rt_hw_interrupt_disable();
+    rti_stats_account(RTI_GET_TIMESTAMP());
+    for (i = 0; i <= RTI_STATS_THREAD_NUM; i++)
+        period += stats.thread[i].run_period;
+    for (i = 0; i <= RTI_STATS_THREAD_NUM && period > 0; i++)
+    {
+        entry = &stats.thread[i];
+        if (entry->run_period == 0)
+            continue;
+        stats.values[count++] = (i < RTI_STATS_THREAD_NUM) ? RTI_SHRINK_ID(entry->head.thread) : 0;
+        stats.values[count++] = (rt_uint32_t)((rt_uint64_t)entry->run_period * 10000 / period);
+        entry->run_period = 0;
+    }
+    stats.values[0] = (rt_uint32_t)((rt_uint64_t)period * 1000000 / RTI_SYS_FREQ);
+    stats.values[1] = stats.switches_period;
+    stats.switches_period = 0;
+    rt_hw_interrupt_enable(temp);
+
+    /* dropped while rti does not record */
+    rti_record_values(RTI_ID_STATS, stats.values, count);
+}
+
+/* the entry of a closed thread is free again, its time stays in other */
+void rti_stats_remove(rt_thread_t thread)
+{
+    register rt_ubase_t temp;
+    struct rti_stats_thread *entry, *other = &stats.thread[RTI_STATS_THREAD_NUM];
+
+    temp = rt_hw_interrupt_disable();
+    entry = rti_thread_entry_find(stats.thread, sizeof(stats.thread[0]), RTI_STATS_THREAD_NUM, thread);
+    if (entry != RT_NULL)
+    {
+        other->run += entry->run;
+        other->run_period += entry->run_period;
+        other->switches += entry->switches;
+        rt_memset(entry, 0, sizeof(*entry));
+    }
+    rt_hw_interrupt_enable(temp);
+}
+
+void rti_stats_reset(void)
+{
+    register rt_ubase_t temp;
+
+    temp = rt_hw_interrupt_disable();
+    rt_memset(stats.thread, 0, sizeof(stats.thread));
+    rt_memset(stats.isr, 0, sizeof(stats.isr));
+    rt_memset(stats.timer, 0, sizeof(stats.timer));
+    rt_strncpy(stats.thread[RTI_STATS_THREAD_NUM].head.name, STATS_OTHER, RT_NAME_MAX);
+    rt_strncpy(stats.isr[RTI_STATS_ISR_NUM].name, STATS_OTHER, RT_NAME_MAX);
+    rt_strncpy(stats.timer[RTI_STATS_TIMER_NUM].name, STATS_OTHER, RT_NAME_MAX);
+    stats.switches_period = 0;
+    stats.last = RTI_GET_TIMESTAMP();
+    rt_hw_interrupt_enable(temp);
+}
+
+void rti_stats_start(void)
+{
+    static rt_bool_t inited = RT_FALSE;
+    rt_tick_t period = RTI_STATS_PERIOD;
+
+    if (stats.enable)
+        return ;
+    if (!inited)
+    {
+        rt_timer_init(&stats.period, "rti_stat", rti_stats_period, RT_NULL, period,
+                      RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_SOFT_TIMER);
+        inited = RT_TRUE;
+    }
+    rti_stats_reset();
+    stats.enable = 1;
+    rt_timer_start(&stats.period);
+}
+
+void rti_stats_stop(void)
+{
+    if (!stats.enable)
+        return ;
+    stats.enable = 0;
+    rt_timer_stop(&stats.period);
+}
+
+/* one decimal place, rt_kprintf has no floating point */
+static rt_uint32_t rti_stats_us10(rt_uint64_t cycles)
+{
+    return (rt_uint32_t)(cycles * 10000000ULL / RTI_SYS_FREQ);
+}
+
+static void rti_stats_show_hist(const char *title, struct rti_stats_hist *table, rt_uint8_t num)
+{
+    struct rti_stats_hist *hist;
+    rt_uint32_t avg, max;
+    rt_uint8_t i, j;
+
+    rt_kprintf("%-8s    count  avg(us)  max(us)  cycles:count\n", title);
+    for (i = 0; i <= num; i++)
+    {
+        hist = &table[i];
+        if (hist->count == 0)
+            continue;
+        avg = rti_stats_us10(hist->total / hist->count);
+        max = rti_stats_us10(hist->max);
+        if (hist->name[0] != '\0')
+            rt_kprintf("%-8.*s", RT_NAME_MAX, hist->name);
+        else
+            rt_kprintf("%-8d", hist->id - 1);
+        rt_kprintf(" %8d %6d.%d %6d.%d ", hist->count, avg / 10, avg % 10, max / 10, max % 10);
+        for (j = 0; j < RTI_STATS_BUCKET_NUM; j++)
+        {
+            /* the upper bound of the bucket */
+            if (hist->bucket[j])
+                rt_kprintf(" <%d:%d", (j < RTI_STATS_BUCKET_NUM - 1) ? 1 << (RTI_STATS_BUCKET_SHIFT + j) : -1,
+                           hist->bucket[j]);
+        }
+        rt_kprintf("\n");
+    }
+}
+
+void rti_stats_show(void)
+{
+    register rt_ubase_t temp;
+    struct rti_stats_thread *entry;
+    rt_uint64_t total = 0;
+    rt_uint32_t switches = 0, load, ms;
+    rt_uint8_t i;
+
+    temp = rt_hw_interrupt_disable();
+    if (stats.enable)
+        rti_stats_account(RTI_GET_TIMESTAMP());
+    rt_hw_interrupt_enable(temp);
+
+    for (i = 0; i <= RTI_STATS_THREAD_NUM; i++)
+    {
+        total += stats.thread[i].run;
+        switches += stats.thread[i].switches;
+    }
+    if (total == 0)
+    {
+        rt_kprintf("rti stats: nothing recorded\n");
+        return ;
+    }
+    ms = (rt_uint32_t)(total * 1000 / RTI_SYS_FREQ);
+    rt_kprintf("%d ms, %d switches/s\n", ms, (rt_uint32_t)((rt_uint64_t)switches * RTI_SYS_FREQ / total));
+
+    rt_kprintf("thread      load switches\n");
+    for (i = 0; i <= RTI_STATS_THREAD_NUM; i++)
+    {
+        entry = &stats.thread[i];
+        if (entry->run == 0 && entry->switches == 0)
+            continue;
+        load = (rt_uint32_t)(entry->run * 1000 / total);
+        rt_kprintf("%-8.*s %3d.%d%% %8d\n", RT_NAME_MAX, entry->head.name, load / 10, load % 10, entry->switches);
+    }
+    rti_stats_show_hist("isr", stats.isr, RTI_STATS_ISR_NUM);
+    rti_stats_show_hist("timer", stats.timer, RTI_STATS_TIMER_NUM);
+}
+
+#ifdef RT_USING_FINSH
+static void rti_stats(int argc, char **argv)
+{
+    if (argc > 1 && !rt_strcmp(argv[1], "start"))
+        rti_stats_start();
+    else if (argc > 1 && !rt_strcmp(argv[1], "stop"))
+        rti_stats_stop();
+    else if (argc > 1 && !rt_strcmp(argv[1], "reset"))
+        rti_stats_reset();
+    else
+        rti_stats_show();
+}
+MSH_CMD_EXPORT(rti_stats, rti statistics: rti_stats [start|stop|reset]);
+#endif
+
+#endif
@@ -0,0 +1,328 @@
+/*
+ * File      : rti_tcp.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#include "rti_tcp.h"
+
+#ifdef RTI_USING_TCP
+
+#ifndef RT_USING_SAL
+    #error "the rti tcp sink needs RT_USING_SAL"
+#endif
+
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#include <stdlib.h>
+#endif
+
+#ifndef closesocket
+    #define closesocket(s)  close(s)
+#endif
+
+#define TCP_HELLO_SIZE      4
+#define TCP_CMD_START       0x01
+#define TCP_CMD_STOP        0x02
+
+static struct
+{
+    int listen_fd;
+
+    /* the host, -1 while nobody is connected */
+    int fd;
+    rt_uint16_t port;
+    volatile rt_bool_t run;
+    rt_bool_t recording;
+
+    /* a send failed, the server thread closes the connection */
+    volatile rt_bool_t broken;
+
+    /* the first bytes of a connection, they may be the SystemView hello */
+    rt_uint8_t hello[TCP_HELLO_SIZE];
+    rt_uint8_t hello_len;
+
+    /* the rti thread and the server thread both send */
+    struct rt_mutex lock;
+    struct rt_semaphore exit;
+
+    /* since rti_tcp_start */
+    rt_uint32_t connections;
+    rt_uint32_t sends;
+    rt_uint32_t errors;
+    rt_uint64_t bytes;
+} tcp = {.listen_fd = -1, .fd = -1};
+
+static struct rt_thread tcp_thread;
+ALIGN(RT_ALIGN_SIZE) static rt_uint8_t tcp_stack[RTI_TCP_STACK_SIZE];
+
+/* send the rti buffer as it is, one send per piece of the ring */
+static void rti_tcp_send(void)
+{
+    struct rti_span span[2];
+    rt_uint8_t i, count;
+    int sent;
+
+    while (!tcp.broken && (count = rti_data_peek(span)) > 0)
+    {
+        for (i = 0; i < count; i++)
+        {
+            sent = send(tcp.fd, span[i].ptr, span[i].length, 0);
+            if (sent <= 0)
+            {
+                /* the rti thread would call us for ever */
+                rti_data_new_data_notify_set_hook(RT_NULL);
+                tcp.broken = RT_TRUE;
+                tcp.errors ++;
+                return ;
+            }
+            rti_data_commit(sent);
+            tcp.sends ++;
+            tcp.bytes += sent;
+            if ((rt_size_t)sent < span[i].length)
+                break;
+        }
+    }
+}
+
+/* called from the rti thread while the rti buffer is filling up */
+static void rti_tcp_notify(void)
+{
+    rt_mutex_take(&tcp.lock, RT_WAITING_FOREVER);
+    if (tcp.fd >= 0)
+        rti_tcp_send();
+    rt_mutex_release(&tcp.lock);
+}
+
+static void rti_tcp_record(rt_bool_t on)
+{
+    if (on == tcp.recording)
+        return ;
+    tcp.recording = on;
+
+    if (on)
+    {
+        rti_data_new_data_notify_set_hook(rti_tcp_notify);
+        rti_start();
+    }
+    else
+    {
+        /* rti_stop sends what is left through the notify hook */
+        rti_stop();
+        rti_data_new_data_notify_set_hook(RT_NULL);
+        rti_tcp_notify();
+    }
+}
+
+static void rti_tcp_close(void)
+{
+    rti_tcp_record(RT_FALSE);
+
+    rt_mutex_take(&tcp.lock, RT_WAITING_FOREVER);
+    closesocket(tcp.fd);
+    tcp.fd = -1;
+    tcp.broken = RT_FALSE;
+    rt_mutex_release(&tcp.lock);
+}
+
+static void rti_tcp_accept(void)
+{
+    int fd, on = 1;
+
+    fd = accept(tcp.listen_fd, RT_NULL, RT_NULL);
+    if (fd < 0)
+        return ;
+
+    /* a packet waits for nothing, the batches are large anyway */
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    tcp.hello_len = 0;
+    tcp.connections ++;
+    rt_mutex_take(&tcp.lock, RT_WAITING_FOREVER);
+    tcp.fd = fd;
+    rt_mutex_release(&tcp.lock);
+}
+
+/* the commands of the host, as rti_rx_entry handles them on the uart */
+static void rti_tcp_command(const rt_uint8_t *data, int length)
+{
+    int i;
+
+    for (i = 0; i < length; i++)
+    {
+        if (tcp.hello_len < TCP_HELLO_SIZE)
+        {
+            /* anything else than the hello is a command from the start */
+            if (tcp.hello_len > 0 || data[i] == 'S')
+            {
+                tcp.hello[tcp.hello_len++] = data[i];
+                if (tcp.hello_len == TCP_HELLO_SIZE && tcp.hello[1] == 'V')
+                    rti_tcp_record(RT_TRUE);
+                continue;
+            }
+            tcp.hello_len = TCP_HELLO_SIZE;
+        }
+
+        if (data[i] == TCP_CMD_START)
+            rti_tcp_record(RT_TRUE);
+        else if (data[i] == TCP_CMD_STOP)
+            rti_tcp_record(RT_FALSE);
+    }
+}
+
+/* wait for fd to be readable, 0 on timeout */
+static int rti_tcp_wait(int fd, rt_int32_t ms)
+{
+    struct timeval timeout;
+    fd_set rset;
+
+    FD_ZERO(&rset);
+    FD_SET(fd, &rset);
+    timeout.tv_sec = ms / 1000;
+    timeout.tv_usec = (ms % 1000) * 1000;
+    return select(fd + 1, &rset, RT_NULL, RT_NULL, &timeout);
+}
+
+static void rti_tcp_entry(void *parameter)
+{
+    rt_uint8_t buf[16];
+    int length;
+
+    while (tcp.run)
+    {
+        if (tcp.fd < 0)
+        {
+            if (rti_tcp_wait(tcp.listen_fd, 100) > 0)
+                rti_tcp_accept();
+            continue;
+        }
+
+        if (rti_tcp_wait(tcp.fd, RTI_TCP_FLUSH_MS) > 0)
+        {
+            length = recv(tcp.fd, buf, sizeof(buf), 0);
+            if (length <= 0)
+            {
+                rti_tcp_close();
+                continue;
+            }
+            rti_tcp_command(buf, length);
+        }
+
+        if (tcp.broken)
+            rti_tcp_close();
+        else if (tcp.recording)
+            rti_tcp_notify();
+    }
+
+    if (tcp.fd >= 0)
+        rti_tcp_close();
+    closesocket(tcp.listen_fd);
+    tcp.listen_fd = -1;
+    rt_sem_release(&tcp.exit);
+}
+
+rt_err_t rti_tcp_start(rt_uint16_t port)
+{
+    static rt_bool_t inited;
+    struct sockaddr_in addr;
+    int on = 1;
+
+    if (tcp.run)
+        return -RT_EBUSY;
+
+    if (!inited)
+    {
+        rt_mutex_init(&tcp.lock, "rti_tcp", RT_IPC_FLAG_FIFO);
+        rt_sem_init(&tcp.exit, "rti_tcp", 0, RT_IPC_FLAG_FIFO);
+        inited = RT_TRUE;
+    }
+
+    tcp.listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (tcp.listen_fd < 0)
+        return -RT_ERROR;
+    setsockopt(tcp.listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    rt_memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(tcp.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+            listen(tcp.listen_fd, 1) < 0)
+    {
+        closesocket(tcp.listen_fd);
+        tcp.listen_fd = -1;
+        return -RT_ERROR;
+    }
+
+    tcp.port = port;
+    tcp.connections = 0;
+    tcp.sends = 0;
+    tcp.errors = 0;
+    tcp.bytes = 0;
+    tcp.run = RT_TRUE;
+    rt_thread_init(&tcp_thread, "rti_tcp", rti_tcp_entry, RT_NULL,
+                   tcp_stack, sizeof(tcp_stack), RTI_TCP_THREAD_PRIORITY, 10);
+    rt_thread_startup(&tcp_thread);
+    return RT_EOK;
+}
+
+void rti_tcp_stop(void)
+{
+    if (!tcp.run)
+        return ;
+
+    /* the server thread stops the recording and closes the sockets */
+    tcp.run = RT_FALSE;
+    rt_sem_take(&tcp.exit, RT_WAITING_FOREVER);
+}
+
+void rti_tcp_show(void)
+{
+    rt_kprintf("%s on port %d, %s, %d connections\n", tcp.run ? "listening" : "stopped", tcp.port,
+               tcp.recording ? "recording" : (tcp.fd >= 0 ? "connected" : "idle"), tcp.connections);
+    rt_kprintf("%d bytes in %d sends, %d errors\n", (rt_uint32_t)tcp.bytes, tcp.sends, tcp.errors);
+}
+
+#ifdef RT_USING_FINSH
+static void rti_tcp(int argc, char **argv)
+{
+    rt_err_t result;
+
+    if (argc > 1 && !rt_strcmp(argv[1], "start"))
+    {
+        result = rti_tcp_start(argc > 2 ? atoi(argv[2]) : RTI_TCP_PORT);
+        if (result != RT_EOK)
+            rt_kprintf("rti_tcp: start failed %d\n", result);
+    }
+    else if (argc > 1 && !rt_strcmp(argv[1], "stop"))
+        rti_tcp_stop();
+    else
+        rti_tcp_show();
+}
+MSH_CMD_EXPORT(rti_tcp, live recording over tcp: rti_tcp [start [port]|stop]);
+#endif
+
+#endif
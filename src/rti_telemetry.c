@@ -0,0 +1,225 @@
+/*
+ * File      : stats.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+#include "rti_telemetry.h"
+#include "rti_ring.h"
+
+#ifdef RTI_USING_TELEMETRY
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#endif
+
+static struct rti_telemetry telemetry;
+
+#if RTI_TELEMETRY_PERIOD > 0
+static struct rt_timer telemetry_timer;
+static rt_uint32_t telemetry_values[5 + 3 * (RTI_TRACE_NUM + 1)];
+#endif
+
+static const char * const telemetry_names[RTI_TRACE_NUM + 1] =
+{
+    "sem", "mutex", "event", "mailbox", "queue", "thread", "scheduler", "interrupt", "timer", "heap", "mempool", "device", "other"
+};
+
+/* the event class of a packet */
+static rt_uint8_t rti_telemetry_class(rt_uint16_t rti_id)
+{
+    switch (rti_id)
+    {
+    case RTI_ID_ISR_ENTER:
+    case RTI_ID_ISR_EXIT:
+    case RTI_ID_ISR_TO_SCHEDULER:
+        return RTI_INTERRUPT_NUM;
+    case RTI_ID_THREAD_START_EXEC:
+    case RTI_ID_THREAD_STOP_EXEC:
+    case RTI_ID_THREAD_STOP_READY:
+    case RTI_ID_IDLE:
+        return RTI_SCHEDULER_NUM;
+    case RTI_ID_THREAD_START_READY:
+    case RTI_ID_THREAD_CREATE:
+    case RTI_ID_THREAD_INFO:
+    case RTI_ID_STACK_INFO:
+    case RTI_ID_THREAD_TERMINATE:
+        return RTI_THREAD_NUM;
+    case RTI_ID_TIMER_ENTER:
+    case RTI_ID_TIMER_EXIT:
+        return RTI_TIMER_NUM;
+    case RTI_ID_MALLOC:
+    case RTI_ID_FREE:
+        return RTI_HEAP_NUM;
+    case RTI_ID_MP_ALLOC:
+    case RTI_ID_MP_FREE:
+        return RTI_MEMPOOL_NUM;
+    case RTI_ID_DEVICE_ENTER:
+    case RTI_ID_DEVICE_EXIT:
+        return RTI_DEVICE_NUM;
+    default:
+        break;
+    }
+    /* ipc events are the object class base plus 1 to 3 */
+    if (rti_id > RTI_ID_SEM_BASE && rti_id <= RTI_ID_QUEUE_BASE + 3)
+        return (rti_id - RTI_ID_SEM_BASE - 1) / 10;
+    return RTI_TELEMETRY_OTHER;
+}
+
+void rti_telemetry_record(rt_uint16_t rti_id, rt_uint16_t length)
+{
+    rti_atomic_add(&telemetry.recorded[rti_telemetry_class(rti_id)], 1);
+    rti_atomic_add(&telemetry.recorded_bytes, length);
+}
+
+void rti_telemetry_drop(rt_uint16_t rti_id, rt_uint16_t length)
+{
+    rt_uint8_t index = rti_telemetry_class(rti_id);
+
+    rti_atomic_add(&telemetry.dropped[index], 1);
+    rti_atomic_add(&telemetry.dropped_bytes[index], length);
+}
+
+void rti_telemetry_end(rt_uint32_t start, rt_uint32_t used)
+{
+    rt_uint32_t high_water;
+
+    rti_atomic_add(&telemetry.record_cycles, RTI_GET_TIMESTAMP() - start);
+    do
+    {
+        high_water = telemetry.high_water;
+        if (used <= high_water)
+            break;
+    }
+    while (!RTI_ATOMIC_CAS(&telemetry.high_water, high_water, used));
+}
+
+/* the only consumer commits */
+void rti_telemetry_drain(rt_size_t length)
+{
+    telemetry.drained_bytes += length;
+}
+
+/* only one producer at a time resumes the thread */
+void rti_telemetry_wakeup(void)
+{
+    telemetry.wakeups++;
+}
+
+void rti_telemetry_get(struct rti_telemetry *result)
+{
+    *result = telemetry;
+    result->now = RTI_GET_TIMESTAMP();
+}
+
+void rti_telemetry_reset(void)
+{
+    register rt_ubase_t temp;
+
+    temp = rt_hw_interrupt_disable();
+    rt_memset(&telemetry, 0, sizeof(telemetry));
+    telemetry.since = RTI_GET_TIMESTAMP();
+    rt_hw_interrupt_enable(temp);
+}
+
+#if RTI_TELEMETRY_PERIOD > 0
+static void rti_telemetry_send(void *parameter)
+{
+    rt_uint32_t *values = telemetry_values;
+    rt_uint8_t i;
+
+    *values++ = telemetry.recorded_bytes;
+    *values++ = telemetry.drained_bytes;
+    *values++ = telemetry.high_water;
+    *values++ = telemetry.wakeups;
+    *values++ = telemetry.record_cycles;
+    for (i = 0; i <= RTI_TRACE_NUM; i++)
+    {
+        *values++ = telemetry.recorded[i];
+        *values++ = telemetry.dropped[i];
+        *values++ = telemetry.dropped_bytes[i];
+    }
+    /* dropped while rti does not record */
+    rti_record_values(RTI_ID_TELEMETRY, telemetry_values, values - telemetry_values);
+}
+#endif
+
+void rti_telemetry_init(void)
+{
+#if RTI_TELEMETRY_PERIOD > 0
+    rt_tick_t period = RTI_TELEMETRY_PERIOD;
+#endif
+
+    rti_telemetry_reset();
+#if RTI_TELEMETRY_PERIOD > 0
+    rt_timer_init(&telemetry_timer, "rti_tele", rti_telemetry_send, RT_NULL, period,
+                  RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_SOFT_TIMER);
+    rt_timer_start(&telemetry_timer);
+#endif
+}
+
+void rti_telemetry_show(void)
+{
+    struct rti_telemetry now;
+    rt_uint32_t ms, rate, packets = 0, cycles;
+    rt_uint8_t i;
+
+    rti_telemetry_get(&now);
+    ms = (rt_uint32_t)((rt_uint64_t)(now.now - now.since) * 1000 / RTI_SYS_FREQ);
+
+    rt_kprintf("class       recorded    dropped dropped bytes\n");
+    for (i = 0; i <= RTI_TRACE_NUM; i++)
+    {
+        if (now.recorded[i] == 0 && now.dropped[i] == 0)
+            continue;
+        rt_kprintf("%-10s %9d %10d %13d\n", telemetry_names[i], now.recorded[i], now.dropped[i],
+                   now.dropped_bytes[i]);
+    }
+    rt_kprintf("recorded %d bytes, drained %d bytes in %d ms\n", now.recorded_bytes, now.drained_bytes, ms);
+    if (ms > 0)
+    {
+        rate = (rt_uint32_t)((rt_uint64_t)now.drained_bytes * 1000 / ms);
+        rt_kprintf("drain rate %d bytes/s\n", rate);
+    }
+    rt_kprintf("buffer high water %d of %d bytes\n", now.high_water, RTI_BUFFER_SIZE);
+    rt_kprintf("rti thread wakeups %d\n", now.wakeups);
+    for (i = 0; i <= RTI_TRACE_NUM; i++)
+        packets += now.recorded[i];
+    if (packets > 0)
+    {
+        /* one decimal place, rt_kprintf has no floating point */
+        cycles = (rt_uint32_t)((rt_uint64_t)now.record_cycles * 10 / packets);
+        rt_kprintf("record %d.%d cycles/packet\n", cycles / 10, cycles % 10);
+    }
+}
+
+#ifdef RT_USING_FINSH
+static void rti_telemetry(int argc, char **argv)
+{
+    if (argc > 1 && !rt_strcmp(argv[1], "reset"))
+        rti_telemetry_reset();
+    else
+        rti_telemetry_show();
+}
+MSH_CMD_EXPORT(rti_telemetry, rti loss and backpressure counters: rti_telemetry [reset]);
+#endif
+
+#endif
@@ -0,0 +1,295 @@
+/*
+ * File      : stats.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+#include <stdlib.h>
+#include "rti_throttle.h"
+
+#ifdef RTI_USING_THROTTLE
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#endif
+
+#define THROTTLE_ISR_NEST   8
+
+struct rti_throttle_class
+{
+    /* an event costs cost cycles of credit, the credit grows with the time
+     * stamp up to limit. Without a rate the cost is 0. */
+    rt_uint32_t cost;
+    rt_uint32_t limit;
+    rt_uint32_t credit;
+    rt_uint32_t last;
+
+    /* keep one in sample */
+    rt_uint16_t sample;
+    rt_uint16_t count;
+
+    /* since the last report and since the limit was set */
+    rt_uint32_t passed;
+    rt_uint32_t dropped;
+    rt_uint32_t passed_total;
+    rt_uint32_t dropped_total;
+};
+
+static struct
+{
+    /* classes with a limit, the others pass untouched */
+    volatile rt_uint16_t flags;
+
+    struct rti_throttle_class classes[RTI_TRACE_NUM];
+
+    /* the exit follows the enter, by interrupt nest level and for timers
+     * run by the timer thread and in interrupts */
+    rt_uint8_t isr_dropped[THROTTLE_ISR_NEST];
+    rt_uint8_t timer_dropped[2];
+
+    struct rt_timer report;
+} throttle;
+
+static const char * const throttle_names[RTI_TRACE_NUM] =
+{
+    "sem", "mutex", "event", "mailbox", "queue", "thread", "scheduler", "interrupt", "timer", "heap", "mempool", "device"
+};
+
+/* call with interrupts disabled */
+static void rti_throttle_refill(struct rti_throttle_class *entry, rt_uint32_t now)
+{
+    rt_uint32_t elapsed = now - entry->last;
+
+    entry->last = now;
+    if (elapsed >= entry->limit - entry->credit)
+        entry->credit = entry->limit;
+    else
+        entry->credit += elapsed;
+}
+
+rt_bool_t rti_throttle_pass(rt_uint16_t flag)
+{
+    register rt_ubase_t temp;
+    struct rti_throttle_class *entry;
+    rt_bool_t pass = RT_TRUE;
+    rt_uint8_t i;
+
+    if (!(throttle.flags & flag))
+        return RT_TRUE;
+
+    for (i = 0; !(flag & (1 << i)); i++)
+        ;
+    entry = &throttle.classes[i];
+
+    temp = rt_hw_interrupt_disable();
+    if (entry->sample > 1 && ++entry->count < entry->sample)
+        pass = RT_FALSE;
+    else
+    {
+        entry->count = 0;
+        if (entry->cost > 0)
+        {
+            rti_throttle_refill(entry, RTI_GET_TIMESTAMP());
+            if (entry->credit >= entry->cost)
+                entry->credit -= entry->cost;
+            else
+                pass = RT_FALSE;
+        }
+    }
+    if (pass)
+        entry->passed++;
+    else
+        entry->dropped++;
+    rt_hw_interrupt_enable(temp);
+
+    return pass;
+}
+
+rt_bool_t rti_throttle_isr_enter(void)
+{
+    rt_uint8_t nest = rt_interrupt_get_nest();
+    rt_bool_t pass;
+
+    pass = rti_throttle_pass(RTI_INTERRUPT);
+    /* the kernel has counted this interrupt already */
+    if (nest > 0 && nest <= THROTTLE_ISR_NEST)
+        throttle.isr_dropped[nest - 1] = !pass;
+    return pass;
+}
+
+rt_bool_t rti_throttle_isr_leave(void)
+{
+    /* and has already uncounted it here */
+    rt_uint8_t nest = rt_interrupt_get_nest();
+
+    return nest >= THROTTLE_ISR_NEST || !throttle.isr_dropped[nest];
+}
+
+rt_bool_t rti_throttle_timer_enter(void)
+{
+    rt_bool_t pass;
+
+    pass = rti_throttle_pass(RTI_TIMER);
+    throttle.timer_dropped[rt_interrupt_get_nest() > 0] = !pass;
+    return pass;
+}
+
+rt_bool_t rti_throttle_timer_exit(void)
+{
+    return !throttle.timer_dropped[rt_interrupt_get_nest() > 0];
+}
+
+/* the counts of the period, also keeps the credit ahead of the time stamp wrap */
+static void rti_throttle_report(void *parameter)
+{
+    register rt_ubase_t temp;
+    struct rti_throttle_class *entry;
+    rt_uint32_t values[3 * RTI_TRACE_NUM];
+    rt_uint16_t count = 0;
+    rt_uint8_t i;
+
+    temp = rt_hw_interrupt_disable();
+    for (i = 0; i < RTI_TRACE_NUM; i++)
+    {
+        entry = &throttle.classes[i];
+        if (!(throttle.flags & (1 << i)))
+            continue;
+        if (entry->cost > 0)
+            rti_throttle_refill(entry, RTI_GET_TIMESTAMP());
+        if (entry->passed == 0 && entry->dropped == 0)
+            continue;
+        values[count++] = i;
+        values[count++] = entry->passed;
+        values[count++] = entry->dropped;
+        entry->passed_total += entry->passed;
+        entry->dropped_total += entry->dropped;
+        entry->passed = 0;
+        entry->dropped = 0;
+    }
+    rt_hw_interrupt_enable(temp);
+
+    /* dropped while rti does not record */
+    if (count > 0)
+        rti_record_values(RTI_ID_THROTTLE, values, count);
+}
+
+rt_err_t rti_throttle_set(rt_uint16_t flag, rt_uint32_t rate, rt_uint16_t burst, rt_uint16_t sample)
+{
+    static rt_bool_t inited = RT_FALSE;
+    register rt_ubase_t temp;
+    struct rti_throttle_class *entry;
+    rt_tick_t period = RTI_THROTTLE_PERIOD;
+    rt_uint32_t cost = 0, limit = 0;
+    rt_uint8_t i;
+
+    if (flag == 0 || (flag & ~RTI_THROTTLE_ALL))
+        return -RT_EINVAL;
+
+    if (rate > 0)
+    {
+        cost = RTI_SYS_FREQ / rate;
+        if (cost == 0)
+            cost = 1;
+        if (burst == 0)
+            burst = 1;
+        limit = (burst > 0xFFFFFFFFu / cost) ? 0xFFFFFFFFu : cost * burst;
+    }
+
+    temp = rt_hw_interrupt_disable();
+    for (i = 0; i < RTI_TRACE_NUM; i++)
+    {
+        if (!(flag & (1 << i)))
+            continue;
+        entry = &throttle.classes[i];
+        rt_memset(entry, 0, sizeof(*entry));
+        entry->cost   = cost;
+        entry->limit  = limit;
+        entry->credit = limit;
+        entry->last   = RTI_GET_TIMESTAMP();
+        entry->sample = sample;
+        if (rate > 0 || sample > 1)
+            throttle.flags |= (1 << i);
+        else
+            throttle.flags &= ~(1 << i);
+    }
+    rt_hw_interrupt_enable(temp);
+
+    if (!inited)
+    {
+        rt_timer_init(&throttle.report, "rti_thro", rti_throttle_report, RT_NULL, period,
+                      RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_SOFT_TIMER);
+        inited = RT_TRUE;
+    }
+    if (throttle.flags)
+        rt_timer_start(&throttle.report);
+    else
+        rt_timer_stop(&throttle.report);
+    return RT_EOK;
+}
+
+void rti_throttle_show(void)
+{
+    struct rti_throttle_class *entry;
+    rt_uint32_t rate;
+    rt_uint8_t i;
+
+    rt_kprintf("class        rate burst sample   recorded    dropped\n");
+    for (i = 0; i < RTI_TRACE_NUM; i++)
+    {
+        entry = &throttle.classes[i];
+        if (!(throttle.flags & (1 << i)))
+            continue;
+        rate = entry->cost ? RTI_SYS_FREQ / entry->cost : 0;
+        rt_kprintf("%-10s %6d %5d %6d %10d %10d\n", throttle_names[i], rate,
+                   entry->cost ? entry->limit / entry->cost : 0, entry->sample,
+                   entry->passed_total + entry->passed, entry->dropped_total + entry->dropped);
+    }
+}
+
+#ifdef RT_USING_FINSH
+static void rti_throttle(int argc, char **argv)
+{
+    rt_uint16_t flag = 0;
+    rt_uint8_t i;
+
+    if (argc < 3)
+    {
+        if (argc == 2)
+            rt_kprintf("usage: rti_throttle <class|all> <rate> [burst] [sample]\n");
+        rti_throttle_show();
+        return ;
+    }
+
+    if (!rt_strcmp(argv[1], "all"))
+        flag = RTI_THROTTLE_ALL;
+    for (i = 0; i < RTI_TRACE_NUM; i++)
+    {
+        if (!rt_strcmp(argv[1], throttle_names[i]))
+            flag = 1 << i;
+    }
+    if (rti_throttle_set(flag, atoi(argv[2]), argc > 3 ? atoi(argv[3]) : 0,
+                         argc > 4 ? atoi(argv[4]) : 0) != RT_EOK)
+        rt_kprintf("rti throttle: can not limit %s\n", argv[1]);
+}
+MSH_CMD_EXPORT(rti_throttle, rti rate limits: rti_throttle [class rate [burst] [sample]]);
+#endif
+
+#endif
@@ -0,0 +1,236 @@
+/*
+ * File      : rti_trigger.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+
+#include "rti_trigger.h"
+
+#ifdef RTI_USING_TRIGGER
+
+#define TRIGGER_IDLE        0
+#define TRIGGER_ARMED       1   /* recording the pre-trigger window */
+#define TRIGGER_FIRED       2   /* a condition fired, the post window starts with the next packet */
+#define TRIGGER_POST        3   /* recording the post-trigger window */
+#define TRIGGER_DONE        4   /* frozen, waiting for the rti thread to dump it */
+
+#define TRIGGER_ISR_NEST    8
+
+static struct
+{
+    volatile rt_uint32_t state;
+
+    /* ring index where the post-trigger window ends */
+    rt_uint32_t end;
+
+    struct rti_trigger_config config;
+    rt_mutex_t mutex;
+
+    /* time stamps of the interrupts in progress, by nest level */
+    rt_uint32_t isr_enter[TRIGGER_ISR_NEST];
+
+    /* last time the thread was scheduled in or out, or made ready */
+    volatile rt_uint32_t thread_seen;
+
+    volatile rt_uint32_t mutex_taken;
+    volatile rt_bool_t   mutex_held;
+} trigger;
+
+static void rti_trigger_fire(const char *reason)
+{
+    /* only the first condition fires */
+    if (!RTI_ATOMIC_CAS(&trigger.state, TRIGGER_ARMED, TRIGGER_FIRED))
+        return ;
+    /* mark the trigger point in the stream */
+    rti_print(reason);
+}
+
+static void rti_trigger_check(rt_uint32_t now)
+{
+    rt_thread_t thread = trigger.config.thread;
+
+    if ((trigger.config.conditions & RTI_TRIGGER_THREAD_STARVED) &&
+            thread != rt_thread_self() &&
+            (thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_READY &&
+            now - trigger.thread_seen > trigger.config.thread_cycles)
+    {
+        rti_trigger_fire("rti trigger: thread starved");
+    }
+
+    if ((trigger.config.conditions & RTI_TRIGGER_MUTEX_HELD) && trigger.mutex_held &&
+            now - trigger.mutex_taken > trigger.config.mutex_cycles)
+    {
+        rti_trigger_fire("rti trigger: mutex held");
+    }
+}
+
+rt_err_t rti_trigger_arm(const struct rti_trigger_config *config)
+{
+    rt_mutex_t mutex = RT_NULL;
+
+    /* at least half of the buffer stays for the events before the trigger */
+    if (config->output == RT_NULL || config->post_size > RTI_BUFFER_SIZE / 2)
+        return -RT_EINVAL;
+    if ((config->conditions & RTI_TRIGGER_THREAD_STARVED) && config->thread == RT_NULL)
+        return -RT_EINVAL;
+    if (config->conditions & RTI_TRIGGER_MUTEX_HELD)
+    {
+        mutex = (rt_mutex_t)rt_object_find(config->mutex, RT_Object_Class_Mutex);
+        if (mutex == RT_NULL)
+            return -RT_ERROR;
+    }
+
+    trigger.state = TRIGGER_IDLE;
+    trigger.config = *config;
+    trigger.mutex = mutex;
+    trigger.thread_seen = RTI_GET_TIMESTAMP();
+    trigger.mutex_taken = trigger.thread_seen;
+    trigger.mutex_held = (mutex != RT_NULL && mutex->owner != RT_NULL);
+
+    rti_policy_set(RTI_POLICY_OVERWRITE);
+    rti_start();
+    trigger.state = TRIGGER_ARMED;
+    return RT_EOK;
+}
+
+void rti_trigger_disarm(void)
+{
+    trigger.state = TRIGGER_IDLE;
+    rti_freeze();
+    rti_policy_set(RTI_POLICY_STREAM);
+}
+
+void rti_trigger(void)
+{
+    rti_trigger_fire("rti trigger: manual");
+}
+
+void rti_trigger_isr_enter(void)
+{
+    rt_uint8_t nest;
+
+    if (!(trigger.config.conditions & RTI_TRIGGER_ISR_LONG))
+        return ;
+    /* the kernel has counted this interrupt already */
+    nest = rt_interrupt_get_nest();
+    if (nest > 0 && nest <= TRIGGER_ISR_NEST)
+        trigger.isr_enter[nest - 1] = RTI_GET_TIMESTAMP();
+}
+
+void rti_trigger_isr_leave(void)
+{
+    rt_uint32_t now;
+    rt_uint8_t nest;
+
+    if (trigger.state != TRIGGER_ARMED)
+        return ;
+    now = RTI_GET_TIMESTAMP();
+    /* and has already uncounted it here */
+    nest = rt_interrupt_get_nest();
+    if ((trigger.config.conditions & RTI_TRIGGER_ISR_LONG) && nest < TRIGGER_ISR_NEST &&
+            now - trigger.isr_enter[nest] > trigger.config.isr_cycles)
+    {
+        rti_trigger_fire("rti trigger: isr long");
+    }
+    rti_trigger_check(now);
+}
+
+void rti_trigger_schedule(rt_thread_t from, rt_thread_t to)
+{
+    rt_uint32_t now;
+
+    if (trigger.state != TRIGGER_ARMED)
+        return ;
+    now = RTI_GET_TIMESTAMP();
+    if (from == trigger.config.thread || to == trigger.config.thread)
+        trigger.thread_seen = now;
+    rti_trigger_check(now);
+}
+
+void rti_trigger_resume(rt_thread_t thread)
+{
+    if (trigger.state == TRIGGER_ARMED && thread == trigger.config.thread)
+        trigger.thread_seen = RTI_GET_TIMESTAMP();
+}
+
+void rti_trigger_take(rt_object_t object)
+{
+    if (trigger.state != TRIGGER_ARMED || object != (rt_object_t)trigger.mutex)
+        return ;
+    /* a recursive take keeps the first time stamp */
+    if (!trigger.mutex_held)
+    {
+        trigger.mutex_taken = RTI_GET_TIMESTAMP();
+        trigger.mutex_held = RT_TRUE;
+    }
+}
+
+void rti_trigger_release(rt_object_t object)
+{
+    if (trigger.state != TRIGGER_ARMED || object != (rt_object_t)trigger.mutex)
+        return ;
+    /* the hook runs before the hold count drops */
+    if (trigger.mutex->hold > 1)
+        return ;
+    rti_trigger_check(RTI_GET_TIMESTAMP());
+    trigger.mutex_held = RT_FALSE;
+}
+
+/* called with the reserve index after every packet, true once the post-trigger window is recorded */
+rt_bool_t rti_trigger_post(rt_uint32_t index)
+{
+    switch (trigger.state)
+    {
+    case TRIGGER_FIRED:
+        trigger.end = index + trigger.config.post_size;
+        RTI_ATOMIC_CAS(&trigger.state, TRIGGER_FIRED, TRIGGER_POST);
+        break;
+    case TRIGGER_POST:
+        if ((rt_int32_t)(index - trigger.end) >= 0 &&
+                RTI_ATOMIC_CAS(&trigger.state, TRIGGER_POST, TRIGGER_DONE))
+        {
+            rti_freeze();
+            return RT_TRUE;
+        }
+        break;
+    default:
+        break;
+    }
+    return RT_FALSE;
+}
+
+rt_bool_t rti_trigger_pending(void)
+{
+    return trigger.state == TRIGGER_DONE;
+}
+
+/* called from the rti thread, the capture is one-shot */
+void rti_trigger_flush(void)
+{
+    if (trigger.state != TRIGGER_DONE)
+        return ;
+    rti_dump(trigger.config.output);
+    rti_policy_set(RTI_POLICY_STREAM);
+    trigger.state = TRIGGER_IDLE;
+}
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * File      : finsh.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __FINSH_H__
+#define __FINSH_H__
+
+#include <rtthread.h>
+
+/* the commands are collected in a section, rt_host_msh runs them */
+struct rt_host_cmd
+{
+    const char *name;
+    const char *desc;
+    void (*func)(int argc, char **argv);
+};
+
+#define MSH_CMD_EXPORT(command, desc)                                           \
+    RT_USED static const struct rt_host_cmd __rt_host_cmd_##command             \
+    SECTION("rt_host_cmd") ALIGN(sizeof(void *)) = {#command, #desc, (void (*)(int, char **))command}
+
+#endif
@@ -0,0 +1,1760 @@
+/*
+ * File      : rt_host.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+/*
+ * A small RT-Thread kernel on pthreads, enough to run the rti package and
+ * its samples on a Linux host. Every rt_thread is a pthread, and the thread
+ * that runs is the one holding host_lock: switching hands the lock over, so
+ * exactly one thread runs at a time like on a single core. The scheduler,
+ * the ipc and the hooks follow RT-Thread, without priority inheritance.
+ *
+ * Socket calls that block (select, accept, recv, send) are linked with
+ * --wrap and give the cpu to the other threads while they wait.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+#include <rtthread.h>
+#include <rthw.h>
+#include <finsh.h>
+
+#include "rt_host.h"
+
+#define HOST_HEAP_SIZE          (16 * 1024 * 1024)
+#define HOST_TIMER_PRIORITY     4
+#define HOST_TICK_VECTOR        15
+#define HOST_NEVER              (~(rt_uint64_t)0)
+
+struct rt_host_thread
+{
+    pthread_t       tid;
+    pthread_cond_t  cond;
+    rt_uint64_t     timeout;             /* nanoseconds, 0 when the thread waits without timeout */
+    rt_base_t       level;               /* interrupt mask while it is switched out */
+};
+
+struct host_mem
+{
+    rt_size_t size;
+    rt_size_t reserved;
+};
+
+static pthread_mutex_t host_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct timespec host_start;
+
+static rt_thread_t host_current;
+static rt_list_t host_ready[RT_THREAD_PRIORITY_MAX];
+static rt_uint8_t host_nest;
+static rt_uint16_t host_critical;
+static rt_base_t host_level;
+static rt_bool_t host_need_schedule;
+static rt_bool_t host_switching;
+static int host_vector;
+
+/* the earliest interrupt, thread timeout or timer, HOST_NEVER when there is none */
+static rt_uint64_t host_due = HOST_NEVER;
+static rt_list_t host_irq_list;
+static rt_list_t host_timer_list;
+static rt_list_t host_soft_list;
+
+static struct rt_object_information host_info[RT_Object_Class_Unknown];
+
+static struct rt_thread host_main;
+static struct rt_thread host_idle;
+static struct rt_thread host_timer;
+
+static rt_size_t host_mem_used;
+static rt_size_t host_mem_max;
+
+static void (*host_attach_hook)(struct rt_object *object);
+static void (*host_detach_hook)(struct rt_object *object);
+static void (*host_trytake_hook)(struct rt_object *object);
+static void (*host_take_hook)(struct rt_object *object);
+static void (*host_put_hook)(struct rt_object *object);
+static void (*host_suspend_hook)(rt_thread_t thread);
+static void (*host_resume_hook)(rt_thread_t thread);
+static void (*host_inited_hook)(rt_thread_t thread);
+static void (*host_idle_hook)(void);
+static void (*host_scheduler_hook)(rt_thread_t from, rt_thread_t to);
+static void (*host_isr_enter_hook)(void);
+static void (*host_isr_leave_hook)(void);
+static void (*host_timer_enter_hook)(struct rt_timer *timer);
+static void (*host_timer_exit_hook)(struct rt_timer *timer);
+static void (*host_malloc_hook)(void *ptr, rt_size_t size);
+static void (*host_free_hook)(void *ptr);
+static void (*host_mp_alloc_hook)(struct rt_mempool *mp, void *block);
+static void (*host_mp_free_hook)(struct rt_mempool *mp, void *block);
+
+extern const struct rt_host_init __start_rt_host_init[] __attribute__((weak));
+extern const struct rt_host_init __stop_rt_host_init[] __attribute__((weak));
+extern const struct rt_host_cmd __start_rt_host_cmd[] __attribute__((weak));
+extern const struct rt_host_cmd __stop_rt_host_cmd[] __attribute__((weak));
+
+static void host_poll(void);
+
+/*
+ * clock
+ */
+
+rt_uint64_t rt_host_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (rt_uint64_t)(now.tv_sec - host_start.tv_sec) * 1000000000ULL + now.tv_nsec - host_start.tv_nsec;
+}
+
+rt_uint32_t rt_host_clock(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (rt_uint32_t)((rt_uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+static rt_uint64_t host_tick_ns(rt_tick_t tick)
+{
+    return (rt_uint64_t)tick * (1000000000ULL / RT_TICK_PER_SECOND);
+}
+
+rt_tick_t rt_tick_get(void)
+{
+    return (rt_tick_t)(rt_host_now() / host_tick_ns(1));
+}
+
+rt_tick_t rt_tick_from_millisecond(rt_int32_t ms)
+{
+    return (rt_tick_t)ms * RT_TICK_PER_SECOND / 1000;
+}
+
+int rt_host_isr_id(void)
+{
+    return host_vector;
+}
+
+static void host_due_at(rt_uint64_t due)
+{
+    if (due < host_due)
+        host_due = due;
+}
+
+/*
+ * object
+ */
+
+struct rt_object_information *rt_object_get_information(enum rt_object_class_type type)
+{
+    if (type >= RT_Object_Class_Unknown)
+        return RT_NULL;
+    return &host_info[type];
+}
+
+void rt_object_init(struct rt_object *object, enum rt_object_class_type type, const char *name)
+{
+    struct rt_object_information *info = rt_object_get_information(type);
+
+    object->type = type | RT_Object_Class_Static;
+    object->flag = 0;
+    rt_strncpy(object->name, name, RT_NAME_MAX);
+    RT_OBJECT_HOOK_CALL(host_attach_hook, (object));
+    rt_list_insert_before(&info->object_list, &object->list);
+}
+
+void rt_object_detach(rt_object_t object)
+{
+    RT_OBJECT_HOOK_CALL(host_detach_hook, (object));
+    object->type = 0;
+    rt_list_remove(&object->list);
+}
+
+rt_object_t rt_object_find(const char *name, rt_uint8_t type)
+{
+    struct rt_object_information *info = rt_object_get_information((enum rt_object_class_type)type);
+    rt_list_t *node;
+
+    if (info == RT_NULL || name == RT_NULL)
+        return RT_NULL;
+    for (node = info->object_list.next; node != &info->object_list; node = node->next)
+    {
+        rt_object_t object = rt_list_entry(node, struct rt_object, list);
+
+        if (rt_strncmp(object->name, name, RT_NAME_MAX) == 0)
+            return object;
+    }
+    return RT_NULL;
+}
+
+void rt_object_attach_sethook(void (*hook)(struct rt_object *object))
+{
+    host_attach_hook = hook;
+}
+
+void rt_object_detach_sethook(void (*hook)(struct rt_object *object))
+{
+    host_detach_hook = hook;
+}
+
+void rt_object_trytake_sethook(void (*hook)(struct rt_object *object))
+{
+    host_trytake_hook = hook;
+}
+
+void rt_object_take_sethook(void (*hook)(struct rt_object *object))
+{
+    host_take_hook = hook;
+}
+
+void rt_object_put_sethook(void (*hook)(struct rt_object *object))
+{
+    host_put_hook = hook;
+}
+
+/*
+ * scheduler
+ */
+
+static rt_thread_t host_highest(void)
+{
+    int priority;
+
+    for (priority = 0; priority < RT_THREAD_PRIORITY_MAX; priority++)
+    {
+        if (!rt_list_isempty(&host_ready[priority]))
+            return rt_list_entry(host_ready[priority].next, struct rt_thread, tlist);
+    }
+    return RT_NULL;
+}
+
+static void host_insert(rt_thread_t thread)
+{
+    thread->stat = RT_THREAD_READY;
+    rt_list_insert_before(&host_ready[thread->current_priority], &thread->tlist);
+}
+
+/* make to the current thread, the caller runs again once it is current again */
+static void host_handover(rt_thread_t to)
+{
+    rt_thread_t from = host_current;
+
+    from->host->level = host_level;
+    host_current = to;
+    host_switching = RT_TRUE;
+    RT_OBJECT_HOOK_CALL(host_scheduler_hook, (from, to));
+    host_switching = RT_FALSE;
+    pthread_cond_signal(&to->host->cond);
+}
+
+static void host_wait_current(rt_thread_t self)
+{
+    while (host_current != self)
+        pthread_cond_wait(&self->host->cond, &host_lock);
+    host_level = self->host->level;
+}
+
+void rt_schedule(void)
+{
+    rt_thread_t from = host_current, to;
+
+    if (host_nest > 0 || host_critical > 0 || host_switching)
+    {
+        host_need_schedule = RT_TRUE;
+        return ;
+    }
+    host_need_schedule = RT_FALSE;
+
+    to = host_highest();
+    if (to == RT_NULL || to == from)
+        return ;
+
+    host_handover(to);
+    if ((from->stat & RT_THREAD_STAT_MASK) != RT_THREAD_CLOSE)
+        host_wait_current(from);
+}
+
+void rt_enter_critical(void)
+{
+    host_critical++;
+}
+
+void rt_exit_critical(void)
+{
+    RT_ASSERT(host_critical > 0);
+    if (--host_critical == 0 && host_need_schedule)
+        rt_schedule();
+}
+
+rt_uint16_t rt_critical_level(void)
+{
+    return host_critical;
+}
+
+void rt_scheduler_sethook(void (*hook)(rt_thread_t from, rt_thread_t to))
+{
+    host_scheduler_hook = hook;
+}
+
+/*
+ * interrupt
+ */
+
+rt_base_t rt_hw_interrupt_disable(void)
+{
+    rt_base_t level = host_level;
+
+    host_level = 1;
+    return level;
+}
+
+void rt_hw_interrupt_enable(rt_base_t level)
+{
+    host_level = level;
+}
+
+void rt_interrupt_enter(void)
+{
+    host_nest++;
+    RT_OBJECT_HOOK_CALL(host_isr_enter_hook, ());
+}
+
+void rt_interrupt_leave(void)
+{
+    host_nest--;
+    RT_OBJECT_HOOK_CALL(host_isr_leave_hook, ());
+}
+
+rt_uint8_t rt_interrupt_get_nest(void)
+{
+    return host_nest;
+}
+
+void rt_interrupt_enter_sethook(void (*hook)(void))
+{
+    host_isr_enter_hook = hook;
+}
+
+void rt_interrupt_leave_sethook(void (*hook)(void))
+{
+    host_isr_leave_hook = hook;
+}
+
+void rt_host_irq_raise(struct rt_host_irq *irq, rt_uint64_t due)
+{
+    rt_list_t *node;
+
+    irq->due = due;
+    for (node = host_irq_list.next; node != &host_irq_list; node = node->next)
+    {
+        if (rt_list_entry(node, struct rt_host_irq, list)->due > due)
+            break;
+    }
+    rt_list_insert_before(node, &irq->list);
+    host_due_at(due);
+}
+
+void rt_host_irq_cancel(struct rt_host_irq *irq)
+{
+    rt_list_remove(&irq->list);
+}
+
+/*
+ * thread
+ */
+
+static void host_resume(rt_thread_t thread, rt_err_t error)
+{
+    rt_list_remove(&thread->tlist);
+    thread->host->timeout = 0;
+    thread->error = error;
+    host_insert(thread);
+}
+
+/* block the current thread on list, or only for time when list is RT_NULL */
+static rt_err_t host_block(rt_list_t *list, rt_int32_t time)
+{
+    rt_thread_t self = host_current;
+
+    RT_ASSERT(host_nest == 0);
+    RT_ASSERT(host_critical == 0);
+
+    rt_list_remove(&self->tlist);
+    self->stat = RT_THREAD_SUSPEND;
+    self->error = RT_EOK;
+    RT_OBJECT_HOOK_CALL(host_suspend_hook, (self));
+    if (list != RT_NULL)
+        rt_list_insert_before(list, &self->tlist);
+    if (time > 0)
+    {
+        self->host->timeout = rt_host_now() + host_tick_ns(time);
+        host_due_at(self->host->timeout);
+    }
+    rt_schedule();
+    return self->error;
+}
+
+/* wake the first thread waiting on list, return it */
+static rt_thread_t host_wake(rt_list_t *list)
+{
+    rt_thread_t thread;
+
+    if (rt_list_isempty(list))
+        return RT_NULL;
+    thread = rt_list_entry(list->next, struct rt_thread, tlist);
+    host_resume(thread, RT_EOK);
+    RT_OBJECT_HOOK_CALL(host_resume_hook, (thread));
+    return thread;
+}
+
+static void host_exit(void)
+{
+    rt_thread_t self = host_current;
+
+    rt_thread_detach(self);
+    host_handover(host_highest());
+    pthread_mutex_unlock(&host_lock);
+    pthread_exit(RT_NULL);
+}
+
+static void *host_thread_entry(void *parameter)
+{
+    rt_thread_t thread = parameter;
+
+    pthread_mutex_lock(&host_lock);
+    host_wait_current(thread);
+    ((void (*)(void *))thread->entry)(thread->parameter);
+    host_exit();
+    return RT_NULL;
+}
+
+rt_err_t rt_thread_init(struct rt_thread *thread, const char *name,
+                        void (*entry)(void *parameter), void *parameter,
+                        void *stack_start, rt_uint32_t stack_size,
+                        rt_uint8_t priority, rt_uint32_t tick)
+{
+    pthread_condattr_t attr;
+
+    RT_ASSERT(priority < RT_THREAD_PRIORITY_MAX);
+
+    rt_object_init((rt_object_t)thread, RT_Object_Class_Thread, name);
+    rt_list_init(&thread->tlist);
+    thread->entry = (void *)entry;
+    thread->parameter = parameter;
+    thread->stack_addr = stack_start;
+    thread->stack_size = stack_size;
+    /* the pthread runs on its own stack, this one stays as filled */
+    if (stack_start != RT_NULL)
+        rt_memset(stack_start, '#', stack_size);
+    thread->sp = (char *)stack_start + stack_size;
+    thread->error = RT_EOK;
+    thread->stat = RT_THREAD_INIT;
+    thread->current_priority = priority;
+    thread->init_priority = priority;
+    thread->event_set = 0;
+    thread->event_info = 0;
+    thread->init_tick = tick;
+    thread->remaining_tick = tick;
+    thread->cleanup = RT_NULL;
+    thread->user_data = 0;
+
+    thread->host = calloc(1, sizeof(struct rt_host_thread));
+    RT_ASSERT(thread->host != RT_NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&thread->host->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    RT_OBJECT_HOOK_CALL(host_inited_hook, (thread));
+    return RT_EOK;
+}
+
+rt_thread_t rt_thread_create(const char *name, void (*entry)(void *parameter), void *parameter,
+                             rt_uint32_t stack_size, rt_uint8_t priority, rt_uint32_t tick)
+{
+    rt_thread_t thread;
+    void *stack;
+
+    thread = rt_malloc(sizeof(struct rt_thread));
+    stack = rt_malloc(stack_size);
+    if (thread == RT_NULL || stack == RT_NULL)
+    {
+        rt_free(thread);
+        rt_free(stack);
+        return RT_NULL;
+    }
+    rt_thread_init(thread, name, entry, parameter, stack, stack_size, priority, tick);
+    return thread;
+}
+
+/* the pthread of a closed thread that is not the caller stays parked */
+rt_err_t rt_thread_detach(rt_thread_t thread)
+{
+    rt_list_remove(&thread->tlist);
+    thread->host->timeout = 0;
+    thread->stat = RT_THREAD_CLOSE;
+    rt_object_detach((rt_object_t)thread);
+    return RT_EOK;
+}
+
+rt_err_t rt_thread_delete(rt_thread_t thread)
+{
+    return rt_thread_detach(thread);
+}
+
+rt_thread_t rt_thread_self(void)
+{
+    return host_current;
+}
+
+rt_thread_t rt_thread_find(char *name)
+{
+    return (rt_thread_t)rt_object_find(name, RT_Object_Class_Thread);
+}
+
+rt_err_t rt_thread_startup(rt_thread_t thread)
+{
+    pthread_attr_t attr;
+
+    RT_ASSERT((thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_INIT);
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&thread->host->tid, &attr, host_thread_entry, thread) != 0)
+    {
+        pthread_attr_destroy(&attr);
+        return -RT_ERROR;
+    }
+    pthread_attr_destroy(&attr);
+
+    thread->stat = RT_THREAD_SUSPEND;
+    rt_thread_resume(thread);
+    if (host_current != RT_NULL)
+        rt_schedule();
+    return RT_EOK;
+}
+
+rt_err_t rt_thread_yield(void)
+{
+    rt_thread_t self = host_current;
+
+    host_poll();
+    rt_list_remove(&self->tlist);
+    host_insert(self);
+    rt_schedule();
+    return RT_EOK;
+}
+
+rt_err_t rt_thread_delay(rt_tick_t tick)
+{
+    host_poll();
+    if (tick == 0)
+        return rt_thread_yield();
+    host_block(RT_NULL, tick);
+    return RT_EOK;
+}
+
+rt_err_t rt_thread_mdelay(rt_int32_t ms)
+{
+    return rt_thread_delay(rt_tick_from_millisecond(ms));
+}
+
+rt_err_t rt_thread_suspend(rt_thread_t thread)
+{
+    if ((thread->stat & RT_THREAD_STAT_MASK) != RT_THREAD_READY)
+        return -RT_ERROR;
+
+    rt_list_remove(&thread->tlist);
+    thread->stat = RT_THREAD_SUSPEND;
+    thread->host->timeout = 0;
+    RT_OBJECT_HOOK_CALL(host_suspend_hook, (thread));
+    return RT_EOK;
+}
+
+rt_err_t rt_thread_resume(rt_thread_t thread)
+{
+    if ((thread->stat & RT_THREAD_STAT_MASK) != RT_THREAD_SUSPEND)
+        return -RT_ERROR;
+
+    host_resume(thread, thread->error);
+    RT_OBJECT_HOOK_CALL(host_resume_hook, (thread));
+    return RT_EOK;
+}
+
+rt_thread_t rt_thread_idle_gethandler(void)
+{
+    return &host_idle;
+}
+
+void rt_thread_suspend_sethook(void (*hook)(rt_thread_t thread))
+{
+    host_suspend_hook = hook;
+}
+
+void rt_thread_resume_sethook(void (*hook)(rt_thread_t thread))
+{
+    host_resume_hook = hook;
+}
+
+void rt_thread_inited_sethook(void (*hook)(rt_thread_t thread))
+{
+    host_inited_hook = hook;
+}
+
+rt_err_t rt_thread_idle_sethook(void (*hook)(void))
+{
+    host_idle_hook = hook;
+    return RT_EOK;
+}
+
+/*
+ * timer
+ */
+
+void rt_timer_init(rt_timer_t timer, const char *name, void (*timeout)(void *parameter),
+                   void *parameter, rt_tick_t time, rt_uint8_t flag)
+{
+    rt_object_init(&timer->parent, RT_Object_Class_Timer, name);
+    timer->parent.flag = flag & ~RT_TIMER_FLAG_ACTIVATED;
+    timer->timeout_func = timeout;
+    timer->parameter = parameter;
+    timer->init_tick = time;
+    timer->timeout_tick = 0;
+    rt_list_init(&timer->row[0]);
+}
+
+rt_err_t rt_timer_detach(rt_timer_t timer)
+{
+    rt_timer_stop(timer);
+    rt_object_detach(&timer->parent);
+    return RT_EOK;
+}
+
+rt_err_t rt_timer_start(rt_timer_t timer)
+{
+    rt_list_remove(&timer->row[0]);
+    timer->timeout_tick = rt_tick_get() + timer->init_tick;
+    timer->parent.flag |= RT_TIMER_FLAG_ACTIVATED;
+    rt_list_insert_before(&host_timer_list, &timer->row[0]);
+    host_due_at(host_tick_ns(timer->timeout_tick));
+    return RT_EOK;
+}
+
+rt_err_t rt_timer_stop(rt_timer_t timer)
+{
+    if (!(timer->parent.flag & RT_TIMER_FLAG_ACTIVATED))
+        return -RT_ERROR;
+
+    rt_list_remove(&timer->row[0]);
+    timer->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
+    return RT_EOK;
+}
+
+static void host_timer_run(rt_timer_t timer)
+{
+    rt_list_remove(&timer->row[0]);
+    if (timer->parent.flag & RT_TIMER_FLAG_PERIODIC)
+    {
+        timer->timeout_tick += timer->init_tick ? timer->init_tick : 1;
+        rt_list_insert_before(&host_timer_list, &timer->row[0]);
+        host_due_at(host_tick_ns(timer->timeout_tick));
+    }
+    else
+    {
+        timer->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
+    }
+
+    RT_OBJECT_HOOK_CALL(host_timer_enter_hook, (timer));
+    timer->timeout_func(timer->parameter);
+    RT_OBJECT_HOOK_CALL(host_timer_exit_hook, (timer));
+}
+
+/* run the expired hard timers, queue the soft ones for the timer thread */
+static void host_timer_check(rt_tick_t now)
+{
+    rt_list_t *node, *next;
+
+    for (node = host_timer_list.next; node != &host_timer_list; node = next)
+    {
+        rt_timer_t timer = rt_list_entry(node, struct rt_timer, row[0]);
+
+        next = node->next;
+        if ((rt_int32_t)(now - timer->timeout_tick) < 0)
+            continue;
+        if (timer->parent.flag & RT_TIMER_FLAG_SOFT_TIMER)
+        {
+            rt_list_remove(&timer->row[0]);
+            rt_list_insert_before(&host_soft_list, &timer->row[0]);
+        }
+        else
+        {
+            host_timer_run(timer);
+            /* the callback may have changed the list */
+            next = host_timer_list.next;
+        }
+    }
+    if (!rt_list_isempty(&host_soft_list))
+        rt_thread_resume(&host_timer);
+}
+
+void rt_timer_check(void)
+{
+    host_timer_check(rt_tick_get());
+}
+
+static void host_timer_entry(void *parameter)
+{
+    while (1)
+    {
+        while (!rt_list_isempty(&host_soft_list))
+            host_timer_run(rt_list_entry(host_soft_list.next, struct rt_timer, row[0]));
+
+        rt_thread_suspend(&host_timer);
+        rt_schedule();
+    }
+}
+
+void rt_timer_enter_sethook(void (*hook)(struct rt_timer *timer))
+{
+    host_timer_enter_hook = hook;
+}
+
+void rt_timer_exit_sethook(void (*hook)(struct rt_timer *timer))
+{
+    host_timer_exit_hook = hook;
+}
+
+/*
+ * the simulated interrupts: devices, thread timeouts and timers
+ */
+
+static rt_uint64_t host_next_due(void)
+{
+    struct rt_object_information *info = &host_info[RT_Object_Class_Thread];
+    rt_uint64_t due = HOST_NEVER;
+    rt_list_t *node;
+
+    if (!rt_list_isempty(&host_irq_list))
+        due = rt_list_entry(host_irq_list.next, struct rt_host_irq, list)->due;
+    for (node = info->object_list.next; node != &info->object_list; node = node->next)
+    {
+        rt_thread_t thread = rt_list_entry(node, struct rt_thread, list);
+
+        if (thread->host->timeout != 0 && thread->host->timeout < due)
+            due = thread->host->timeout;
+    }
+    for (node = host_timer_list.next; node != &host_timer_list; node = node->next)
+    {
+        rt_timer_t timer = rt_list_entry(node, struct rt_timer, row[0]);
+
+        if (host_tick_ns(timer->timeout_tick) < due)
+            due = host_tick_ns(timer->timeout_tick);
+    }
+    return due;
+}
+
+static void host_tick(rt_uint64_t now)
+{
+    struct rt_object_information *info = &host_info[RT_Object_Class_Thread];
+    rt_list_t *node;
+
+    for (node = info->object_list.next; node != &info->object_list; node = node->next)
+    {
+        rt_thread_t thread = rt_list_entry(node, struct rt_thread, list);
+
+        if (thread->host->timeout != 0 && thread->host->timeout <= now)
+        {
+            host_resume(thread, -RT_ETIMEOUT);
+            host_need_schedule = RT_TRUE;
+        }
+    }
+    host_timer_check((rt_tick_t)(now / host_tick_ns(1)));
+}
+
+/* dispatch what is due, called where an interrupt could preempt the thread */
+static void host_poll(void)
+{
+    rt_uint64_t now;
+    int vector;
+
+    if (host_nest > 0 || host_level != 0 || host_switching || host_current == RT_NULL)
+        return ;
+    now = rt_host_now();
+    if (now < host_due)
+        return ;
+
+    while (!rt_list_isempty(&host_irq_list))
+    {
+        struct rt_host_irq *irq = rt_list_entry(host_irq_list.next, struct rt_host_irq, list);
+
+        if (irq->due > now)
+            break;
+        rt_list_remove(&irq->list);
+
+        vector = host_vector;
+        host_vector = irq->vector;
+        rt_interrupt_enter();
+        irq->handler(irq);
+        rt_interrupt_leave();
+        host_vector = vector;
+    }
+
+    host_due = host_next_due();
+    if (host_due <= now)
+    {
+        vector = host_vector;
+        host_vector = HOST_TICK_VECTOR;
+        rt_interrupt_enter();
+        host_tick(now);
+        rt_interrupt_leave();
+        host_vector = vector;
+        host_due = host_next_due();
+    }
+
+    if (host_need_schedule)
+        rt_schedule();
+}
+
+static void host_idle_entry(void *parameter)
+{
+    struct timespec until;
+    rt_uint64_t due;
+
+    while (1)
+    {
+        RT_OBJECT_HOOK_CALL(host_idle_hook, ());
+        host_poll();
+        rt_schedule();
+        if (host_current != &host_idle || host_need_schedule)
+            continue;
+
+        /* nothing to run, sleep until the next deadline or a socket call returns */
+        due = host_due;
+        if (due == HOST_NEVER)
+        {
+            pthread_cond_wait(&host_idle.host->cond, &host_lock);
+            continue;
+        }
+        due += (rt_uint64_t)host_start.tv_sec * 1000000000ULL + host_start.tv_nsec;
+        until.tv_sec = due / 1000000000ULL;
+        until.tv_nsec = due % 1000000000ULL;
+        pthread_cond_timedwait(&host_idle.host->cond, &host_lock, &until);
+    }
+}
+
+/*
+ * ipc
+ */
+
+static void host_ipc_init(struct rt_ipc_object *ipc, enum rt_object_class_type type, const char *name)
+{
+    rt_object_init(&ipc->parent, type, name);
+    rt_list_init(&ipc->suspend_thread);
+}
+
+/* wake the waiters with an error, before the object goes away */
+static void host_ipc_detach(struct rt_ipc_object *ipc)
+{
+    while (!rt_list_isempty(&ipc->suspend_thread))
+        host_resume(rt_list_entry(ipc->suspend_thread.next, struct rt_thread, tlist), -RT_ERROR);
+    rt_object_detach(&ipc->parent);
+    rt_schedule();
+}
+
+rt_err_t rt_sem_init(rt_sem_t sem, const char *name, rt_uint32_t value, rt_uint8_t flag)
+{
+    host_ipc_init(&sem->parent, RT_Object_Class_Semaphore, name);
+    sem->value = (rt_uint16_t)value;
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_detach(rt_sem_t sem)
+{
+    host_ipc_detach(&sem->parent);
+    return RT_EOK;
+}
+
+rt_sem_t rt_sem_create(const char *name, rt_uint32_t value, rt_uint8_t flag)
+{
+    rt_sem_t sem = rt_malloc(sizeof(struct rt_semaphore));
+
+    if (sem != RT_NULL)
+        rt_sem_init(sem, name, value, flag);
+    return sem;
+}
+
+rt_err_t rt_sem_delete(rt_sem_t sem)
+{
+    rt_sem_detach(sem);
+    rt_free(sem);
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_take(rt_sem_t sem, rt_int32_t time)
+{
+    rt_err_t result;
+
+    host_poll();
+    RT_OBJECT_HOOK_CALL(host_trytake_hook, (&sem->parent.parent));
+    if (sem->value > 0)
+    {
+        sem->value--;
+    }
+    else
+    {
+        if (time == 0)
+            return -RT_ETIMEOUT;
+        /* the releasing thread hands the count over */
+        result = host_block(&sem->parent.suspend_thread, time);
+        if (result != RT_EOK)
+            return result;
+    }
+    RT_OBJECT_HOOK_CALL(host_take_hook, (&sem->parent.parent));
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_trytake(rt_sem_t sem)
+{
+    return rt_sem_take(sem, 0);
+}
+
+rt_err_t rt_sem_release(rt_sem_t sem)
+{
+    host_poll();
+    RT_OBJECT_HOOK_CALL(host_put_hook, (&sem->parent.parent));
+    if (host_wake(&sem->parent.suspend_thread) == RT_NULL)
+    {
+        if (sem->value == 0xFFFF)
+            return -RT_EFULL;
+        sem->value++;
+        return RT_EOK;
+    }
+    rt_schedule();
+    return RT_EOK;
+}
+
+rt_err_t rt_mutex_init(rt_mutex_t mutex, const char *name, rt_uint8_t flag)
+{
+    host_ipc_init(&mutex->parent, RT_Object_Class_Mutex, name);
+    mutex->value = 1;
+    mutex->owner = RT_NULL;
+    mutex->original_priority = 0xFF;
+    mutex->hold = 0;
+    return RT_EOK;
+}
+
+rt_err_t rt_mutex_detach(rt_mutex_t mutex)
+{
+    host_ipc_detach(&mutex->parent);
+    return RT_EOK;
+}
+
+rt_mutex_t rt_mutex_create(const char *name, rt_uint8_t flag)
+{
+    rt_mutex_t mutex = rt_malloc(sizeof(struct rt_mutex));
+
+    if (mutex != RT_NULL)
+        rt_mutex_init(mutex, name, flag);
+    return mutex;
+}
+
+rt_err_t rt_mutex_delete(rt_mutex_t mutex)
+{
+    rt_mutex_detach(mutex);
+    rt_free(mutex);
+    return RT_EOK;
+}
+
+rt_err_t rt_mutex_take(rt_mutex_t mutex, rt_int32_t time)
+{
+    rt_thread_t self = host_current;
+    rt_err_t result;
+
+    RT_ASSERT(host_nest == 0);
+
+    host_poll();
+    RT_OBJECT_HOOK_CALL(host_trytake_hook, (&mutex->parent.parent));
+    if (mutex->owner == self)
+    {
+        mutex->hold++;
+    }
+    else if (mutex->value > 0)
+    {
+        mutex->value--;
+        mutex->owner = self;
+        mutex->original_priority = self->current_priority;
+        mutex->hold = 1;
+    }
+    else
+    {
+        if (time == 0)
+            return -RT_ETIMEOUT;
+        /* the releasing thread makes this one the owner */
+        result = host_block(&mutex->parent.suspend_thread, time);
+        if (result != RT_EOK)
+            return result;
+    }
+    RT_OBJECT_HOOK_CALL(host_take_hook, (&mutex->parent.parent));
+    return RT_EOK;
+}
+
+rt_err_t rt_mutex_release(rt_mutex_t mutex)
+{
+    rt_thread_t owner;
+
+    host_poll();
+    if (mutex->owner != host_current)
+        return -RT_ERROR;
+
+    RT_OBJECT_HOOK_CALL(host_put_hook, (&mutex->parent.parent));
+    if (--mutex->hold > 0)
+        return RT_EOK;
+
+    owner = host_wake(&mutex->parent.suspend_thread);
+    if (owner == RT_NULL)
+    {
+        mutex->owner = RT_NULL;
+        mutex->original_priority = 0xFF;
+        mutex->value++;
+        return RT_EOK;
+    }
+    mutex->owner = owner;
+    mutex->original_priority = owner->current_priority;
+    mutex->hold = 1;
+    rt_schedule();
+    return RT_EOK;
+}
+
+rt_err_t rt_event_init(rt_event_t event, const char *name, rt_uint8_t flag)
+{
+    host_ipc_init(&event->parent, RT_Object_Class_Event, name);
+    event->set = 0;
+    return RT_EOK;
+}
+
+rt_err_t rt_event_detach(rt_event_t event)
+{
+    host_ipc_detach(&event->parent);
+    return RT_EOK;
+}
+
+static rt_uint32_t host_event_match(rt_uint32_t set, rt_uint32_t want, rt_uint8_t option)
+{
+    if (option & RT_EVENT_FLAG_AND)
+        return (set & want) == want ? want : 0;
+    return set & want;
+}
+
+rt_err_t rt_event_send(rt_event_t event, rt_uint32_t set)
+{
+    rt_list_t *node, *next;
+    rt_bool_t woken = RT_FALSE;
+
+    host_poll();
+    RT_OBJECT_HOOK_CALL(host_put_hook, (&event->parent.parent));
+    event->set |= set;
+    for (node = event->parent.suspend_thread.next; node != &event->parent.suspend_thread; node = next)
+    {
+        rt_thread_t thread = rt_list_entry(node, struct rt_thread, tlist);
+        rt_uint32_t match = host_event_match(event->set, thread->event_set, thread->event_info);
+
+        next = node->next;
+        if (match == 0)
+            continue;
+        thread->event_set = match;
+        if (thread->event_info & RT_EVENT_FLAG_CLEAR)
+            event->set &= ~match;
+        host_resume(thread, RT_EOK);
+        RT_OBJECT_HOOK_CALL(host_resume_hook, (thread));
+        woken = RT_TRUE;
+    }
+    if (woken)
+        rt_schedule();
+    return RT_EOK;
+}
+
+rt_err_t rt_event_recv(rt_event_t event, rt_uint32_t set, rt_uint8_t option,
+                       rt_int32_t timeout, rt_uint32_t *recved)
+{
+    rt_thread_t self = host_current;
+    rt_uint32_t match;
+    rt_err_t result;
+
+    host_poll();
+    RT_OBJECT_HOOK_CALL(host_trytake_hook, (&event->parent.parent));
+    match = host_event_match(event->set, set, option);
+    if (match != 0)
+    {
+        if (option & RT_EVENT_FLAG_CLEAR)
+            event->set &= ~match;
+    }
+    else
+    {
+        if (timeout == 0)
+            return -RT_ETIMEOUT;
+        self->event_set = set;
+        self->event_info = option;
+        result = host_block(&event->parent.suspend_thread, timeout);
+        if (result != RT_EOK)
+            return result;
+        match = self->event_set;
+    }
+    if (recved != RT_NULL)
+        *recved = match;
+    RT_OBJECT_HOOK_CALL(host_take_hook, (&event->parent.parent));
+    return RT_EOK;
+}
+
+rt_err_t rt_mb_init(rt_mailbox_t mb, const char *name, void *msgpool, rt_size_t size, rt_uint8_t flag)
+{
+    host_ipc_init(&mb->parent, RT_Object_Class_MailBox, name);
+    mb->msg_pool = msgpool;
+    mb->size = (rt_uint16_t)size;
+    mb->entry = 0;
+    mb->in_offset = 0;
+    mb->out_offset = 0;
+    rt_list_init(&mb->suspend_sender_thread);
+    return RT_EOK;
+}
+
+rt_err_t rt_mb_detach(rt_mailbox_t mb)
+{
+    host_ipc_detach(&mb->parent);
+    return RT_EOK;
+}
+
+rt_err_t rt_mb_send(rt_mailbox_t mb, rt_ubase_t value)
+{
+    host_poll();
+    RT_OBJECT_HOOK_CALL(host_put_hook, (&mb->parent.parent));
+    if (mb->entry == mb->size)
+        return -RT_EFULL;
+
+    mb->msg_pool[mb->in_offset] = value;
+    mb->in_offset = (mb->in_offset + 1) % mb->size;
+    mb->entry++;
+    if (host_wake(&mb->parent.suspend_thread) != RT_NULL)
+        rt_schedule();
+    return RT_EOK;
+}
+
+rt_err_t rt_mb_recv(rt_mailbox_t mb, rt_ubase_t *value, rt_int32_t timeout)
+{
+    rt_err_t result;
+
+    host_poll();
+    RT_OBJECT_HOOK_CALL(host_trytake_hook, (&mb->parent.parent));
+    while (mb->entry == 0)
+    {
+        if (timeout == 0)
+            return -RT_ETIMEOUT;
+        result = host_block(&mb->parent.suspend_thread, timeout);
+        if (result != RT_EOK)
+            return result;
+    }
+
+    *value = mb->msg_pool[mb->out_offset];
+    mb->out_offset = (mb->out_offset + 1) % mb->size;
+    mb->entry--;
+    RT_OBJECT_HOOK_CALL(host_take_hook, (&mb->parent.parent));
+    return RT_EOK;
+}
+
+rt_err_t rt_mq_init(rt_mq_t mq, const char *name, void *msgpool, rt_size_t msg_size,
+                    rt_size_t pool_size, rt_uint8_t flag)
+{
+    host_ipc_init(&mq->parent, RT_Object_Class_MessageQueue, name);
+    mq->msg_pool = msgpool;
+    mq->msg_size = (rt_uint16_t)RT_ALIGN(msg_size, RT_ALIGN_SIZE);
+    mq->max_msgs = (rt_uint16_t)(pool_size / mq->msg_size);
+    mq->entry = 0;
+    mq->in_offset = 0;
+    mq->out_offset = 0;
+    rt_list_init(&mq->suspend_sender_thread);
+    return RT_EOK;
+}
+
+rt_err_t rt_mq_detach(rt_mq_t mq)
+{
+    host_ipc_detach(&mq->parent);
+    return RT_EOK;
+}
+
+rt_err_t rt_mq_send(rt_mq_t mq, const void *buffer, rt_size_t size)
+{
+    host_poll();
+    if (size > mq->msg_size)
+        return -RT_ERROR;
+    RT_OBJECT_HOOK_CALL(host_put_hook, (&mq->parent.parent));
+    if (mq->entry == mq->max_msgs)
+        return -RT_EFULL;
+
+    rt_memcpy((rt_uint8_t *)mq->msg_pool + mq->in_offset * mq->msg_size, buffer, size);
+    mq->in_offset = (mq->in_offset + 1) % mq->max_msgs;
+    mq->entry++;
+    if (host_wake(&mq->parent.suspend_thread) != RT_NULL)
+        rt_schedule();
+    return RT_EOK;
+}
+
+rt_err_t rt_mq_recv(rt_mq_t mq, void *buffer, rt_size_t size, rt_int32_t timeout)
+{
+    rt_err_t result;
+
+    host_poll();
+    RT_OBJECT_HOOK_CALL(host_trytake_hook, (&mq->parent.parent));
+    while (mq->entry == 0)
+    {
+        if (timeout == 0)
+            return -RT_ETIMEOUT;
+        result = host_block(&mq->parent.suspend_thread, timeout);
+        if (result != RT_EOK)
+            return result;
+    }
+
+    if (size > mq->msg_size)
+        size = mq->msg_size;
+    rt_memcpy(buffer, (rt_uint8_t *)mq->msg_pool + mq->out_offset * mq->msg_size, size);
+    mq->out_offset = (mq->out_offset + 1) % mq->max_msgs;
+    mq->entry--;
+    RT_OBJECT_HOOK_CALL(host_take_hook, (&mq->parent.parent));
+    return RT_EOK;
+}
+
+/*
+ * memory pool, the word before a block links the free list and holds the pool
+ * of a used block, like the kernel
+ */
+
+rt_err_t rt_mp_init(struct rt_mempool *mp, const char *name, void *start, rt_size_t size, rt_size_t block_size)
+{
+    rt_uint8_t *block;
+    rt_size_t i;
+
+    rt_object_init(&mp->parent, RT_Object_Class_MemPool, name);
+    mp->start_address = start;
+    mp->size = RT_ALIGN_DOWN(size, RT_ALIGN_SIZE);
+    mp->block_size = RT_ALIGN(block_size, RT_ALIGN_SIZE);
+    mp->block_total_count = mp->size / (mp->block_size + sizeof(rt_uint8_t *));
+    mp->block_free_count = mp->block_total_count;
+    rt_list_init(&mp->suspend_thread);
+
+    /* link the blocks back to front, the first one is the head */
+    mp->block_list = RT_NULL;
+    for (i = mp->block_total_count; i > 0; i--)
+    {
+        block = (rt_uint8_t *)start + (i - 1) * (mp->block_size + sizeof(rt_uint8_t *));
+        *(rt_uint8_t **)block = mp->block_list;
+        mp->block_list = block;
+    }
+    return RT_EOK;
+}
+
+rt_err_t rt_mp_detach(struct rt_mempool *mp)
+{
+    while (!rt_list_isempty(&mp->suspend_thread))
+        host_resume(rt_list_entry(mp->suspend_thread.next, struct rt_thread, tlist), -RT_ERROR);
+    rt_object_detach(&mp->parent);
+    rt_schedule();
+    return RT_EOK;
+}
+
+void *rt_mp_alloc(rt_mp_t mp, rt_int32_t time)
+{
+    rt_uint8_t *block;
+
+    host_poll();
+    while (mp->block_free_count == 0)
+    {
+        if (time == 0 || host_block(&mp->suspend_thread, time) != RT_EOK)
+            return RT_NULL;
+    }
+
+    block = mp->block_list;
+    mp->block_list = *(rt_uint8_t **)block;
+    mp->block_free_count--;
+    *(rt_uint8_t **)block = (rt_uint8_t *)mp;
+    RT_OBJECT_HOOK_CALL(host_mp_alloc_hook, (mp, block + sizeof(rt_uint8_t *)));
+    return block + sizeof(rt_uint8_t *);
+}
+
+void rt_mp_free(void *block)
+{
+    rt_uint8_t *header = (rt_uint8_t *)block - sizeof(rt_uint8_t *);
+    struct rt_mempool *mp = *(struct rt_mempool **)header;
+
+    host_poll();
+    RT_OBJECT_HOOK_CALL(host_mp_free_hook, (mp, block));
+    *(rt_uint8_t **)header = mp->block_list;
+    mp->block_list = header;
+    mp->block_free_count++;
+    if (host_wake(&mp->suspend_thread) != RT_NULL)
+        rt_schedule();
+}
+
+void rt_mp_alloc_sethook(void (*hook)(struct rt_mempool *mp, void *block))
+{
+    host_mp_alloc_hook = hook;
+}
+
+void rt_mp_free_sethook(void (*hook)(struct rt_mempool *mp, void *block))
+{
+    host_mp_free_hook = hook;
+}
+
+/*
+ * memory, the blocks carry their size for rt_memory_info
+ */
+
+void *rt_malloc(rt_size_t size)
+{
+    struct host_mem *mem;
+
+    host_poll();
+    mem = malloc(sizeof(struct host_mem) + size);
+    if (mem == RT_NULL)
+        return RT_NULL;
+    mem->size = size;
+    host_mem_used += size;
+    if (host_mem_used > host_mem_max)
+        host_mem_max = host_mem_used;
+    RT_OBJECT_HOOK_CALL(host_malloc_hook, ((void *)(mem + 1), size));
+    return mem + 1;
+}
+
+void rt_free(void *rmem)
+{
+    struct host_mem *mem = (struct host_mem *)rmem - 1;
+
+    if (rmem == RT_NULL)
+        return ;
+    RT_OBJECT_HOOK_CALL(host_free_hook, (rmem));
+    host_mem_used -= mem->size;
+    free(mem);
+}
+
+void *rt_realloc(void *rmem, rt_size_t newsize)
+{
+    void *mem = rt_malloc(newsize);
+
+    if (mem != RT_NULL && rmem != RT_NULL)
+    {
+        rt_size_t size = ((struct host_mem *)rmem - 1)->size;
+
+        rt_memcpy(mem, rmem, size < newsize ? size : newsize);
+        rt_free(rmem);
+    }
+    return mem;
+}
+
+void *rt_calloc(rt_size_t count, rt_size_t size)
+{
+    void *mem = rt_malloc(count * size);
+
+    if (mem != RT_NULL)
+        rt_memset(mem, 0, count * size);
+    return mem;
+}
+
+void rt_memory_info(rt_size_t *total, rt_size_t *used, rt_size_t *max_used)
+{
+    if (total != RT_NULL)
+        *total = HOST_HEAP_SIZE;
+    if (used != RT_NULL)
+        *used = host_mem_used;
+    if (max_used != RT_NULL)
+        *max_used = host_mem_max;
+}
+
+void rt_malloc_sethook(void (*hook)(void *ptr, rt_size_t size))
+{
+    host_malloc_hook = hook;
+}
+
+void rt_free_sethook(void (*hook)(void *ptr))
+{
+    host_free_hook = hook;
+}
+
+/*
+ * device
+ */
+
+#ifdef RT_USING_DEVICE_OPS
+#define device_init     (dev->ops->init)
+#define device_open     (dev->ops->open)
+#define device_close    (dev->ops->close)
+#define device_read     (dev->ops->read)
+#define device_write    (dev->ops->write)
+#define device_control  (dev->ops->control)
+#else
+#define device_init     (dev->init)
+#define device_open     (dev->open)
+#define device_close    (dev->close)
+#define device_read     (dev->read)
+#define device_write    (dev->write)
+#define device_control  (dev->control)
+#endif
+
+rt_device_t rt_device_find(const char *name)
+{
+    return (rt_device_t)rt_object_find(name, RT_Object_Class_Device);
+}
+
+rt_err_t rt_device_register(rt_device_t dev, const char *name, rt_uint16_t flags)
+{
+    if (rt_device_find(name) != RT_NULL)
+        return -RT_ERROR;
+
+    rt_object_init(&dev->parent, RT_Object_Class_Device, name);
+    dev->flag = flags;
+    dev->ref_count = 0;
+    dev->open_flag = 0;
+    return RT_EOK;
+}
+
+rt_err_t rt_device_unregister(rt_device_t dev)
+{
+    rt_object_detach(&dev->parent);
+    return RT_EOK;
+}
+
+rt_err_t rt_device_set_rx_indicate(rt_device_t dev, rt_err_t (*rx_ind)(rt_device_t dev, rt_size_t size))
+{
+    dev->rx_indicate = rx_ind;
+    return RT_EOK;
+}
+
+rt_err_t rt_device_set_tx_complete(rt_device_t dev, rt_err_t (*tx_done)(rt_device_t dev, void *buffer))
+{
+    dev->tx_complete = tx_done;
+    return RT_EOK;
+}
+
+rt_err_t rt_device_init(rt_device_t dev)
+{
+    rt_err_t result = RT_EOK;
+
+    if (!(dev->flag & RT_DEVICE_FLAG_ACTIVATED) && device_init != RT_NULL)
+        result = device_init(dev);
+    if (result == RT_EOK)
+        dev->flag |= RT_DEVICE_FLAG_ACTIVATED;
+    return result;
+}
+
+rt_err_t rt_device_open(rt_device_t dev, rt_uint16_t oflag)
+{
+    rt_err_t result;
+
+    result = rt_device_init(dev);
+    if (result != RT_EOK)
+        return result;
+    if (!(dev->open_flag & RT_DEVICE_OFLAG_OPEN) && device_open != RT_NULL)
+        result = device_open(dev, oflag);
+    if (result == RT_EOK || result == -RT_ENOSYS)
+    {
+        dev->open_flag = oflag | RT_DEVICE_OFLAG_OPEN;
+        dev->ref_count++;
+        result = RT_EOK;
+    }
+    return result;
+}
+
+rt_err_t rt_device_close(rt_device_t dev)
+{
+    rt_err_t result = RT_EOK;
+
+    if (dev->ref_count == 0)
+        return -RT_ERROR;
+    if (--dev->ref_count > 0)
+        return RT_EOK;
+    if (device_close != RT_NULL)
+        result = device_close(dev);
+    if (result == RT_EOK || result == -RT_ENOSYS)
+        dev->open_flag = RT_DEVICE_OFLAG_CLOSE;
+    return result;
+}
+
+rt_size_t rt_device_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    host_poll();
+    if (device_read == RT_NULL)
+        return 0;
+    return device_read(dev, pos, buffer, size);
+}
+
+rt_size_t rt_device_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    host_poll();
+    if (device_write == RT_NULL)
+        return 0;
+    return device_write(dev, pos, buffer, size);
+}
+
+rt_err_t rt_device_control(rt_device_t dev, int cmd, void *arg)
+{
+    host_poll();
+    if (device_control == RT_NULL)
+        return -RT_ENOSYS;
+    return device_control(dev, cmd, arg);
+}
+
+/*
+ * kernel service
+ */
+
+void rt_kprintf(const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+    fflush(stdout);
+}
+
+rt_int32_t rt_vsnprintf(char *buf, rt_size_t size, const char *fmt, va_list args)
+{
+    return vsnprintf(buf, size, fmt, args);
+}
+
+rt_int32_t rt_snprintf(char *buf, rt_size_t size, const char *fmt, ...)
+{
+    va_list args;
+    rt_int32_t n;
+
+    va_start(args, fmt);
+    n = vsnprintf(buf, size, fmt, args);
+    va_end(args);
+    return n;
+}
+
+void *rt_memset(void *src, int c, rt_ubase_t n)
+{
+    return memset(src, c, n);
+}
+
+void *rt_memcpy(void *dst, const void *src, rt_ubase_t count)
+{
+    return memcpy(dst, src, count);
+}
+
+rt_int32_t rt_memcmp(const void *cs, const void *ct, rt_ubase_t count)
+{
+    return memcmp(cs, ct, count);
+}
+
+char *rt_strncpy(char *dst, const char *src, rt_ubase_t n)
+{
+    char *d = dst;
+
+    /* pads with zeros like strncpy, names fill all RT_NAME_MAX bytes */
+    while (n > 0 && *src != '\0')
+    {
+        *d++ = *src++;
+        n--;
+    }
+    while (n-- > 0)
+        *d++ = '\0';
+    return dst;
+}
+
+rt_int32_t rt_strncmp(const char *cs, const char *ct, rt_ubase_t count)
+{
+    return strncmp(cs, ct, count);
+}
+
+rt_int32_t rt_strcmp(const char *cs, const char *ct)
+{
+    return strcmp(cs, ct);
+}
+
+rt_size_t rt_strlen(const char *src)
+{
+    return strlen(src);
+}
+
+void rt_host_assert(const char *ex, const char *func, rt_size_t line)
+{
+    fprintf(stderr, "(%s) assertion failed at function:%s, line number:%d\n", ex, func, (int)line);
+    abort();
+}
+
+/*
+ * blocking socket calls, the thread gives up the cpu while it waits
+ */
+
+static rt_thread_t host_call_enter(void)
+{
+    rt_thread_t self = host_current;
+
+    if (self == RT_NULL || host_nest > 0)
+        return RT_NULL;
+
+    rt_list_remove(&self->tlist);
+    self->stat = RT_THREAD_SUSPEND;
+    RT_OBJECT_HOOK_CALL(host_suspend_hook, (self));
+    host_handover(host_highest());
+    pthread_mutex_unlock(&host_lock);
+    return self;
+}
+
+static void host_call_leave(rt_thread_t self)
+{
+    if (self == RT_NULL)
+        return ;
+
+    pthread_mutex_lock(&host_lock);
+    host_insert(self);
+    RT_OBJECT_HOOK_CALL(host_resume_hook, (self));
+    host_need_schedule = RT_TRUE;
+    /* the idle thread may be sleeping */
+    pthread_cond_signal(&host_current->host->cond);
+    host_wait_current(self);
+}
+
+int __real_select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds, struct timeval *timeout);
+int __real_accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen);
+ssize_t __real_recv(int sockfd, void *buf, size_t len, int flags);
+ssize_t __real_send(int sockfd, const void *buf, size_t len, int flags);
+
+int __wrap_select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds, struct timeval *timeout)
+{
+    rt_thread_t self = host_call_enter();
+    int result, error;
+
+    result = __real_select(nfds, readfds, writefds, exceptfds, timeout);
+    error = errno;
+    host_call_leave(self);
+    errno = error;
+    return result;
+}
+
+int __wrap_accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen)
+{
+    rt_thread_t self = host_call_enter();
+    int result, error;
+
+    result = __real_accept(sockfd, addr, addrlen);
+    error = errno;
+    host_call_leave(self);
+    errno = error;
+    return result;
+}
+
+ssize_t __wrap_recv(int sockfd, void *buf, size_t len, int flags)
+{
+    rt_thread_t self = host_call_enter();
+    ssize_t result;
+    int error;
+
+    result = __real_recv(sockfd, buf, len, flags);
+    error = errno;
+    host_call_leave(self);
+    errno = error;
+    return result;
+}
+
+ssize_t __wrap_send(int sockfd, const void *buf, size_t len, int flags)
+{
+    rt_thread_t self = host_call_enter();
+    ssize_t result;
+    int error;
+
+    result = __real_send(sockfd, buf, len, flags | MSG_NOSIGNAL);
+    error = errno;
+    host_call_leave(self);
+    errno = error;
+    return result;
+}
+
+/*
+ * startup and shell
+ */
+
+rt_err_t rt_host_msh(int argc, char **argv)
+{
+    const struct rt_host_cmd *cmd;
+
+    for (cmd = __start_rt_host_cmd; cmd < __stop_rt_host_cmd; cmd++)
+    {
+        if (strcmp(cmd->name, argv[0]) == 0)
+        {
+            cmd->func(argc, argv);
+            return RT_EOK;
+        }
+    }
+    if (strcmp(argv[0], "help") == 0)
+    {
+        for (cmd = __start_rt_host_cmd; cmd < __stop_rt_host_cmd; cmd++)
+            rt_kprintf("%-16s - %s\n", cmd->name, cmd->desc);
+        return RT_EOK;
+    }
+    return -RT_ENOSYS;
+}
+
+void rt_host_startup(void)
+{
+    const struct rt_host_init *init;
+    char level;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &host_start);
+    for (i = 0; i < RT_THREAD_PRIORITY_MAX; i++)
+        rt_list_init(&host_ready[i]);
+    for (i = 0; i < RT_Object_Class_Unknown; i++)
+    {
+        host_info[i].type = (enum rt_object_class_type)i;
+        rt_list_init(&host_info[i].object_list);
+    }
+    rt_list_init(&host_irq_list);
+    rt_list_init(&host_timer_list);
+    rt_list_init(&host_soft_list);
+
+    pthread_mutex_lock(&host_lock);
+
+    /* the caller goes on as the main thread */
+    rt_thread_init(&host_main, "main", RT_NULL, RT_NULL, RT_NULL, 0, RT_MAIN_THREAD_PRIORITY, 20);
+    host_main.host->tid = pthread_self();
+    host_insert(&host_main);
+    host_current = &host_main;
+
+    rt_thread_init(&host_idle, "tidle", host_idle_entry, RT_NULL, RT_NULL, 0, RT_THREAD_PRIORITY_MAX - 1, 32);
+    rt_thread_startup(&host_idle);
+    rt_thread_init(&host_timer, "timer", host_timer_entry, RT_NULL, RT_NULL, 0, HOST_TIMER_PRIORITY, 10);
+    rt_thread_startup(&host_timer);
+
+    for (level = '1'; level <= '6'; level++)
+    {
+        for (init = __start_rt_host_init; init < __stop_rt_host_init; init++)
+        {
+            if (init->level[0] == level)
+                init->fn();
+        }
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * File      : rt_host.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RT_HOST_H__
+#define __RT_HOST_H__
+
+#include <rtthread.h>
+
+/*
+ * The host kernel runs every rt_thread on its own pthread, one at a time:
+ * a thread runs until it blocks, yields or a higher priority thread becomes
+ * ready at a kernel call. Interrupts are simulated, they are dispatched at
+ * the next kernel call after they are due and in the idle thread.
+ */
+
+/* a simulated interrupt, raised once at the given time */
+struct rt_host_irq
+{
+    rt_list_t   list;
+    rt_uint64_t due;                     /* nanoseconds since rt_host_startup */
+    int         vector;                  /* RTI_GET_ISR_ID() while it runs */
+
+    void (*handler)(struct rt_host_irq *irq);
+};
+
+/* turn the calling thread into the main thread and run the init exports */
+void rt_host_startup(void);
+
+/* nanoseconds since rt_host_startup */
+rt_uint64_t rt_host_now(void);
+
+void rt_host_irq_raise(struct rt_host_irq *irq, rt_uint64_t due);
+void rt_host_irq_cancel(struct rt_host_irq *irq);
+
+/* run a command exported with MSH_CMD_EXPORT, -RT_ENOSYS if there is none */
+rt_err_t rt_host_msh(int argc, char **argv);
+
+/* a uart with tx dma at baud bits per second, what it sends goes to the
+ * file at path, created when the device is opened */
+rt_err_t rt_host_uart_register(const char *name, rt_uint32_t baud, const char *path);
+
+#endif
@@ -0,0 +1,179 @@
+/*
+ * File      : rt_host_uart.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+/*
+ * A uart with tx dma on the host kernel. Writes are queued like the
+ * serial framework does it and sent one after the other at the baud
+ * rate, ten bits a byte. The line reads the data from the buffer of the
+ * write when the transfer is over, so a caller that reuses the buffer
+ * before the tx complete callback sends garbage, as on a real dma. What
+ * is sent goes to a file that is created when the device is opened.
+ */
+
+#include <stdio.h>
+
+#include <rtthread.h>
+#include <rthw.h>
+
+#include "rt_host.h"
+
+#define UART_QUEUE_NUM          8
+#define UART_VECTOR             37
+
+struct host_uart
+{
+    struct rt_device   parent;
+    struct rt_host_irq irq;
+
+    rt_uint32_t baud;
+    const char *path;
+    FILE       *fp;
+
+    /* the writes in the driver, the first one is on the line */
+    struct
+    {
+        const rt_uint8_t *ptr;
+        rt_size_t length;
+    } queue[UART_QUEUE_NUM];
+    rt_uint8_t  head;
+    rt_uint8_t  count;
+};
+
+static rt_uint64_t host_uart_time(struct host_uart *uart, rt_size_t length)
+{
+    return (rt_uint64_t)length * 10 * 1000000000ULL / uart->baud;
+}
+
+/* the transfer on the line is done */
+static void host_uart_done(struct rt_host_irq *irq)
+{
+    struct host_uart *uart = rt_container_of(irq, struct host_uart, irq);
+    const rt_uint8_t *ptr;
+
+    ptr = uart->queue[uart->head].ptr;
+    if (uart->fp != NULL)
+        fwrite(ptr, 1, uart->queue[uart->head].length, uart->fp);
+    uart->head = (uart->head + 1) % UART_QUEUE_NUM;
+    uart->count--;
+    if (uart->count > 0)
+        rt_host_irq_raise(&uart->irq, rt_host_now() + host_uart_time(uart, uart->queue[uart->head].length));
+
+    if (uart->parent.tx_complete != RT_NULL)
+        uart->parent.tx_complete(&uart->parent, (void *)ptr);
+}
+
+static rt_err_t host_uart_open(rt_device_t dev, rt_uint16_t oflag)
+{
+    struct host_uart *uart = (struct host_uart *)dev;
+
+    uart->fp = fopen(uart->path, "wb");
+    if (uart->fp == NULL)
+    {
+        perror(uart->path);
+        return -RT_EIO;
+    }
+    uart->head = 0;
+    uart->count = 0;
+    return RT_EOK;
+}
+
+static rt_err_t host_uart_close(rt_device_t dev)
+{
+    struct host_uart *uart = (struct host_uart *)dev;
+    rt_base_t level;
+
+    /* the transfers on the way are lost, a driver would cut them off */
+    level = rt_hw_interrupt_disable();
+    if (uart->count > 0)
+    {
+        rt_kprintf("%s: closed with %d transfers on the line\n", dev->parent.name, uart->count);
+        rt_host_irq_cancel(&uart->irq);
+    }
+    uart->count = 0;
+    rt_hw_interrupt_enable(level);
+
+    fclose(uart->fp);
+    uart->fp = NULL;
+    return RT_EOK;
+}
+
+static rt_size_t host_uart_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    struct host_uart *uart = (struct host_uart *)dev;
+    rt_base_t level;
+
+    if (!(dev->open_flag & RT_DEVICE_FLAG_DMA_TX))
+    {
+        /* polled, the bytes are out when we return */
+        fwrite(buffer, 1, size, uart->fp);
+        return size;
+    }
+
+    level = rt_hw_interrupt_disable();
+    if (uart->count == UART_QUEUE_NUM)
+    {
+        rt_hw_interrupt_enable(level);
+        return 0;
+    }
+    uart->queue[(uart->head + uart->count) % UART_QUEUE_NUM].ptr = buffer;
+    uart->queue[(uart->head + uart->count) % UART_QUEUE_NUM].length = size;
+    uart->count++;
+    if (uart->count == 1)
+        rt_host_irq_raise(&uart->irq, rt_host_now() + host_uart_time(uart, size));
+    rt_hw_interrupt_enable(level);
+    return size;
+}
+
+#ifdef RT_USING_DEVICE_OPS
+static const struct rt_device_ops host_uart_ops =
+{
+    RT_NULL,
+    host_uart_open,
+    host_uart_close,
+    RT_NULL,
+    host_uart_write,
+    RT_NULL,
+};
+#endif
+
+rt_err_t rt_host_uart_register(const char *name, rt_uint32_t baud, const char *path)
+{
+    struct host_uart *uart;
+
+    uart = rt_calloc(1, sizeof(struct host_uart));
+    if (uart == RT_NULL)
+        return -RT_ENOMEM;
+    uart->baud = baud;
+    uart->path = path;
+    uart->irq.vector = UART_VECTOR;
+    uart->irq.handler = host_uart_done;
+#ifdef RT_USING_DEVICE_OPS
+    uart->parent.ops = &host_uart_ops;
+#else
+    uart->parent.open = host_uart_open;
+    uart->parent.close = host_uart_close;
+    uart->parent.write = host_uart_write;
+#endif
+    return rt_device_register(&uart->parent, name, RT_DEVICE_FLAG_WRONLY | RT_DEVICE_FLAG_DMA_TX);
+}
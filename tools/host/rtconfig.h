@@ -0,0 +1,77 @@
+/*
+ * File      : rtconfig.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef RT_CONFIG_H__
+#define RT_CONFIG_H__
+
+/*
+ * Configuration of the host build, see tools/Makefile. The rti options can
+ * be overridden on the command line, e.g. -DPKG_RTI_CFG_CLASSES=0x00C0.
+ */
+
+/* kernel */
+#define RT_NAME_MAX                 8
+#define RT_ALIGN_SIZE               8
+#define RT_THREAD_PRIORITY_MAX      32
+#define RT_TICK_PER_SECOND          1000
+#define RT_MAIN_THREAD_PRIORITY     10
+#define RT_USING_HOOK
+#define RT_USING_SEMAPHORE
+#define RT_USING_MUTEX
+#define RT_USING_EVENT
+#define RT_USING_MAILBOX
+#define RT_USING_MESSAGEQUEUE
+#define RT_USING_MEMPOOL
+#define RT_USING_HEAP
+#define RT_USING_DEVICE
+#define RT_USING_SERIAL
+#define RT_USING_FINSH
+
+/* the host provides files and sockets */
+#define RT_USING_DFS
+#define RT_USING_SAL
+
+/* rti */
+#define PKG_USING_RTI
+#ifndef PKG_RTI_BUFFER_SIZE
+    #define PKG_RTI_BUFFER_SIZE     8192
+#endif
+#define PKG_RTI_RAM_BASE            0
+#define PKG_RTI_ID_SHIFT            2
+#define PKG_RTI_APP_NAME            "RT-Thread RTI host"
+#define PKG_RTI_SYS_DESC0           "I#15=SysTick"
+#define PKG_RTI_SYS_DESC1           ""
+#define PKG_RTI_USING_COMPRESS
+#define PKG_RTI_USING_FILE
+#define PKG_RTI_USING_TCP
+
+/* the vector of the simulated interrupt being served */
+#define RTI_GET_ISR_ID()            rt_host_isr_id()
+
+/* CLOCK_MONOTONIC in nanoseconds, the time base rti_recv -l compares with */
+#ifdef RTI_HOST_MONOTONIC
+    #define RTI_GET_TIMESTAMP()     rt_host_clock()
+    #define RTI_SYS_FREQ            1000000000
+#endif
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * File      : rti_host.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+/*
+ * Run rti on the host kernel. Every argument is one shell command:
+ *
+ *   rti_host "rti_bench 10000" "rti_tcp start" "load 5000 100" "rti_tcp stop"
+ *
+ * Besides the exported commands there are "sleep <ms>", which lets the
+ * other threads run, "load <ms> [ops per ms]", which records semaphore
+ * events and log lines for the given time, paced by the tick, and
+ * "channels <rounds> <file>", which drains rti itself while the log
+ * channel wraps and events keep arriving between two reads, into file.0,
+ * file.1, ... starting a new one at a packet boundary now and then. The
+ * log lines of both are numbered, "channel N" must decode in order.
+ * "uart <name> <baud> <file>" adds a uart with tx dma that sends to file.
+ * "printf" records a rti_printf of 64 bit long, size_t and pointer values
+ * and prints what the C library makes of the same arguments.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rtthread.h>
+
+#include "rt_host.h"
+#include "rti.h"
+
+#define HOST_ARG_NUM            16
+
+static struct rt_semaphore load_sem;
+
+static void host_load(rt_uint32_t ms, rt_uint32_t rate)
+{
+    rt_tick_t end = rt_tick_get() + rt_tick_from_millisecond(ms);
+    rt_uint32_t i, count = 0;
+    char text[24];
+
+    rt_sem_init(&load_sem, "load", 0, RT_IPC_FLAG_FIFO);
+    while ((rt_int32_t)(rt_tick_get() - end) < 0)
+    {
+        for (i = 0; i < rate; i++)
+        {
+            rt_sem_release(&load_sem);
+            rt_sem_take(&load_sem, 0);
+            /* numbered, a decoder can tell they arrive in order */
+            if (++count % 16 == 0)
+            {
+                rt_snprintf(text, sizeof(text), "channel %u", count / 16);
+                rti_print(text);
+            }
+        }
+        rt_thread_mdelay(1);
+    }
+    rt_sem_detach(&load_sem);
+}
+
+static FILE *channel_fp;
+
+static void host_channel_output(const rt_uint8_t *ptr, rt_size_t length)
+{
+    fwrite(ptr, 1, length, channel_fp);
+}
+
+/* path.0, path.1, ... every file starts with the preamble */
+static rt_bool_t host_channel_open(const char *path, rt_uint32_t index)
+{
+    char name[256];
+
+    rt_snprintf(name, sizeof(name), "%s.%u", path, index);
+    channel_fp = fopen(name, "wb");
+    if (channel_fp == NULL)
+    {
+        perror(name);
+        return RT_FALSE;
+    }
+    return RT_TRUE;
+}
+
+static void host_channels(rt_uint32_t rounds, const char *path)
+{
+    void (*notify)(void) = rti_data_new_data_notify_get_hook();
+    struct rti_span span[2];
+    rt_uint32_t round, i, count = 0, files = 0, reads = 0;
+    rt_uint8_t spans;
+    char text[48];
+
+    if (!host_channel_open(path, files++))
+        return ;
+    /* the rti thread leaves the data to us */
+    rti_data_new_data_notify_set_hook(RT_NULL);
+    rti_start();
+    rt_sem_init(&load_sem, "chan", 0, RT_IPC_FLAG_FIFO);
+    for (round = 0; round < rounds; round++)
+    {
+        /* lines of many lengths, the wrap of the log channel falls
+         * anywhere in a packet */
+        for (i = 0; i < 5; i++)
+        {
+            count++;
+            rt_snprintf(text, sizeof(text), "channel %u %.*s", count,
+                        (int)(count % 23), "abcdefghijklmnopqrstuvw");
+            rti_print(text);
+        }
+        /* a sink that takes all it is given, while events arrive */
+        for (i = 0; (spans = rti_data_peek(span)) > 0; i++)
+        {
+            host_channel_output(span[0].ptr, span[0].length);
+            if (spans > 1)
+                host_channel_output(span[1].ptr, span[1].length);
+            rti_data_commit(span[0].length + span[1].length);
+
+            /* a new file now and then in the middle of the drain, at the
+             * next packet boundary, like rti_file rotates */
+            if (++reads >= 29 && rti_data_boundary())
+            {
+                reads = 0;
+                fclose(channel_fp);
+                if (!host_channel_open(path, files++))
+                    break;
+                rti_preamble(host_channel_output);
+            }
+            if (i < 4)
+            {
+                rt_sem_release(&load_sem);
+                rt_sem_take(&load_sem, 0);
+            }
+        }
+        if (channel_fp == NULL)
+            break;
+    }
+    rt_sem_detach(&load_sem);
+    rti_data_new_data_notify_set_hook(notify);
+    if (channel_fp != NULL)
+        fclose(channel_fp);
+    rt_kprintf("channels: %u lines in %u files\n", count, files);
+}
+
+static void host_printf(void)
+{
+    static const char fmt0[] = "%ld %lu %zu %c";
+    static const char fmt1[] = "%p %lld %hd";
+    long l = -0x123456789AL;
+    unsigned long ul = 0xFEDCBA9876543210UL;
+    size_t z = 0x100000001UL;
+    void *p = (void *)0x123456789ABCDEF0UL;
+    char text[128];
+
+    rti_printf(fmt0, l, ul, z, 'x');
+    snprintf(text, sizeof(text), fmt0, l, ul, z, 'x');
+    rt_kprintf("printf \"%s\"\n", text);
+    rti_printf(fmt1, p, -1LL, -2);
+    snprintf(text, sizeof(text), fmt1, p, -1LL, -2);
+    rt_kprintf("printf \"%s\"\n", text);
+}
+
+int main(int argc, char **argv)
+{
+    char *args[HOST_ARG_NUM];
+    int i, n;
+
+    rt_host_startup();
+
+    for (i = 1; i < argc; i++)
+    {
+        n = 0;
+        for (args[n] = strtok(argv[i], " "); args[n] != NULL && n < HOST_ARG_NUM - 1;
+             args[n] = strtok(NULL, " "))
+            n++;
+        if (n == 0)
+            continue;
+
+        if (strcmp(args[0], "sleep") == 0 && n > 1)
+            rt_thread_mdelay(atoi(args[1]));
+        else if (strcmp(args[0], "load") == 0 && n > 1)
+            host_load(atoi(args[1]), n > 2 ? atoi(args[2]) : 100);
+        else if (strcmp(args[0], "channels") == 0 && n > 2)
+            host_channels(atoi(args[1]), args[2]);
+        else if (strcmp(args[0], "uart") == 0 && n > 3)
+            rt_host_uart_register(args[1], atoi(args[2]), args[3]);
+        else if (strcmp(args[0], "printf") == 0)
+            host_printf();
+        else if (rt_host_msh(n, args) != RT_EOK)
+        {
+            fprintf(stderr, "%s: command not found.\n", args[0]);
+            return 1;
+        }
+    }
+    return 0;
+}
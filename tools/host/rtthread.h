@@ -0,0 +1,549 @@
+/*
+ * File      : rtthread.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RT_THREAD_H__
+#define __RT_THREAD_H__
+
+/*
+ * The subset of the RT-Thread kernel API the rti package uses, for building
+ * it on a Linux host. rt_host.c implements it on top of pthreads.
+ */
+
+#include <rtconfig.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+/* the API of 4.1, rt_memory_info takes rt_size_t */
+#define RT_VERSION                      4L
+#define RT_SUBVERSION                   1L
+#define RT_REVISION                     0L
+#define RTTHREAD_VERSION                ((RT_VERSION * 10000) + (RT_SUBVERSION * 100) + RT_REVISION)
+
+typedef signed   char                   rt_int8_t;
+typedef signed   short                  rt_int16_t;
+typedef signed   int                    rt_int32_t;
+typedef unsigned char                   rt_uint8_t;
+typedef unsigned short                  rt_uint16_t;
+typedef unsigned int                    rt_uint32_t;
+typedef signed long long               rt_int64_t;
+typedef unsigned long long             rt_uint64_t;
+typedef int                             rt_bool_t;
+
+typedef long                            rt_base_t;
+typedef unsigned long                   rt_ubase_t;
+
+typedef rt_base_t                       rt_err_t;
+typedef rt_uint32_t                     rt_time_t;
+typedef rt_uint32_t                     rt_tick_t;
+typedef rt_base_t                       rt_flag_t;
+typedef rt_ubase_t                      rt_size_t;
+typedef rt_ubase_t                      rt_dev_t;
+typedef rt_base_t                       rt_off_t;
+
+#define RT_TRUE                         1
+#define RT_FALSE                        0
+#define RT_NULL                         (0)
+
+#define RT_UINT32_MAX                   0xffffffff
+#define RT_TICK_MAX                     RT_UINT32_MAX
+
+#define SECTION(x)                      __attribute__((section(x)))
+#define RT_UNUSED                       __attribute__((unused))
+#define RT_USED                         __attribute__((used))
+#define ALIGN(n)                        __attribute__((aligned(n)))
+#define rt_inline                       static __inline
+
+#define RT_ALIGN(size, align)           (((size) + (align) - 1) & ~((align) - 1))
+#define RT_ALIGN_DOWN(size, align)      ((size) & ~((align) - 1))
+
+#define RT_EOK                          0
+#define RT_ERROR                        1
+#define RT_ETIMEOUT                     2
+#define RT_EFULL                        3
+#define RT_EEMPTY                       4
+#define RT_ENOMEM                       5
+#define RT_ENOSYS                       6
+#define RT_EBUSY                        7
+#define RT_EIO                          8
+#define RT_EINTR                        9
+#define RT_EINVAL                       10
+
+#define RT_WAITING_FOREVER              -1
+#define RT_WAITING_NO                   0
+
+void rt_host_assert(const char *ex, const char *func, rt_size_t line);
+#define RT_ASSERT(EX)                                                         \
+    if (!(EX))                                                                \
+    {                                                                         \
+        rt_host_assert(#EX, __FUNCTION__, __LINE__);                          \
+    }
+
+/* list */
+struct rt_list_node
+{
+    struct rt_list_node *next;
+    struct rt_list_node *prev;
+};
+typedef struct rt_list_node rt_list_t;
+
+#define rt_container_of(ptr, type, member) \
+    ((type *)((char *)(ptr) - (unsigned long)(&((type *)0)->member)))
+#define rt_list_entry(node, type, member) \
+    rt_container_of(node, type, member)
+
+rt_inline void rt_list_init(rt_list_t *l)
+{
+    l->next = l->prev = l;
+}
+
+rt_inline void rt_list_insert_after(rt_list_t *l, rt_list_t *n)
+{
+    l->next->prev = n;
+    n->next = l->next;
+    l->next = n;
+    n->prev = l;
+}
+
+rt_inline void rt_list_insert_before(rt_list_t *l, rt_list_t *n)
+{
+    l->prev->next = n;
+    n->prev = l->prev;
+    l->prev = n;
+    n->next = l;
+}
+
+rt_inline void rt_list_remove(rt_list_t *n)
+{
+    n->next->prev = n->prev;
+    n->prev->next = n->next;
+    n->next = n->prev = n;
+}
+
+rt_inline int rt_list_isempty(const rt_list_t *l)
+{
+    return l->next == l;
+}
+
+/* object */
+struct rt_object
+{
+    char       name[RT_NAME_MAX];
+    rt_uint8_t type;
+    rt_uint8_t flag;
+    rt_list_t  list;
+};
+typedef struct rt_object *rt_object_t;
+
+enum rt_object_class_type
+{
+    RT_Object_Class_Thread = 0,
+    RT_Object_Class_Semaphore,
+    RT_Object_Class_Mutex,
+    RT_Object_Class_Event,
+    RT_Object_Class_MailBox,
+    RT_Object_Class_MessageQueue,
+    RT_Object_Class_MemHeap,
+    RT_Object_Class_MemPool,
+    RT_Object_Class_Device,
+    RT_Object_Class_Timer,
+    RT_Object_Class_Module,
+    RT_Object_Class_Unknown,
+    RT_Object_Class_Static = 0x80
+};
+
+struct rt_object_information
+{
+    enum rt_object_class_type type;
+    rt_list_t                 object_list;
+    rt_size_t                 object_size;
+};
+
+#define RT_OBJECT_HOOK_CALL(func, argv) \
+    do { if ((func) != RT_NULL) func argv; } while (0)
+
+/* timer */
+#define RT_TIMER_FLAG_DEACTIVATED       0x0
+#define RT_TIMER_FLAG_ACTIVATED         0x1
+#define RT_TIMER_FLAG_ONE_SHOT          0x0
+#define RT_TIMER_FLAG_PERIODIC          0x2
+#define RT_TIMER_FLAG_HARD_TIMER        0x0
+#define RT_TIMER_FLAG_SOFT_TIMER        0x4
+
+struct rt_timer
+{
+    struct rt_object parent;
+    rt_list_t        row[1];
+
+    void (*timeout_func)(void *parameter);
+    void            *parameter;
+
+    rt_tick_t        init_tick;
+    rt_tick_t        timeout_tick;
+};
+typedef struct rt_timer *rt_timer_t;
+
+/* thread */
+#define RT_THREAD_INIT                  0x00
+#define RT_THREAD_READY                 0x01
+#define RT_THREAD_SUSPEND               0x02
+#define RT_THREAD_RUNNING               0x03
+#define RT_THREAD_BLOCK                 RT_THREAD_SUSPEND
+#define RT_THREAD_CLOSE                 0x04
+#define RT_THREAD_STAT_MASK             0x0f
+
+struct rt_thread
+{
+    char        name[RT_NAME_MAX];
+    rt_uint8_t  type;
+    rt_uint8_t  flags;
+    rt_list_t   list;
+
+    rt_list_t   tlist;
+
+    void       *sp;
+    void       *entry;
+    void       *parameter;
+    void       *stack_addr;
+    rt_uint32_t stack_size;
+
+    rt_err_t    error;
+    rt_uint8_t  stat;
+
+    rt_uint8_t  current_priority;
+    rt_uint8_t  init_priority;
+
+    rt_uint32_t event_set;
+    rt_uint8_t  event_info;
+
+    rt_ubase_t  init_tick;
+    rt_ubase_t  remaining_tick;
+
+    void (*cleanup)(struct rt_thread *tid);
+    rt_ubase_t  user_data;
+
+    /* the pthread behind the thread, see rt_host.c */
+    struct rt_host_thread *host;
+};
+typedef struct rt_thread *rt_thread_t;
+
+/* ipc */
+#define RT_IPC_FLAG_FIFO                0x00
+#define RT_IPC_FLAG_PRIO                0x01
+
+#define RT_EVENT_FLAG_AND               0x01
+#define RT_EVENT_FLAG_OR                0x02
+#define RT_EVENT_FLAG_CLEAR             0x04
+
+struct rt_ipc_object
+{
+    struct rt_object parent;
+    rt_list_t        suspend_thread;
+};
+
+struct rt_semaphore
+{
+    struct rt_ipc_object parent;
+    rt_uint16_t          value;
+};
+typedef struct rt_semaphore *rt_sem_t;
+
+struct rt_mutex
+{
+    struct rt_ipc_object parent;
+    rt_uint16_t          value;
+    rt_uint8_t           original_priority;
+    rt_uint8_t           hold;
+    struct rt_thread    *owner;
+};
+typedef struct rt_mutex *rt_mutex_t;
+
+struct rt_event
+{
+    struct rt_ipc_object parent;
+    rt_uint32_t          set;
+};
+typedef struct rt_event *rt_event_t;
+
+struct rt_mailbox
+{
+    struct rt_ipc_object parent;
+    rt_ubase_t          *msg_pool;
+    rt_uint16_t          size;
+    rt_uint16_t          entry;
+    rt_uint16_t          in_offset;
+    rt_uint16_t          out_offset;
+    rt_list_t            suspend_sender_thread;
+};
+typedef struct rt_mailbox *rt_mailbox_t;
+
+struct rt_messagequeue
+{
+    struct rt_ipc_object parent;
+    void                *msg_pool;
+    rt_uint16_t          msg_size;
+    rt_uint16_t          max_msgs;
+    rt_uint16_t          entry;
+    rt_uint16_t          in_offset;
+    rt_uint16_t          out_offset;
+    rt_list_t            suspend_sender_thread;
+};
+typedef struct rt_messagequeue *rt_mq_t;
+
+/* memory pool, a free block holds the next free block */
+struct rt_mempool
+{
+    struct rt_object parent;
+    void            *start_address;
+    rt_size_t        size;
+    rt_size_t        block_size;
+    rt_uint8_t      *block_list;
+    rt_size_t        block_total_count;
+    rt_size_t        block_free_count;
+    rt_list_t        suspend_thread;
+};
+typedef struct rt_mempool *rt_mp_t;
+
+/* device */
+#define RT_DEVICE_FLAG_DEACTIVATE       0x000
+#define RT_DEVICE_FLAG_RDONLY           0x001
+#define RT_DEVICE_FLAG_WRONLY           0x002
+#define RT_DEVICE_FLAG_RDWR             0x003
+#define RT_DEVICE_FLAG_REMOVABLE        0x004
+#define RT_DEVICE_FLAG_STANDALONE       0x008
+#define RT_DEVICE_FLAG_ACTIVATED        0x010
+#define RT_DEVICE_FLAG_SUSPENDED        0x020
+#define RT_DEVICE_FLAG_STREAM           0x040
+#define RT_DEVICE_FLAG_INT_RX           0x100
+#define RT_DEVICE_FLAG_DMA_RX           0x200
+#define RT_DEVICE_FLAG_INT_TX           0x400
+#define RT_DEVICE_FLAG_DMA_TX           0x800
+
+#define RT_DEVICE_OFLAG_CLOSE           0x000
+#define RT_DEVICE_OFLAG_RDONLY          0x001
+#define RT_DEVICE_OFLAG_WRONLY          0x002
+#define RT_DEVICE_OFLAG_RDWR            0x003
+#define RT_DEVICE_OFLAG_OPEN            0x008
+#define RT_DEVICE_OFLAG_MASK            0xf0f
+
+#define RT_DEVICE_CTRL_RESUME           0x01
+#define RT_DEVICE_CTRL_SUSPEND          0x02
+#define RT_DEVICE_CTRL_CONFIG           0x03
+
+typedef struct rt_device *rt_device_t;
+
+struct rt_device_ops
+{
+    rt_err_t  (*init)   (rt_device_t dev);
+    rt_err_t  (*open)   (rt_device_t dev, rt_uint16_t oflag);
+    rt_err_t  (*close)  (rt_device_t dev);
+    rt_size_t (*read)   (rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size);
+    rt_size_t (*write)  (rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size);
+    rt_err_t  (*control)(rt_device_t dev, int cmd, void *args);
+};
+
+struct rt_device
+{
+    struct rt_object parent;
+
+    rt_uint16_t flag;
+    rt_uint16_t open_flag;
+    rt_uint8_t  ref_count;
+    rt_uint8_t  device_id;
+
+    rt_err_t (*rx_indicate)(rt_device_t dev, rt_size_t size);
+    rt_err_t (*tx_complete)(rt_device_t dev, void *buffer);
+
+#ifdef RT_USING_DEVICE_OPS
+    const struct rt_device_ops *ops;
+#else
+    rt_err_t  (*init)   (rt_device_t dev);
+    rt_err_t  (*open)   (rt_device_t dev, rt_uint16_t oflag);
+    rt_err_t  (*close)  (rt_device_t dev);
+    rt_size_t (*read)   (rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size);
+    rt_size_t (*write)  (rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size);
+    rt_err_t  (*control)(rt_device_t dev, int cmd, void *args);
+#endif
+
+    void *user_data;
+};
+
+/* components are initialized by rt_host_startup in level order */
+typedef int (*init_fn_t)(void);
+struct rt_host_init
+{
+    init_fn_t   fn;
+    const char *level;
+};
+#define INIT_EXPORT(fn, level)                                                \
+    RT_USED static const struct rt_host_init __rt_init_##fn                   \
+    SECTION("rt_host_init") ALIGN(sizeof(void *)) = {fn, level}
+#define INIT_BOARD_EXPORT(fn)           INIT_EXPORT(fn, "1")
+#define INIT_PREV_EXPORT(fn)            INIT_EXPORT(fn, "2")
+#define INIT_DEVICE_EXPORT(fn)          INIT_EXPORT(fn, "3")
+#define INIT_COMPONENT_EXPORT(fn)       INIT_EXPORT(fn, "4")
+#define INIT_ENV_EXPORT(fn)             INIT_EXPORT(fn, "5")
+#define INIT_APP_EXPORT(fn)             INIT_EXPORT(fn, "6")
+
+/* object */
+void rt_object_init(struct rt_object *object, enum rt_object_class_type type, const char *name);
+void rt_object_detach(rt_object_t object);
+rt_object_t rt_object_find(const char *name, rt_uint8_t type);
+struct rt_object_information *rt_object_get_information(enum rt_object_class_type type);
+
+void rt_object_attach_sethook(void (*hook)(struct rt_object *object));
+void rt_object_detach_sethook(void (*hook)(struct rt_object *object));
+void rt_object_trytake_sethook(void (*hook)(struct rt_object *object));
+void rt_object_take_sethook(void (*hook)(struct rt_object *object));
+void rt_object_put_sethook(void (*hook)(struct rt_object *object));
+
+/* clock and timer */
+rt_tick_t rt_tick_get(void);
+rt_tick_t rt_tick_from_millisecond(rt_int32_t ms);
+
+void rt_timer_init(rt_timer_t timer, const char *name, void (*timeout)(void *parameter),
+                   void *parameter, rt_tick_t time, rt_uint8_t flag);
+rt_err_t rt_timer_detach(rt_timer_t timer);
+rt_err_t rt_timer_start(rt_timer_t timer);
+rt_err_t rt_timer_stop(rt_timer_t timer);
+void rt_timer_check(void);
+
+void rt_timer_enter_sethook(void (*hook)(struct rt_timer *timer));
+void rt_timer_exit_sethook(void (*hook)(struct rt_timer *timer));
+
+/* thread and scheduler */
+rt_err_t rt_thread_init(struct rt_thread *thread, const char *name,
+                        void (*entry)(void *parameter), void *parameter,
+                        void *stack_start, rt_uint32_t stack_size,
+                        rt_uint8_t priority, rt_uint32_t tick);
+rt_err_t rt_thread_detach(rt_thread_t thread);
+rt_thread_t rt_thread_create(const char *name, void (*entry)(void *parameter), void *parameter,
+                             rt_uint32_t stack_size, rt_uint8_t priority, rt_uint32_t tick);
+rt_err_t rt_thread_delete(rt_thread_t thread);
+rt_thread_t rt_thread_self(void);
+rt_thread_t rt_thread_find(char *name);
+rt_err_t rt_thread_startup(rt_thread_t thread);
+rt_err_t rt_thread_yield(void);
+rt_err_t rt_thread_delay(rt_tick_t tick);
+rt_err_t rt_thread_mdelay(rt_int32_t ms);
+rt_err_t rt_thread_suspend(rt_thread_t thread);
+rt_err_t rt_thread_resume(rt_thread_t thread);
+rt_thread_t rt_thread_idle_gethandler(void);
+
+void rt_thread_suspend_sethook(void (*hook)(rt_thread_t thread));
+void rt_thread_resume_sethook(void (*hook)(rt_thread_t thread));
+void rt_thread_inited_sethook(void (*hook)(rt_thread_t thread));
+rt_err_t rt_thread_idle_sethook(void (*hook)(void));
+
+void rt_schedule(void);
+void rt_enter_critical(void);
+void rt_exit_critical(void);
+rt_uint16_t rt_critical_level(void);
+void rt_scheduler_sethook(void (*hook)(rt_thread_t from, rt_thread_t to));
+
+/* interrupt */
+void rt_interrupt_enter(void);
+void rt_interrupt_leave(void);
+rt_uint8_t rt_interrupt_get_nest(void);
+void rt_interrupt_enter_sethook(void (*hook)(void));
+void rt_interrupt_leave_sethook(void (*hook)(void));
+
+/* ipc */
+rt_err_t rt_sem_init(rt_sem_t sem, const char *name, rt_uint32_t value, rt_uint8_t flag);
+rt_err_t rt_sem_detach(rt_sem_t sem);
+rt_sem_t rt_sem_create(const char *name, rt_uint32_t value, rt_uint8_t flag);
+rt_err_t rt_sem_delete(rt_sem_t sem);
+rt_err_t rt_sem_take(rt_sem_t sem, rt_int32_t time);
+rt_err_t rt_sem_trytake(rt_sem_t sem);
+rt_err_t rt_sem_release(rt_sem_t sem);
+
+rt_err_t rt_mutex_init(rt_mutex_t mutex, const char *name, rt_uint8_t flag);
+rt_err_t rt_mutex_detach(rt_mutex_t mutex);
+rt_mutex_t rt_mutex_create(const char *name, rt_uint8_t flag);
+rt_err_t rt_mutex_delete(rt_mutex_t mutex);
+rt_err_t rt_mutex_take(rt_mutex_t mutex, rt_int32_t time);
+rt_err_t rt_mutex_release(rt_mutex_t mutex);
+
+rt_err_t rt_event_init(rt_event_t event, const char *name, rt_uint8_t flag);
+rt_err_t rt_event_detach(rt_event_t event);
+rt_err_t rt_event_send(rt_event_t event, rt_uint32_t set);
+rt_err_t rt_event_recv(rt_event_t event, rt_uint32_t set, rt_uint8_t opt,
+                       rt_int32_t timeout, rt_uint32_t *recved);
+
+rt_err_t rt_mb_init(rt_mailbox_t mb, const char *name, void *msgpool, rt_size_t size, rt_uint8_t flag);
+rt_err_t rt_mb_detach(rt_mailbox_t mb);
+rt_err_t rt_mb_send(rt_mailbox_t mb, rt_ubase_t value);
+rt_err_t rt_mb_recv(rt_mailbox_t mb, rt_ubase_t *value, rt_int32_t timeout);
+
+rt_err_t rt_mq_init(rt_mq_t mq, const char *name, void *msgpool, rt_size_t msg_size,
+                    rt_size_t pool_size, rt_uint8_t flag);
+rt_err_t rt_mq_detach(rt_mq_t mq);
+rt_err_t rt_mq_send(rt_mq_t mq, const void *buffer, rt_size_t size);
+rt_err_t rt_mq_recv(rt_mq_t mq, void *buffer, rt_size_t size, rt_int32_t timeout);
+
+/* memory pool */
+rt_err_t rt_mp_init(struct rt_mempool *mp, const char *name, void *start, rt_size_t size, rt_size_t block_size);
+rt_err_t rt_mp_detach(struct rt_mempool *mp);
+void *rt_mp_alloc(rt_mp_t mp, rt_int32_t time);
+void rt_mp_free(void *block);
+void rt_mp_alloc_sethook(void (*hook)(struct rt_mempool *mp, void *block));
+void rt_mp_free_sethook(void (*hook)(struct rt_mempool *mp, void *block));
+
+/* memory */
+void *rt_malloc(rt_size_t size);
+void rt_free(void *rmem);
+void *rt_realloc(void *rmem, rt_size_t newsize);
+void *rt_calloc(rt_size_t count, rt_size_t size);
+void rt_memory_info(rt_size_t *total, rt_size_t *used, rt_size_t *max_used);
+void rt_malloc_sethook(void (*hook)(void *ptr, rt_size_t size));
+void rt_free_sethook(void (*hook)(void *ptr));
+
+/* device */
+rt_device_t rt_device_find(const char *name);
+rt_err_t rt_device_register(rt_device_t dev, const char *name, rt_uint16_t flags);
+rt_err_t rt_device_unregister(rt_device_t dev);
+rt_err_t rt_device_set_rx_indicate(rt_device_t dev, rt_err_t (*rx_ind)(rt_device_t dev, rt_size_t size));
+rt_err_t rt_device_set_tx_complete(rt_device_t dev, rt_err_t (*tx_done)(rt_device_t dev, void *buffer));
+rt_err_t rt_device_init(rt_device_t dev);
+rt_err_t rt_device_open(rt_device_t dev, rt_uint16_t oflag);
+rt_err_t rt_device_close(rt_device_t dev);
+rt_size_t rt_device_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size);
+rt_size_t rt_device_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size);
+rt_err_t rt_device_control(rt_device_t dev, int cmd, void *arg);
+
+/* kernel service */
+void rt_kprintf(const char *fmt, ...);
+rt_int32_t rt_snprintf(char *buf, rt_size_t size, const char *format, ...);
+rt_int32_t rt_vsnprintf(char *buf, rt_size_t size, const char *fmt, va_list args);
+void *rt_memset(void *src, int c, rt_ubase_t n);
+void *rt_memcpy(void *dst, const void *src, rt_ubase_t count);
+rt_int32_t rt_memcmp(const void *cs, const void *ct, rt_ubase_t count);
+char *rt_strncpy(char *dst, const char *src, rt_ubase_t n);
+rt_int32_t rt_strncmp(const char *cs, const char *ct, rt_ubase_t count);
+rt_int32_t rt_strcmp(const char *cs, const char *ct);
+rt_size_t rt_strlen(const char *src);
+
+/* the simulated interrupt being served, see rt_host.h */
+int rt_host_isr_id(void);
+rt_uint32_t rt_host_clock(void);
+
+#endif
@@ -0,0 +1,316 @@
+/*
+ * File      : rti_decode.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+/*
+ * Decode a recorded rti stream on the host.
+ *
+ *   gcc -O2 -o rti_decode tools/rti_decode.c tools/rti_decoder.c tools/rti_unpack.c tools/rti_format.c
+ *   rti_decode [-s] [-e firmware.elf] [file]
+ *
+ * Prints one line per event: time, name and fields. With -s only the
+ * per event counts and the decoder statistics are printed. Reads stdin
+ * when no file is given. A stream of compressed frames (rti_compress.h)
+ * is recognized by its first byte and unpacked on the fly. With the elf
+ * file of the firmware the rti_printf messages are formatted.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "rti_decoder.h"
+#include "rti_unpack.h"
+#include "rti_format.h"
+
+#define READ_SIZE    (1024 * 1024)
+#define COUNT_NUM    (RTI_DECODER_ID_MAX + 1)
+#define NAME_NUM     1024
+#define NAME_LEN     32
+#define PRINTF_LEN   1024
+#define MODULE_NUM   256
+
+/* names of threads and ipc objects, from THREAD_INFO and NAME_RESOURCE */
+struct rti_name
+{
+    uint32_t id;
+    char name[NAME_LEN + 1];
+};
+
+/* modules from MODULEDESC: the first event id and the name after "M=" */
+struct rti_module_name
+{
+    uint32_t offset;
+    char name[NAME_LEN + 1];
+};
+
+struct rti_decode
+{
+    struct rti_decoder decoder;
+    struct rti_unpack unpack;
+    struct rti_format format;
+    int summary;
+    int packed;
+    uint64_t count[COUNT_NUM];
+    struct rti_name names[NAME_NUM];
+    struct rti_module_name modules[MODULE_NUM];
+};
+
+static void rti_decode_name_set(struct rti_decode *decode, uint32_t id, const char *str, uint16_t len)
+{
+    struct rti_name *name = &decode->names[id % NAME_NUM];
+
+    if (len > NAME_LEN)
+        len = NAME_LEN;
+    name->id = id;
+    memcpy(name->name, str, len);
+    name->name[len] = '\0';
+}
+
+static const char *rti_decode_name_get(struct rti_decode *decode, uint32_t id)
+{
+    struct rti_name *name = &decode->names[id % NAME_NUM];
+
+    return (name->id == id) ? name->name : NULL;
+}
+
+static void rti_decode_module_set(struct rti_decode *decode, const struct rti_event *event)
+{
+    struct rti_module_name *module = &decode->modules[event->value[0]];
+    const char *str = event->str;
+    uint16_t len = 0;
+
+    /* the further descriptions of a module leave out the name */
+    if (event->str_len < 2 || str[0] != 'M' || str[1] != '=')
+        return;
+    str += 2;
+    while (len < event->str_len - 2 && len < NAME_LEN && str[len] != ',')
+        len++;
+    module->offset = event->value[1];
+    memcpy(module->name, str, len);
+    module->name[len] = '\0';
+}
+
+/* module events are shown as the module name and the event number */
+static const char *rti_decode_event_name(struct rti_decode *decode, uint32_t id, char *buf, size_t size)
+{
+    const struct rti_module_name *module = NULL;
+    int i;
+
+    if (id < RTI_DECODER_ID_MODULE)
+        return rti_decoder_name(id);
+    for (i = 0; i < MODULE_NUM; i++)
+    {
+        if (decode->modules[i].name[0] && decode->modules[i].offset <= id &&
+                (module == NULL || decode->modules[i].offset > module->offset))
+            module = &decode->modules[i];
+    }
+    if (module == NULL)
+        return rti_decoder_name(id);
+    snprintf(buf, size, "%s+%u", module->name, id - module->offset);
+    return buf;
+}
+
+/* events whose first value is a thread or object id */
+static int rti_decode_has_object(uint32_t id)
+{
+    return id == 4 || id == 6 || id == 7 || id == 8 || id == 29 || (id > 40 && id < 90) || id == 91 ||
+           id == 98 || id == 99 || id == 101 || id == 102;
+}
+
+static void rti_decode_print(void *user, const struct rti_event *event)
+{
+    struct rti_decode *decode = user;
+    const char *name, *fmt;
+    char label[NAME_LEN * 2];
+    uint8_t i;
+
+    if ((event->id == 9 || event->id == 25) && event->str != NULL && event->value_count > 0)
+        rti_decode_name_set(decode, event->value[0], event->str, event->str_len);
+    if (event->id == 22 && event->str != NULL && event->value_count == 2 && event->value[0] < MODULE_NUM)
+        rti_decode_module_set(decode, event);
+
+    if (decode->summary)
+    {
+        decode->count[event->id]++;
+        return;
+    }
+
+    if (decode->decoder.sys_freq)
+        printf("%14.9f ", (double)event->time / decode->decoder.sys_freq);
+    else
+        printf("%14llu ", (unsigned long long)event->time);
+
+    if (event->id < 128 || event->id >= RTI_DECODER_ID_MODULE)
+        printf("%-18s", rti_decode_event_name(decode, event->id, label, sizeof(label)));
+    else
+        printf("%-18u", event->id);
+
+    if (event->id == RTI_DECODER_ID_PRINTF && event->value_count > 0 &&
+            (fmt = rti_format_string(&decode->format, event->value[0])) != NULL)
+    {
+        const uint8_t *args = event->payload, *end = event->payload + event->payload_len;
+        char text[PRINTF_LEN];
+        uint32_t address;
+
+        rti_decoder_val(&args, end, &address);
+        rti_format_print(&decode->format, fmt, args, end - args, text, sizeof(text));
+        printf(" \"%s\"\n", text);
+        return;
+    }
+
+    for (i = 0; i < event->value_count; i++)
+        printf(" 0x%08x", event->value[i]);
+    if (event->str != NULL)
+        printf(" \"%.*s\"", event->str_len, event->str);
+    else if (event->value_count > 0 && rti_decode_has_object(event->id) &&
+             (name = rti_decode_name_get(decode, event->value[0])) != NULL)
+        printf(" (%s)", name);
+    else if (event->value_count == 0 && event->payload_len > 0)
+    {
+        printf(" [");
+        for (i = 0; i < event->payload_len && i < 16; i++)
+            printf(i ? " %02x" : "%02x", event->payload[i]);
+        printf(event->payload_len > 16 ? " ...]" : "]");
+    }
+    printf("\n");
+}
+
+static void rti_decode_block(void *user, const uint8_t *data, size_t size)
+{
+    struct rti_decode *decode = user;
+
+    rti_decoder_feed(&decode->decoder, data, size);
+}
+
+static double rti_decode_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    struct rti_decode *decode;
+    const char *path = NULL, *elf = NULL;
+    uint8_t *buf;
+    FILE *fp = stdin;
+    char label[NAME_LEN * 2];
+    double start, seconds;
+    size_t size;
+    uint32_t id;
+    int i;
+
+    decode = calloc(1, sizeof(*decode));
+    buf = malloc(READ_SIZE);
+    if (decode == NULL || buf == NULL)
+    {
+        fprintf(stderr, "rti_decode: out of memory\n");
+        return 1;
+    }
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-s") == 0)
+            decode->summary = 1;
+        else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+            elf = argv[++i];
+        else if (argv[i][0] == '-' && argv[i][1] != '\0')
+        {
+            fprintf(stderr, "usage: rti_decode [-s] [-e firmware.elf] [file]\n");
+            return 1;
+        }
+        else
+            path = argv[i];
+    }
+
+    if (elf != NULL && rti_format_load(&decode->format, elf) != 0)
+    {
+        fprintf(stderr, "rti_decode: %s is not an elf file\n", elf);
+        return 1;
+    }
+
+    if (path != NULL && strcmp(path, "-") != 0)
+    {
+        fp = fopen(path, "rb");
+        if (fp == NULL)
+        {
+            perror(path);
+            return 1;
+        }
+    }
+
+    rti_decoder_init(&decode->decoder, rti_decode_print, decode);
+    rti_unpack_init(&decode->unpack, rti_decode_block, decode);
+
+    start = rti_decode_now();
+    while ((size = fread(buf, 1, READ_SIZE, fp)) > 0)
+    {
+        /* a raw stream starts with the sync */
+        if (decode->unpack.bytes == 0 && decode->decoder.bytes == 0)
+            decode->packed = (buf[0] == RTI_UNPACK_MAGIC);
+        if (decode->packed)
+            rti_unpack_feed(&decode->unpack, buf, size);
+        else
+            rti_decoder_feed(&decode->decoder, buf, size);
+    }
+    seconds = rti_decode_now() - start;
+
+    if (decode->summary)
+    {
+        for (id = 0; id < COUNT_NUM; id++)
+        {
+            if (decode->count[id])
+                printf("%-18s %4u %12llu\n", rti_decode_event_name(decode, id, label, sizeof(label)), id,
+                       (unsigned long long)decode->count[id]);
+        }
+        printf("bytes %llu, packets %llu, lost %llu, errors %llu, %.1f MB/s\n",
+               (unsigned long long)decode->decoder.bytes,
+               (unsigned long long)decode->decoder.packets,
+               (unsigned long long)decode->decoder.lost,
+               (unsigned long long)decode->decoder.errors,
+               seconds > 0 ? decode->decoder.bytes / seconds / 1e6 : 0.0);
+        if (decode->packed)
+            printf("frames %llu, packed bytes %llu, ratio %.2f, frame errors %llu\n",
+                   (unsigned long long)decode->unpack.frames,
+                   (unsigned long long)decode->unpack.bytes,
+                   decode->unpack.bytes ? (double)decode->unpack.raw_bytes / decode->unpack.bytes : 0.0,
+                   (unsigned long long)decode->unpack.errors);
+    }
+    if (decode->packed && decode->unpack.frame_len)
+        fprintf(stderr, "rti_decode: %u bytes of a truncated frame at the end\n",
+                decode->unpack.frame_len);
+    if (decode->decoder.carry_len)
+        fprintf(stderr, "rti_decode: %u bytes of a truncated packet at the end\n",
+                decode->decoder.carry_len);
+
+    if (fp != stdin)
+        fclose(fp);
+    rti_format_free(&decode->format);
+    free(buf);
+    free(decode);
+    return 0;
+}
@@ -0,0 +1,407 @@
+/*
+ * File      : rti_decoder.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+/*
+   Packet layout, see src/rti.c:
+   Id < 24  : Id|Fields|TimeStampDelta, the fields of each id are fixed.
+   Id >= 24 : Id|DataSize|Data|TimeStampDelta
+   Id 0 (NOP) is a single byte without time stamp, the sync is ten of them.
+   Id 94 (CHANNEL) switches to the packets of another channel, which has a
+   time of its own. One naming the current channel is a keepalive that
+   only moves its time on.
+
+   Fields are varints ('U') or strings ('S': length byte, 0xFF escapes a
+   two byte length). '*' repeats the varints up to the end of the data.
+   Only the format address of PRINTF is decoded, its arguments depend on
+   the format string, see rti_format.c. The events of the modules (id 512
+   and up) are varints.
+*/
+
+#include <string.h>
+#include "rti_decoder.h"
+
+#define PARSE_MORE      0
+#define PARSE_ERROR    -1
+
+#define DESC_NUM        128
+
+struct rti_packet_desc
+{
+    const char *name;
+
+    /* fields of the packet, NULL when the payload is not decoded */
+    const char *fields;
+};
+
+static const struct rti_packet_desc packet_desc[DESC_NUM] =
+{
+    [0]  = {"NOP",                ""},
+    [1]  = {"OVERFLOW",           "U"},
+    [2]  = {"ISR_ENTER",          "U"},
+    [3]  = {"ISR_EXIT",           ""},
+    [4]  = {"THREAD_START_EXEC",  "U"},
+    [5]  = {"THREAD_STOP_EXEC",   ""},
+    [6]  = {"THREAD_START_READY", "U"},
+    [7]  = {"THREAD_STOP_READY",  "UU"},
+    [8]  = {"THREAD_CREATE",      "U"},
+    [9]  = {"THREAD_INFO",        "UUS"},
+    [10] = {"START",              ""},
+    [11] = {"STOP",               ""},
+    [12] = {"SYSTIME_CYCLES",     "U"},
+    [13] = {"SYSTIME_US",         "UU"},
+    [14] = {"SYSDESC",            "S"},
+    [15] = {"USER_START",         "U"},
+    [16] = {"USER_STOP",          "U"},
+    [17] = {"IDLE",               ""},
+    [18] = {"ISR_TO_SCHEDULER",   ""},
+    [19] = {"TIMER_ENTER",        "U"},
+    [20] = {"TIMER_EXIT",         ""},
+    [21] = {"STACK_INFO",         "UUUU"},
+    [22] = {"MODULEDESC",         "UUS"},
+
+    [24] = {"INIT",               "UUUU"},
+    [25] = {"NAME_RESOURCE",      "US"},
+    [26] = {"PRINT_FORMATTED",    "SUU"},
+    [27] = {"NUMMODULES",         "U"},
+    [28] = {"END_CALL",           "U"},
+    [29] = {"THREAD_TERMINATE",   "U"},
+    [31] = {"EX",                 NULL},
+
+    [41] = {"SEM_TRYTAKE",        "U"},
+    [42] = {"SEM_TAKEN",          "U"},
+    [43] = {"SEM_RELEASE",        "U"},
+    [51] = {"MUTEX_TRYTAKE",      "U"},
+    [52] = {"MUTEX_TAKEN",        "U"},
+    [53] = {"MUTEX_RELEASE",      "U"},
+    [61] = {"EVENT_TRYTAKE",      "UU"},
+    [62] = {"EVENT_TAKEN",        "UU"},
+    [63] = {"EVENT_RELEASE",      "UU"},
+    [71] = {"MAILBOX_TRYTAKE",    "U"},
+    [72] = {"MAILBOX_TAKEN",      "U"},
+    [73] = {"MAILBOX_RELEASE",    "U"},
+    [81] = {"QUEUE_TRYTAKE",      "U"},
+    [82] = {"QUEUE_TAKEN",        "U"},
+    [83] = {"QUEUE_RELEASE",      "U"},
+    [90] = {"STATS",              "UU*"},
+    [91] = {"LOCK",               "UUUUUUUU"},
+    [92] = {"THROTTLE",           "*"},
+    [93] = {"TELEMETRY",          "UUUUU*"},
+    [94] = {"CHANNEL",            "U"},
+    [95] = {"PRINTF",             "U"},
+    [96] = {"MALLOC",             "UUU"},
+    [97] = {"FREE",               "UU"},
+    [98] = {"MP_ALLOC",           "UUU"},
+    [99] = {"MP_FREE",            "UUU"},
+    [100] = {"ALLOC",             "UU*"},
+    [101] = {"DEVICE_ENTER",      "UUU"},
+    [102] = {"DEVICE_EXIT",       "UUUU"},
+};
+
+const char *rti_decoder_name(uint32_t id)
+{
+    if (id < DESC_NUM && packet_desc[id].name != NULL)
+        return packet_desc[id].name;
+    return "UNKNOWN";
+}
+
+int rti_decoder_val(const uint8_t **present, const uint8_t *end, uint32_t *value)
+{
+    const uint8_t *p = *present;
+    uint32_t v = 0;
+    int shift;
+
+    for (shift = 0; shift < 35; shift += 7)
+    {
+        if (p == end)
+            return PARSE_MORE;
+        v |= (uint32_t)(*p & 0x7F) << shift;
+        if (!(*p++ & 0x80))
+        {
+            *value = v;
+            *present = p;
+            return 1;
+        }
+    }
+    return PARSE_ERROR;
+}
+
+int rti_decoder_str(const uint8_t **present, const uint8_t *end, const char **str, uint16_t *len)
+{
+    const uint8_t *p = *present;
+    uint16_t n;
+
+    if (p == end)
+        return PARSE_MORE;
+    n = *p++;
+    if (n == 0xFF)
+    {
+        if (end - p < 2)
+            return PARSE_MORE;
+        n = p[0] | (p[1] << 8);
+        p += 2;
+    }
+    if (end - p < n)
+        return PARSE_MORE;
+    *str = (const char *)p;
+    *len = n;
+    *present = p + n;
+    return 1;
+}
+
+/* decode the fields of a packet, a short packet is PARSE_MORE */
+static int rti_decode_fields(const char *fields, const uint8_t **present, const uint8_t *end,
+                             struct rti_event *event)
+{
+    int result;
+
+    for (; *fields; fields++)
+    {
+        if (*fields == '*')
+        {
+            uint32_t value;
+
+            while (*present < end)
+            {
+                result = rti_decoder_val(present, end, &value);
+                if (result <= 0)
+                    return result;
+                if (event->value_count < RTI_DECODER_MAX_VALUES)
+                    event->value[event->value_count++] = value;
+            }
+        }
+        else if (*fields == 'U')
+        {
+            uint32_t value;
+
+            result = rti_decoder_val(present, end, &value);
+            if (result <= 0)
+                return result;
+            if (event->value_count < RTI_DECODER_MAX_VALUES)
+                event->value[event->value_count++] = value;
+        }
+        else
+        {
+            result = rti_decoder_str(present, end, &event->str, &event->str_len);
+            if (result <= 0)
+                return result;
+        }
+    }
+    return 1;
+}
+
+/* parse one packet, return the bytes it takes, PARSE_MORE or PARSE_ERROR */
+static int rti_parse_packet(const uint8_t *data, size_t size, struct rti_event *event, uint32_t *delta)
+{
+    const uint8_t *p = data, *end = data + size;
+    const char *fields;
+    uint32_t len;
+    int result;
+
+    result = rti_decoder_val(&p, end, &event->id);
+    if (result <= 0)
+        return result;
+
+    event->value_count = 0;
+    event->str = NULL;
+    event->str_len = 0;
+
+    if (event->id == RTI_DECODER_ID_NOP)
+    {
+        event->payload = p;
+        event->payload_len = 0;
+        *delta = 0;
+        return (int)(p - data);
+    }
+
+    if (event->id < 24)
+    {
+        fields = packet_desc[event->id].fields;
+        if (fields == NULL)
+            return PARSE_ERROR;
+        event->payload = p;
+        result = rti_decode_fields(fields, &p, end, event);
+        if (result <= 0)
+            return result;
+        event->payload_len = (uint16_t)(p - event->payload);
+    }
+    else
+    {
+        if (event->id > RTI_DECODER_ID_MAX)
+            return PARSE_ERROR;
+        result = rti_decoder_val(&p, end, &len);
+        if (result <= 0)
+            return result;
+        if (len > 0x3FFF)
+            return PARSE_ERROR;
+        if ((size_t)(end - p) < len)
+            return PARSE_MORE;
+
+        event->payload = p;
+        event->payload_len = (uint16_t)len;
+        p += len;
+
+        /* decode what we know, the raw payload is there anyway */
+        if (event->id < DESC_NUM)
+            fields = packet_desc[event->id].fields;
+        else if (event->id >= RTI_DECODER_ID_MODULE)
+            fields = "*";
+        else
+            fields = NULL;
+        if (fields != NULL)
+        {
+            const uint8_t *q = event->payload;
+
+            if (rti_decode_fields(fields, &q, p, event) <= 0)
+            {
+                event->value_count = 0;
+                event->str = NULL;
+                event->str_len = 0;
+            }
+        }
+    }
+
+    result = rti_decoder_val(&p, end, delta);
+    if (result <= 0)
+        return result;
+    return (int)(p - data);
+}
+
+static void rti_decoder_emit(struct rti_decoder *decoder, struct rti_event *event, uint32_t delta)
+{
+    decoder->time += delta;
+    decoder->packets++;
+    event->time = decoder->time;
+    event->channel = decoder->channel;
+
+    switch (event->id)
+    {
+    case RTI_DECODER_ID_CHANNEL:
+        /* every channel keeps its own time */
+        if (event->value_count > 0 && event->value[0] < RTI_DECODER_CHANNEL_NUM)
+        {
+            decoder->channel_time[decoder->channel] = decoder->time;
+            decoder->channel = (uint8_t)event->value[0];
+            decoder->time = decoder->channel_time[decoder->channel];
+        }
+        break;
+    case RTI_DECODER_ID_OVERFLOW:
+        if (event->value_count > 0)
+            decoder->lost += event->value[0];
+        break;
+    case RTI_DECODER_ID_INIT:
+        if (event->value_count == 4)
+        {
+            decoder->sys_freq = event->value[0];
+            decoder->cpu_freq = event->value[1];
+            decoder->ram_base = event->value[2];
+            decoder->id_shift = event->value[3];
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (decoder->callback != NULL)
+        decoder->callback(decoder->user, event);
+}
+
+void rti_decoder_init(struct rti_decoder *decoder, rti_event_cb callback, void *user)
+{
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->callback = callback;
+    decoder->user = user;
+}
+
+void rti_decoder_feed(struct rti_decoder *decoder, const uint8_t *data, size_t size)
+{
+    struct rti_event event;
+    uint32_t delta, take;
+    int result;
+
+    decoder->bytes += size;
+
+    /* finish the packet split at the end of the last chunk */
+    while (decoder->carry_len > 0 && size > 0)
+    {
+        take = sizeof(decoder->carry) - decoder->carry_len;
+        if (take > size)
+            take = (uint32_t)size;
+        memcpy(&decoder->carry[decoder->carry_len], data, take);
+
+        result = rti_parse_packet(decoder->carry, decoder->carry_len + take, &event, &delta);
+        if (result > 0)
+        {
+            if (event.id != RTI_DECODER_ID_NOP)
+                rti_decoder_emit(decoder, &event, delta);
+            if ((uint32_t)result <= decoder->carry_len)
+            {
+                /* left over from a resync */
+                decoder->carry_len -= result;
+                memmove(decoder->carry, &decoder->carry[result], decoder->carry_len);
+            }
+            else
+            {
+                data += result - decoder->carry_len;
+                size -= result - decoder->carry_len;
+                decoder->carry_len = 0;
+            }
+        }
+        else if (result == PARSE_MORE && decoder->carry_len + take < sizeof(decoder->carry))
+        {
+            decoder->carry_len += take;
+            return;
+        }
+        else
+        {
+            /* skip a byte and try to find the next packet */
+            decoder->errors++;
+            decoder->carry_len--;
+            memmove(decoder->carry, &decoder->carry[1], decoder->carry_len);
+        }
+    }
+
+    while (size > 0)
+    {
+        result = rti_parse_packet(data, size, &event, &delta);
+        if (result > 0)
+        {
+            if (event.id != RTI_DECODER_ID_NOP)
+                rti_decoder_emit(decoder, &event, delta);
+            data += result;
+            size -= result;
+        }
+        else if (result == PARSE_MORE)
+        {
+            memcpy(decoder->carry, data, size);
+            decoder->carry_len = (uint32_t)size;
+            return;
+        }
+        else
+        {
+            decoder->errors++;
+            data++;
+            size--;
+        }
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * File      : rti_decoder.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_DECODER_H__
+#define __RTI_DECODER_H__
+
+/*
+ * Host side streaming decoder for the rti byte stream.
+ *
+ * The stream is fed in chunks of any size, every complete packet is handed
+ * to a callback with its absolute time stamp. Memory use is constant: only a
+ * packet split across two chunks is copied into the decoder.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RTI_DECODER_MAX_VALUES     36
+#define RTI_DECODER_MAX_PACKET     (2 + 2 + 0x3FFF + 5)
+#define RTI_DECODER_CHANNEL_NUM    4
+
+/* packet ids, see inc/rti.h */
+#define RTI_DECODER_ID_NOP         0
+#define RTI_DECODER_ID_OVERFLOW    1
+#define RTI_DECODER_ID_INIT        24
+#define RTI_DECODER_ID_CHANNEL     94
+#define RTI_DECODER_ID_PRINTF      95
+#define RTI_DECODER_ID_MODULE      512
+#define RTI_DECODER_ID_MAX         0x3FFF
+
+struct rti_event
+{
+    /* absolute time stamp, in time stamp cycles */
+    uint64_t       time;
+    uint32_t       id;
+
+    /* channel the packet was recorded in */
+    uint8_t        channel;
+
+    /* decoded unsigned values and the (only) string, in stream order */
+    uint32_t       value[RTI_DECODER_MAX_VALUES];
+    uint8_t        value_count;
+    const char    *str;
+    uint16_t       str_len;
+
+    /* raw payload of the packet, without id, length and time stamp */
+    const uint8_t *payload;
+    uint16_t       payload_len;
+};
+
+typedef void (*rti_event_cb)(void *user, const struct rti_event *event);
+
+struct rti_decoder
+{
+    rti_event_cb   callback;
+    void          *user;
+
+    uint64_t       time;
+
+    /* the channel being decoded, time is the time of that channel */
+    uint8_t        channel;
+    uint64_t       channel_time[RTI_DECODER_CHANNEL_NUM];
+
+    /* taken from the INIT packet */
+    uint32_t       sys_freq;
+    uint32_t       cpu_freq;
+    uint32_t       ram_base;
+    uint32_t       id_shift;
+
+    /* statistics */
+    uint64_t       bytes;
+    uint64_t       packets;
+    uint64_t       lost;
+    uint64_t       errors;
+
+    /* a packet split across two chunks */
+    uint32_t       carry_len;
+    uint8_t        carry[RTI_DECODER_MAX_PACKET];
+};
+
+void rti_decoder_init(struct rti_decoder *decoder, rti_event_cb callback, void *user);
+void rti_decoder_feed(struct rti_decoder *decoder, const uint8_t *data, size_t size);
+
+const char *rti_decoder_name(uint32_t id);
+
+/* the fields of a payload: 1 when read, 0 when the data ends, -1 on an error */
+int rti_decoder_val(const uint8_t **present, const uint8_t *end, uint32_t *value);
+int rti_decoder_str(const uint8_t **present, const uint8_t *end, const char **str, uint16_t *len);
+
+#endif
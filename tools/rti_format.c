@@ -0,0 +1,325 @@
+/*
+ * File      : rti_format.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rti_decoder.h"
+#include "rti_format.h"
+
+#define SHF_ALLOC       0x2
+#define SHT_NOBITS      8
+
+static uint64_t rti_format_get(const uint8_t *p, int size)
+{
+    uint64_t v = 0;
+
+    while (size-- > 0)
+        v = (v << 8) | p[size];
+    return v;
+}
+
+int rti_format_load(struct rti_format *format, const char *path)
+{
+    const uint8_t *sh;
+    uint64_t shoff, flags;
+    uint32_t shentsize, shnum, type, i;
+    int wide;
+    FILE *fp;
+    long size;
+
+    memset(format, 0, sizeof(*format));
+    fp = fopen(path, "rb");
+    if (fp == NULL)
+        return -1;
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    format->image = malloc(size > 0 ? size : 1);
+    if (format->image == NULL || size < 64 || fread(format->image, 1, size, fp) != (size_t)size)
+    {
+        fclose(fp);
+        rti_format_free(format);
+        return -1;
+    }
+    fclose(fp);
+    format->size = size;
+
+    if (memcmp(format->image, "\177ELF", 4) != 0 || format->image[5] != 1 ||
+            (format->image[4] != 1 && format->image[4] != 2))
+    {
+        rti_format_free(format);
+        return -1;
+    }
+    wide = (format->image[4] == 2);
+    format->wide = wide;
+    shoff = rti_format_get(format->image + (wide ? 0x28 : 0x20), wide ? 8 : 4);
+    shentsize = (uint32_t)rti_format_get(format->image + (wide ? 0x3A : 0x2E), 2);
+    shnum = (uint32_t)rti_format_get(format->image + (wide ? 0x3C : 0x30), 2);
+    if (shoff + (uint64_t)shentsize * shnum > format->size || shentsize < (wide ? 64u : 40u))
+    {
+        rti_format_free(format);
+        return -1;
+    }
+
+    format->section = calloc(shnum ? shnum : 1, sizeof(*format->section));
+    if (format->section == NULL)
+    {
+        rti_format_free(format);
+        return -1;
+    }
+    for (i = 0; i < shnum; i++)
+    {
+        struct rti_format_section *section = &format->section[format->section_count];
+
+        sh = format->image + shoff + (uint64_t)i * shentsize;
+        type = (uint32_t)rti_format_get(sh + 4, 4);
+        flags = rti_format_get(sh + 8, wide ? 8 : 4);
+        if (!(flags & SHF_ALLOC) || type == SHT_NOBITS)
+            continue;
+        section->address = rti_format_get(sh + (wide ? 16 : 12), wide ? 8 : 4);
+        section->offset = rti_format_get(sh + (wide ? 24 : 16), wide ? 8 : 4);
+        section->size = rti_format_get(sh + (wide ? 32 : 20), wide ? 8 : 4);
+        if (section->offset + section->size <= format->size)
+            format->section_count++;
+    }
+    return 0;
+}
+
+void rti_format_free(struct rti_format *format)
+{
+    free(format->image);
+    free(format->section);
+    memset(format, 0, sizeof(*format));
+}
+
+const char *rti_format_string(const struct rti_format *format, uint32_t address)
+{
+    const struct rti_format_section *section;
+    const uint8_t *p;
+    int i;
+
+    for (i = 0; i < format->section_count; i++)
+    {
+        section = &format->section[i];
+        if (address < section->address || address - section->address >= section->size)
+            continue;
+        p = format->image + section->offset + (address - section->address);
+        if (memchr(p, 0, section->size - (address - section->address)) == NULL)
+            return NULL;
+        return (const char *)p;
+    }
+    return NULL;
+}
+
+static void rti_format_append(char *out, size_t size, size_t *n, const char *spec, ...)
+{
+    va_list args;
+    int len;
+
+    if (*n + 1 >= size)
+        return;
+    va_start(args, spec);
+    len = vsnprintf(out + *n, size - *n, spec, args);
+    va_end(args);
+    if (len > 0)
+        *n = (*n + len < size) ? *n + len : size - 1;
+}
+
+/* the next value, 0 when the arguments ran out */
+static int rti_format_val(const uint8_t **p, const uint8_t *end, uint32_t *value)
+{
+    return rti_decoder_val(p, end, value) > 0;
+}
+
+static int rti_format_wide(const uint8_t **p, const uint8_t *end, uint64_t *value)
+{
+    uint32_t low, high;
+
+    if (!rti_format_val(p, end, &low) || !rti_format_val(p, end, &high))
+        return 0;
+    *value = ((uint64_t)high << 32) | low;
+    return 1;
+}
+
+#define UNZIGZAG(v)     (((v) >> 1) ^ (~((v) & 1) + 1))
+
+/* mirrors rti_printf_args on the target */
+void rti_format_print(const struct rti_format *format, const char *fmt, const uint8_t *args, size_t len,
+                      char *out, size_t size)
+{
+    const uint8_t *p = args, *end = args + len;
+    char spec[48], str[256];
+    const char *s;
+    size_t n = 0, k;
+    uint32_t value;
+    uint64_t wide;
+    uint16_t str_len;
+    int longs, shorts, sized, ok;
+    union
+    {
+        double real;
+        uint64_t bits;
+    } real;
+
+    out[0] = '\0';
+    while (*fmt != '\0' && n + 1 < size)
+    {
+        if (*fmt != '%')
+        {
+            out[n++] = *fmt++;
+            out[n] = '\0';
+            continue;
+        }
+
+        /* the spec without length modifiers, '*' replaced by its value */
+        k = 0;
+        spec[k++] = *fmt++;
+        ok = 1;
+        while (*fmt == '-' || *fmt == '+' || *fmt == ' ' || *fmt == '#' || *fmt == '.' ||
+                (*fmt >= '0' && *fmt <= '9') || *fmt == '*')
+        {
+            if (*fmt == '*')
+            {
+                ok = ok && rti_format_val(&p, end, &value);
+                if (ok && k < sizeof(spec) - 20)
+                    k += sprintf(spec + k, "%d", (int32_t)UNZIGZAG(value));
+            }
+            else if (k < sizeof(spec) - 8)
+                spec[k++] = *fmt;
+            fmt++;
+        }
+
+        longs = shorts = sized = 0;
+        while (*fmt == 'h' || *fmt == 'l' || *fmt == 'L' || *fmt == 'q' || *fmt == 'j' ||
+                *fmt == 'z' || *fmt == 't')
+        {
+            if (*fmt == 'h')
+                shorts++;
+            else if (*fmt == 'l')
+                longs++;
+            else if (*fmt == 'L' || *fmt == 'q' || *fmt == 'j')
+                longs = 2;
+            else
+                sized = 1;
+            fmt++;
+        }
+        if (longs > 2)
+            longs = 2;
+        /* long and size_t of a 64 bit target came as long long */
+        if (format->wide && (longs == 1 || sized))
+            longs = 2;
+
+        spec[k] = '\0';
+        switch (*fmt)
+        {
+        case 'd':
+        case 'i':
+            if (longs == 2 ? !(ok = ok && rti_format_wide(&p, end, &wide)) :
+                    !(ok = ok && rti_format_val(&p, end, &value)))
+                break;
+            strcpy(spec + k, "lld");
+            if (longs == 2)
+                rti_format_append(out, size, &n, spec, (long long)UNZIGZAG(wide));
+            else if (shorts == 1)
+                rti_format_append(out, size, &n, spec, (long long)(int16_t)UNZIGZAG(value));
+            else if (shorts > 1)
+                rti_format_append(out, size, &n, spec, (long long)(int8_t)UNZIGZAG(value));
+            else
+                rti_format_append(out, size, &n, spec, (long long)(int32_t)UNZIGZAG(value));
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            if (longs == 2 ? !(ok = ok && rti_format_wide(&p, end, &wide)) :
+                    !(ok = ok && rti_format_val(&p, end, &value)))
+                break;
+            if (longs != 2)
+                wide = shorts == 1 ? (uint16_t)value : (shorts > 1 ? (uint8_t)value : value);
+            spec[k] = 'l';
+            spec[k + 1] = 'l';
+            spec[k + 2] = *fmt;
+            spec[k + 3] = '\0';
+            rti_format_append(out, size, &n, spec, (unsigned long long)wide);
+            break;
+        case 'c':
+            if (!(ok = ok && rti_format_val(&p, end, &value)))
+                break;
+            strcpy(spec + k, "c");
+            rti_format_append(out, size, &n, spec, (int)value);
+            break;
+        case 'p':
+            if (format->wide)
+            {
+                if ((ok = ok && rti_format_wide(&p, end, &wide)))
+                    rti_format_append(out, size, &n, "0x%016llx", (unsigned long long)wide);
+                break;
+            }
+            if (!(ok = ok && rti_format_val(&p, end, &value)))
+                break;
+            rti_format_append(out, size, &n, "0x%08x", value);
+            break;
+        case 's':
+            if (!(ok = ok && rti_decoder_str(&p, end, &s, &str_len) > 0))
+                break;
+            if (str_len >= sizeof(str))
+                str_len = sizeof(str) - 1;
+            memcpy(str, s, str_len);
+            str[str_len] = '\0';
+            strcpy(spec + k, "s");
+            rti_format_append(out, size, &n, spec, str);
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if (!(ok = ok && rti_format_wide(&p, end, &real.bits)))
+                break;
+            spec[k] = *fmt;
+            spec[k + 1] = '\0';
+            rti_format_append(out, size, &n, spec, real.real);
+            break;
+        case 'n':
+            break;
+        case '%':
+            rti_format_append(out, size, &n, "%%");
+            break;
+        default:
+            /* as the target, stop at a conversion we do not know */
+            rti_format_append(out, size, &n, "%s", spec);
+            rti_format_append(out, size, &n, "%s", fmt);
+            return;
+        }
+        if (!ok)
+            rti_format_append(out, size, &n, "<?>");
+        fmt++;
+    }
+}
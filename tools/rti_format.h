@@ -0,0 +1,71 @@
+/*
+ * File      : rti_format.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_FORMAT_H__
+#define __RTI_FORMAT_H__
+
+/*
+ * Host side formatting of rti_printf.
+ *
+ * The target records only the address of the format string and the raw
+ * arguments (see rti_printf_args in src/rti.c). The format strings are
+ * looked up in the allocated sections of the elf file of the firmware,
+ * 32 or 64 bit little endian, and formatted here with the C library. The
+ * class of the elf file tells whether long, size_t and pointers were
+ * sent as one value or as two.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct rti_format_section
+{
+    uint64_t address;
+    uint64_t size;
+    uint64_t offset;
+};
+
+struct rti_format
+{
+    /* the whole elf file */
+    uint8_t                   *image;
+    size_t                     size;
+
+    struct rti_format_section *section;
+    int                        section_count;
+
+    /* a 64 bit target, long, size_t and pointers have 64 bits */
+    int                        wide;
+};
+
+int rti_format_load(struct rti_format *format, const char *path);
+void rti_format_free(struct rti_format *format);
+
+/* the format string at the address, NULL when it is not in the file */
+const char *rti_format_string(const struct rti_format *format, uint32_t address);
+
+/* format the arguments that follow the address in a PRINTF payload */
+void rti_format_print(const struct rti_format *format, const char *fmt, const uint8_t *args, size_t len,
+                      char *out, size_t size);
+
+#endif
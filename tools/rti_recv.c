@@ -0,0 +1,280 @@
+/*
+ * File      : rti_recv.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+/*
+ * Live recording from the tcp sink (inc/rti_tcp.h) on the host.
+ *
+ *   gcc -O2 -o rti_recv tools/rti_recv.c tools/rti_decoder.c
+ *   rti_recv [-t seconds] [-l] [-o file] [host[:port]]
+ *
+ * Connects to the target (127.0.0.1:19111 by default), starts the
+ * recording with the SystemView hello, receives for the given seconds
+ * (10 by default), stops it and waits for the STOP packet. The stream is
+ * decoded as it arrives and saved to the file when one is given.
+ *
+ * Prints the sustained rate and the decoder statistics. With -l also the
+ * latency of the events, from the time stamp of an event to its arrival.
+ * That needs the time stamp of the target to be CLOCK_MONOTONIC of this
+ * machine in nanoseconds, a host build over loopback with
+ * RTI_TIMESTAMP_CLOCK or an RTI_GET_TIMESTAMP() that reads it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+
+#include "rti_decoder.h"
+
+#define READ_SIZE       (256 * 1024)
+#define DEFAULT_PORT    "19111"
+#define ID_STOP         11
+
+/* latencies in microseconds, the last bucket holds the longer ones */
+#define LATENCY_NUM     100000
+
+struct rti_recv
+{
+    struct rti_decoder decoder;
+    int latency;
+    int stopped;
+
+    /* arrival of the chunk being decoded, nanoseconds */
+    uint64_t now;
+
+    uint64_t latency_count;
+    uint64_t latency_sum;
+    uint64_t latency_max;
+    uint64_t hist[LATENCY_NUM];
+};
+
+static uint64_t rti_recv_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void rti_recv_event(void *user, const struct rti_event *event)
+{
+    struct rti_recv *client = user;
+    uint32_t latency;
+
+    if (event->id == ID_STOP)
+        client->stopped = 1;
+
+    /* the time stamps are 32 bit, so is the difference */
+    if (!client->latency || client->decoder.sys_freq != 1000000000 || event->channel != 0)
+        return;
+    latency = (uint32_t)client->now - (uint32_t)event->time;
+    client->latency_count++;
+    client->latency_sum += latency;
+    if (latency > client->latency_max)
+        client->latency_max = latency;
+    client->hist[latency / 1000 < LATENCY_NUM ? latency / 1000 : LATENCY_NUM - 1]++;
+}
+
+/* latency in microseconds that the given part of the events is below */
+static uint32_t rti_recv_percentile(struct rti_recv *client, double part)
+{
+    uint64_t count = 0, limit = (uint64_t)(client->latency_count * part);
+    uint32_t i;
+
+    for (i = 0; i < LATENCY_NUM - 1; i++)
+    {
+        count += client->hist[i];
+        if (count > limit)
+            break;
+    }
+    return i + 1;
+}
+
+static int rti_recv_connect(const char *target)
+{
+    struct addrinfo hints, *res, *ai;
+    char host[256];
+    const char *port = DEFAULT_PORT;
+    char *colon;
+    int fd = -1;
+
+    snprintf(host, sizeof(host), "%s", target);
+    colon = strrchr(host, ':');
+    if (colon != NULL)
+    {
+        *colon = '\0';
+        port = colon + 1;
+    }
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, port, &hints, &res) != 0)
+    {
+        fprintf(stderr, "rti_recv: unknown host %s\n", target);
+        return -1;
+    }
+    for (ai = res; ai != NULL; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0)
+            continue;
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+            break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd < 0)
+        perror(target);
+    return fd;
+}
+
+int main(int argc, char **argv)
+{
+    /* the hello of SystemView, the target does not look at the version */
+    static const uint8_t hello[4] = {'S', 'V', 0, 0};
+    static const uint8_t stop = 0x02;
+    struct rti_recv *client;
+    const char *target = "127.0.0.1", *path = NULL;
+    double seconds = 10, elapsed;
+    uint64_t start, end, deadline;
+    struct timeval timeout;
+    fd_set rset;
+    uint8_t *buf;
+    FILE *fp = NULL;
+    ssize_t size;
+    int fd, i;
+
+    client = calloc(1, sizeof(*client));
+    buf = malloc(READ_SIZE);
+    if (client == NULL || buf == NULL)
+    {
+        fprintf(stderr, "rti_recv: out of memory\n");
+        return 1;
+    }
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            path = argv[++i];
+        else if (strcmp(argv[i], "-l") == 0)
+            client->latency = 1;
+        else if (argv[i][0] == '-')
+        {
+            fprintf(stderr, "usage: rti_recv [-t seconds] [-l] [-o file] [host[:port]]\n");
+            return 1;
+        }
+        else
+            target = argv[i];
+    }
+
+    if (path != NULL)
+    {
+        fp = fopen(path, "wb");
+        if (fp == NULL)
+        {
+            perror(path);
+            return 1;
+        }
+    }
+
+    fd = rti_recv_connect(target);
+    if (fd < 0)
+        return 1;
+
+    rti_decoder_init(&client->decoder, rti_recv_event, client);
+    if (send(fd, hello, sizeof(hello), 0) != sizeof(hello))
+    {
+        perror("send");
+        return 1;
+    }
+
+    start = rti_recv_now();
+    deadline = start + (uint64_t)(seconds * 1e9);
+    end = start;
+    while (1)
+    {
+        client->now = rti_recv_now();
+        if (deadline != 0 && client->now >= deadline)
+        {
+            /* the rest of the recording ends with the STOP packet */
+            send(fd, &stop, 1, 0);
+            end = client->now;
+            deadline = 0;
+        }
+        else if (deadline == 0 && (client->stopped || client->now > end + 2000000000ull))
+            break;
+
+        FD_ZERO(&rset);
+        FD_SET(fd, &rset);
+        timeout.tv_sec = 0;
+        timeout.tv_usec = 100000;
+        if (select(fd + 1, &rset, NULL, NULL, &timeout) <= 0)
+            continue;
+
+        size = read(fd, buf, READ_SIZE);
+        if (size <= 0)
+            break;
+        client->now = rti_recv_now();
+        rti_decoder_feed(&client->decoder, buf, size);
+        if (fp != NULL)
+            fwrite(buf, 1, size, fp);
+    }
+    if (deadline != 0)
+        end = rti_recv_now();
+    close(fd);
+
+    elapsed = (end - start) / 1e9;
+    printf("bytes %llu, packets %llu, lost %llu, errors %llu in %.1f s, %.2f MB/s\n",
+           (unsigned long long)client->decoder.bytes,
+           (unsigned long long)client->decoder.packets,
+           (unsigned long long)client->decoder.lost,
+           (unsigned long long)client->decoder.errors,
+           elapsed, elapsed > 0 ? client->decoder.bytes / elapsed / 1e6 : 0.0);
+    if (client->latency)
+    {
+        if (client->latency_count == 0)
+            printf("latency: no events with nanosecond time stamps\n");
+        else
+            printf("latency avg %llu us, 50%% < %u us, 99%% < %u us, max %llu us\n",
+                   (unsigned long long)(client->latency_sum / client->latency_count / 1000),
+                   rti_recv_percentile(client, 0.50), rti_recv_percentile(client, 0.99),
+                   (unsigned long long)(client->latency_max / 1000));
+    }
+    if (!client->stopped)
+        fprintf(stderr, "rti_recv: the recording did not end with STOP\n");
+
+    if (fp != NULL)
+        fclose(fp);
+    free(buf);
+    free(client);
+    return 0;
+}
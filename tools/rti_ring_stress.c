@@ -0,0 +1,467 @@
+/*
+ * File      : rti_ring_stress.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+/*
+ * Stress test of the lock-free trace ring in src/rti_ring.c.
+ *
+ *   rti_ring_stress [count]
+ *
+ * The main loop, two more threads and two signal handlers produce packets
+ * into a 256 byte ring, so nearly every packet wraps or waits for space.
+ * The handlers run from interval timers and nest into each other and into
+ * the producing thread between any two instructions, like interrupts of
+ * two priorities on a single core; a handler does not nest into itself,
+ * it would take a newer sequence number and finish first. The threads are contexts on the one process
+ * thread; a fourth timer switches between them wherever they are, unless
+ * a handler is running or they turned interrupts off, like the scheduler
+ * of a single core does. Every packet carries its producer, its length, a
+ * sequence number and a payload derived from it. No producer may see its
+ * packet published while it is still writing it.
+ *
+ * fill:      a third timer drains the ring. It preempts the producers, and
+ *            they preempt it, like a transport thread. Every packet the ring
+ *            did not refuse arrives exactly once, in order and intact.
+ * overwrite: the ring drops the oldest packets instead. Whatever it holds
+ *            parses into intact packets, in order for each producer, and
+ *            no producer is ever refused.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+
+#include "rti_ring.h"
+
+#define STRESS_POOL_SIZE        256
+#define STRESS_PRODUCER_NUM     5
+#define STRESS_THREAD_NUM       3
+#define STRESS_STACK_SIZE       65536
+#define STRESS_PAYLOAD_MAX      40
+#define STRESS_HEADER_SIZE      2
+
+static rt_uint8_t stress_pool[STRESS_POOL_SIZE];
+static struct rti_ring stress_ring;
+
+static volatile rt_uint32_t stress_seq[STRESS_PRODUCER_NUM];
+static volatile rt_uint32_t stress_drop[STRESS_PRODUCER_NUM];
+static rt_uint32_t stress_last[STRESS_PRODUCER_NUM];
+static rt_uint32_t stress_got[STRESS_PRODUCER_NUM];
+
+static rt_uint8_t stress_buf[4096];
+static rt_uint32_t stress_have;
+
+/* the threads: the main loop is producer 0, the others 3 and 4 */
+static ucontext_t stress_context[STRESS_THREAD_NUM];
+static rt_uint8_t stress_stack[STRESS_THREAD_NUM][STRESS_STACK_SIZE];
+static volatile rt_uint32_t stress_running;
+static volatile rt_bool_t stress_stop;
+/* swapcontext sets the mask of the next thread while still on the stack of
+ * the last one, a switch in between would save it as the next thread */
+static volatile rt_bool_t stress_switching;
+static timer_t stress_tick;
+
+/* the signals of the interrupts and of the scheduler */
+static sigset_t stress_irqs;
+static sigset_t stress_saved;
+static volatile rt_uint8_t stress_nest;
+
+/* the ring only needs these from the kernel */
+void *rt_memcpy(void *dst, const void *src, rt_ubase_t count)
+{
+    return memcpy(dst, src, count);
+}
+
+/* the ring never nests these, a thread that took them is not switched out */
+rt_base_t rt_hw_interrupt_disable(void)
+{
+    sigprocmask(SIG_BLOCK, &stress_irqs, &stress_saved);
+    return 0;
+}
+
+void rt_hw_interrupt_enable(rt_base_t level)
+{
+    sigprocmask(SIG_SETMASK, &stress_saved, NULL);
+}
+
+rt_uint8_t rt_interrupt_get_nest(void)
+{
+    return stress_nest;
+}
+
+void rt_host_assert(const char *ex, const char *func, rt_size_t line)
+{
+    fprintf(stderr, "(%s) assertion failed at function:%s, line number:%d\n", ex, func, (int)line);
+    abort();
+}
+
+static void stress_fail(const char *what, rt_uint32_t producer, rt_uint32_t seq)
+{
+    printf("FAIL: %s, producer %u sequence %u\n", what, producer, seq);
+    exit(1);
+}
+
+/* packet: producer, payload length, payload with the sequence number in the first four bytes */
+static void stress_produce(rt_uint32_t producer)
+{
+    rt_uint8_t packet[STRESS_HEADER_SIZE + STRESS_PAYLOAD_MAX];
+    rt_uint32_t seq, length, index, i;
+    volatile int delay;
+    rt_base_t level;
+    rt_err_t result;
+
+    /* the other handler may get in between */
+    seq = rti_atomic_add(&stress_seq[producer], 1) - 1;
+    length = (seq * 7 + producer) % (STRESS_PAYLOAD_MAX - 4) + 5;
+    packet[0] = producer;
+    packet[1] = length;
+    for (i = 0; i < length; i++)
+        packet[STRESS_HEADER_SIZE + i] = (rt_uint8_t)(seq + i);
+    packet[2] = seq & 0xFF;
+    packet[3] = (seq >> 8) & 0xFF;
+    packet[4] = (seq >> 16) & 0xFF;
+    packet[5] = (seq >> 24) & 0xFF;
+
+    level = rti_ring_enter(&stress_ring);
+    do
+    {
+        index = stress_ring.reserve;
+        result = rti_ring_reserve(&stress_ring, index, STRESS_HEADER_SIZE + length);
+    }
+    while (result == -RT_EBUSY);
+    if (result == RT_EOK)
+    {
+        /* write in two parts, a nested producer gets in between */
+        rti_ring_write(&stress_ring, index, packet, 3);
+        for (delay = 0; delay < 20; delay++);
+        /* nobody may publish a packet that is still being written */
+        if ((rt_int32_t)(stress_ring.commit - index) > 0)
+            stress_fail("published while being written", producer, seq);
+        rti_ring_write(&stress_ring, index + 3, packet + 3, STRESS_HEADER_SIZE + length - 3);
+    }
+    else
+    {
+        rti_atomic_add(&stress_drop[producer], 1);
+    }
+    rti_ring_leave(&stress_ring, level);
+}
+
+static void stress_alarm(int signal)
+{
+    stress_nest++;
+    stress_produce(1);
+    stress_nest--;
+}
+
+static void stress_prof(int signal)
+{
+    stress_nest++;
+    stress_produce(2);
+    stress_nest--;
+}
+
+/* switch to the next thread, not while a handler runs */
+static void stress_switch(int signal)
+{
+    rt_uint32_t from = stress_running;
+
+    if (stress_nest > 0 || stress_switching)
+        return ;
+    stress_switching = RT_TRUE;
+    stress_running = (from + 1) % STRESS_THREAD_NUM;
+    swapcontext(&stress_context[from], &stress_context[stress_running]);
+    stress_switching = RT_FALSE;
+}
+
+/* threads 1 and 2 produce until told to stop, then hand back to main */
+static void stress_thread(int thread)
+{
+    for (;;)
+    {
+        stress_switching = RT_FALSE;
+        while (!stress_stop)
+            stress_produce(STRESS_PRODUCER_NUM - STRESS_THREAD_NUM + thread);
+        stress_switching = RT_TRUE;
+        stress_running = 0;
+        swapcontext(&stress_context[thread], &stress_context[0]);
+    }
+}
+
+static void stress_consume(void);
+
+/* the reader is an interrupt too, a thread switched in under it would run
+ * a second reader on the same buffer */
+static void stress_vtalrm(int signal)
+{
+    stress_nest++;
+    stress_consume();
+    stress_nest--;
+}
+
+static rt_uint32_t stress_skip(struct rti_ring *ring, rt_uint32_t index)
+{
+    return STRESS_HEADER_SIZE + rti_ring_getc(ring, index + 1);
+}
+
+/* check one packet at the start of data, return its size */
+static rt_uint32_t stress_check(const rt_uint8_t *data, rt_uint32_t size, rt_bool_t *seen)
+{
+    rt_uint32_t producer = data[0], length = data[1], seq, i;
+
+    if (producer >= STRESS_PRODUCER_NUM || length < 5 || length > STRESS_PAYLOAD_MAX)
+        stress_fail("broken header", producer, length);
+    if (size < STRESS_HEADER_SIZE + length)
+        return 0;
+
+    seq = data[2] | (data[3] << 8) | (data[4] << 16) | ((rt_uint32_t)data[5] << 24);
+    for (i = 4; i < length; i++)
+    {
+        if (data[STRESS_HEADER_SIZE + i] != (rt_uint8_t)(data[2] + i))
+            stress_fail("broken payload", producer, seq);
+    }
+    if (seen[producer] && (rt_int32_t)(seq - stress_last[producer]) <= 0)
+        stress_fail("duplicate or out of order", producer, seq);
+    seen[producer] = RT_TRUE;
+    stress_last[producer] = seq;
+    stress_got[producer]++;
+    return STRESS_HEADER_SIZE + length;
+}
+
+static void stress_consume(void)
+{
+    static rt_bool_t seen[STRESS_PRODUCER_NUM];
+    struct rti_span span[2];
+    rt_uint32_t taken = 0, size, offset = 0;
+    rt_uint8_t count, i;
+
+    count = rti_ring_peek(&stress_ring, span);
+    for (i = 0; i < count; i++)
+    {
+        size = span[i].length;
+        if (size > sizeof(stress_buf) - stress_have - taken)
+            size = sizeof(stress_buf) - stress_have - taken;
+        memcpy(stress_buf + stress_have + taken, span[i].ptr, size);
+        taken += size;
+    }
+    rti_ring_commit(&stress_ring, taken);
+    stress_have += taken;
+
+    while (stress_have - offset >= STRESS_HEADER_SIZE &&
+           (size = stress_check(stress_buf + offset, stress_have - offset, seen)) > 0)
+        offset += size;
+    memmove(stress_buf, stress_buf + offset, stress_have - offset);
+    stress_have -= offset;
+}
+
+/* walk the packets in the ring without consuming them */
+static void stress_walk(void)
+{
+    rt_bool_t seen[STRESS_PRODUCER_NUM] = {RT_FALSE};
+    rt_uint8_t packet[STRESS_HEADER_SIZE + STRESS_PAYLOAD_MAX];
+    rt_uint32_t index, commit = stress_ring.commit, i, size;
+
+    if (commit - stress_ring.read > STRESS_POOL_SIZE)
+        stress_fail("more data than the ring holds", 0, commit - stress_ring.read);
+    for (index = stress_ring.read; index != commit; index += size)
+    {
+        for (i = 0; i < sizeof(packet) && index + i != commit; i++)
+            packet[i] = rti_ring_getc(&stress_ring, index + i);
+        size = (i < STRESS_HEADER_SIZE) ? 0 : stress_check(packet, i, seen);
+        if (size == 0)
+            stress_fail("packet cut at the commit index", packet[0], 0);
+    }
+}
+
+static void stress_timers(rt_bool_t on)
+{
+    struct itimerval alarm = {{0, 50}, {0, 50}};
+    struct itimerval prof = {{0, 37}, {0, 37}};
+    struct itimerval consume = {{0, 20}, {0, 20}};
+    struct itimerspec tick = {{0, 43000}, {0, 43000}};
+    rt_uint32_t i;
+
+    if (!on)
+    {
+        memset(&alarm, 0, sizeof(alarm));
+        memset(&prof, 0, sizeof(prof));
+        memset(&consume, 0, sizeof(consume));
+        memset(&tick, 0, sizeof(tick));
+    }
+    setitimer(ITIMER_REAL, &alarm, NULL);
+    setitimer(ITIMER_PROF, &prof, NULL);
+    if (stress_ring.skip == RT_NULL)
+        setitimer(ITIMER_VIRTUAL, &consume, NULL);
+    timer_settime(stress_tick, 0, &tick, NULL);
+
+    /* let the threads finish the packet they are in */
+    if (!on)
+    {
+        stress_stop = RT_TRUE;
+        for (i = 1; i < STRESS_THREAD_NUM; i++)
+        {
+            stress_switching = RT_TRUE;
+            stress_running = i;
+            swapcontext(&stress_context[0], &stress_context[i]);
+            stress_switching = RT_FALSE;
+        }
+        stress_stop = RT_FALSE;
+    }
+}
+
+static void stress_start(rt_bool_t overwrite)
+{
+    rti_ring_init(&stress_ring, stress_pool, sizeof(stress_pool));
+    if (overwrite)
+        stress_ring.skip = stress_skip;
+    memset((void *)stress_seq, 0, sizeof(stress_seq));
+    memset((void *)stress_drop, 0, sizeof(stress_drop));
+    memset(stress_got, 0, sizeof(stress_got));
+    stress_have = 0;
+    stress_timers(RT_TRUE);
+}
+
+static int stress_report(const char *name)
+{
+    rt_uint32_t i, nested = 0, preempted = 0;
+    int result = 0;
+
+    stress_timers(RT_FALSE);
+    for (i = 0; i < STRESS_PRODUCER_NUM; i++)
+    {
+        printf("%-9s producer %u: %u packets, %u refused\n", name, i, stress_seq[i], stress_drop[i]);
+        if (i >= STRESS_PRODUCER_NUM - STRESS_THREAD_NUM + 1)
+            preempted += stress_seq[i];
+        else if (i > 0)
+            nested += stress_seq[i];
+    }
+    if (stress_ring.committing != 0)
+    {
+        printf("FAIL: %u producers still committing\n", stress_ring.committing);
+        result = 1;
+    }
+    if (nested == 0)
+    {
+        printf("FAIL: the signal handlers did not produce\n");
+        result = 1;
+    }
+    if (preempted == 0)
+    {
+        printf("FAIL: the threads did not produce\n");
+        result = 1;
+    }
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    struct sigaction action;
+    struct sigevent event;
+    long count = 10000000, n;
+    rt_uint32_t i;
+    int result;
+
+    if (argc > 1)
+        count = atol(argv[1]);
+
+    /* no handler nests into itself */
+    memset(&action, 0, sizeof(action));
+    action.sa_flags = SA_RESTART;
+    action.sa_handler = stress_alarm;
+    sigaction(SIGALRM, &action, NULL);
+    action.sa_handler = stress_prof;
+    sigaction(SIGPROF, &action, NULL);
+    action.sa_handler = stress_vtalrm;
+    sigaction(SIGVTALRM, &action, NULL);
+    action.sa_handler = stress_switch;
+    sigaction(SIGUSR1, &action, NULL);
+    sigemptyset(&stress_irqs);
+    sigaddset(&stress_irqs, SIGALRM);
+    sigaddset(&stress_irqs, SIGPROF);
+    sigaddset(&stress_irqs, SIGVTALRM);
+    sigaddset(&stress_irqs, SIGUSR1);
+
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_SIGNAL;
+    event.sigev_signo = SIGUSR1;
+    timer_create(CLOCK_MONOTONIC, &event, &stress_tick);
+    for (i = 1; i < STRESS_THREAD_NUM; i++)
+    {
+        getcontext(&stress_context[i]);
+        stress_context[i].uc_stack.ss_sp = stress_stack[i];
+        stress_context[i].uc_stack.ss_size = STRESS_STACK_SIZE;
+        stress_context[i].uc_link = NULL;
+        sigemptyset(&stress_context[i].uc_sigmask);
+        makecontext(&stress_context[i], (void (*)(void))stress_thread, 1, (int)i);
+    }
+
+    /* fill */
+    stress_start(RT_FALSE);
+    for (n = 0; n < count; n++)
+        stress_produce(0);
+    result = stress_report("fill");
+    stress_consume();
+    stress_consume();
+    for (i = 0; i < STRESS_PRODUCER_NUM; i++)
+    {
+        if (stress_seq[i] - stress_drop[i] != stress_got[i])
+        {
+            printf("FAIL: producer %u sent %u packets, %u arrived\n", i,
+                   stress_seq[i] - stress_drop[i], stress_got[i]);
+            result = 1;
+        }
+    }
+
+    /* overwrite: stop the producers now and then and check what the ring holds */
+    stress_start(RT_TRUE);
+    for (n = 0; n < count; n++)
+    {
+        stress_produce(0);
+        if (n % 100000 == 0)
+        {
+            rt_hw_interrupt_disable();
+            stress_walk();
+            rt_hw_interrupt_enable(0);
+        }
+    }
+    result |= stress_report("overwrite");
+    stress_walk();
+
+    /* the data of the producers that a producer preempts is smaller than
+     * the ring, a thread that stays switched out in the middle of its
+     * packet would keep everybody from dropping the old packets */
+    for (i = 0; i < STRESS_PRODUCER_NUM; i++)
+    {
+        if (stress_drop[i] != 0)
+        {
+            printf("FAIL: producer %u refused %u packets while overwriting\n", i, stress_drop[i]);
+            result = 1;
+        }
+    }
+
+    printf(result ? "FAIL\n" : "OK\n");
+    return result;
+}
@@ -0,0 +1,159 @@
+/*
+ * File      : rti_unpack.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+
+#include <string.h>
+#include "rti_unpack.h"
+
+/* unpack an lz4 block, return its size or -1 when it is corrupt */
+static int rti_unpack_lz4(const uint8_t *src, size_t size, uint8_t *dst, size_t limit)
+{
+    const uint8_t *ip = src, *end = src + size;
+    uint8_t *op = dst, *dst_end = dst + limit;
+    size_t literals, match, offset;
+    uint8_t token;
+
+    while (ip < end)
+    {
+        token = *ip++;
+
+        literals = token >> 4;
+        if (literals == 15)
+        {
+            do
+            {
+                if (ip == end)
+                    return -1;
+                literals += *ip;
+            }
+            while (*ip++ == 255);
+        }
+        if ((size_t)(end - ip) < literals || (size_t)(dst_end - op) < literals)
+            return -1;
+        memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        /* the last sequence has no match */
+        if (ip == end)
+            break;
+
+        if (end - ip < 2)
+            return -1;
+        offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst))
+            return -1;
+
+        match = token & 0x0F;
+        if (match == 15)
+        {
+            do
+            {
+                if (ip == end)
+                    return -1;
+                match += *ip;
+            }
+            while (*ip++ == 255);
+        }
+        match += 4;
+        if ((size_t)(dst_end - op) < match)
+            return -1;
+        /* byte by byte, the match may overlap the output */
+        while (match--)
+        {
+            *op = op[-offset];
+            op++;
+        }
+    }
+    return (int)(op - dst);
+}
+
+static void rti_unpack_frame(struct rti_unpack *unpack)
+{
+    uint32_t raw = unpack->frame[2] | (unpack->frame[3] << 8);
+    uint32_t size = unpack->frame[4] | (unpack->frame[5] << 8);
+    const uint8_t *data = &unpack->frame[RTI_UNPACK_HEAD_SIZE];
+
+    if (unpack->frame[1] == RTI_UNPACK_STORED && size == raw)
+    {
+        unpack->frames++;
+        unpack->raw_bytes += raw;
+        unpack->callback(unpack->user, data, raw);
+    }
+    else if (unpack->frame[1] == RTI_UNPACK_LZ4 &&
+             rti_unpack_lz4(data, size, unpack->block, raw) == (int)raw)
+    {
+        unpack->frames++;
+        unpack->raw_bytes += raw;
+        unpack->callback(unpack->user, unpack->block, raw);
+    }
+    else
+        unpack->errors++;
+}
+
+void rti_unpack_init(struct rti_unpack *unpack, rti_block_cb callback, void *user)
+{
+    memset(unpack, 0, sizeof(*unpack));
+    unpack->callback = callback;
+    unpack->user = user;
+}
+
+void rti_unpack_feed(struct rti_unpack *unpack, const uint8_t *data, size_t size)
+{
+    uint32_t need, take;
+
+    unpack->bytes += size;
+    while (size > 0)
+    {
+        /* look for the next frame */
+        if (unpack->frame_len == 0 && *data != RTI_UNPACK_MAGIC)
+        {
+            unpack->errors++;
+            data++;
+            size--;
+            continue;
+        }
+
+        need = RTI_UNPACK_HEAD_SIZE;
+        if (unpack->frame_len >= RTI_UNPACK_HEAD_SIZE)
+            need += unpack->frame[4] | (unpack->frame[5] << 8);
+        take = need - unpack->frame_len;
+        if (take > size)
+            take = (uint32_t)size;
+        memcpy(&unpack->frame[unpack->frame_len], data, take);
+        unpack->frame_len += take;
+        data += take;
+        size -= take;
+
+        if (unpack->frame_len < RTI_UNPACK_HEAD_SIZE)
+            continue;
+        /* the header is complete, the length of the data is known */
+        need = RTI_UNPACK_HEAD_SIZE + (unpack->frame[4] | (unpack->frame[5] << 8));
+        if (unpack->frame_len == need)
+        {
+            rti_unpack_frame(unpack);
+            unpack->frame_len = 0;
+        }
+    }
+}
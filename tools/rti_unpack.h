@@ -0,0 +1,67 @@
+/*
+ * File      : rti_unpack.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2018-06-05     flybreak     first version
+ */
+#ifndef __RTI_UNPACK_H__
+#define __RTI_UNPACK_H__
+
+/*
+ * Host side streaming unpacker for the frames of inc/rti_compress.h.
+ *
+ * Fed in chunks of any size like the decoder, every complete frame is
+ * unpacked and its block handed to a callback, which usually feeds it to
+ * rti_decoder_feed. Memory use is constant: one frame and one block.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RTI_UNPACK_MAGIC           0xFA
+#define RTI_UNPACK_STORED          0
+#define RTI_UNPACK_LZ4             1
+
+#define RTI_UNPACK_HEAD_SIZE       6
+#define RTI_UNPACK_MAX_BLOCK       0xFFFF
+
+typedef void (*rti_block_cb)(void *user, const uint8_t *data, size_t size);
+
+struct rti_unpack
+{
+    rti_block_cb   callback;
+    void          *user;
+
+    /* statistics */
+    uint64_t       bytes;
+    uint64_t       raw_bytes;
+    uint64_t       frames;
+    uint64_t       errors;
+
+    /* the frame being received */
+    uint32_t       frame_len;
+    uint8_t        frame[RTI_UNPACK_HEAD_SIZE + RTI_UNPACK_MAX_BLOCK];
+    uint8_t        block[RTI_UNPACK_MAX_BLOCK];
+};
+
+void rti_unpack_init(struct rti_unpack *unpack, rti_block_cb callback, void *user);
+void rti_unpack_feed(struct rti_unpack *unpack, const uint8_t *data, size_t size);
+
+#endif